@@ -126,6 +126,13 @@ global_initialize (unsigned long interpreter_load_base)
   vdl->readonly_cache = vdl_hashmap_new ();
   vdl->ro_cache_futex = futex_new ();
   vdl->shm_path = make_shm_name ();
+  vdl->reloc_cache = vdl_hashmap_new ();
+  // shared pages for code break gdb, so debug builds only share on request
+#ifdef DEBUG
+  vdl->share_readonly = 0;
+#else
+  vdl->share_readonly = 1;
+#endif
   vdl->gc_futex = futex_new ();
 }
 
@@ -237,6 +244,7 @@ stage1_freeres (void)
   stage2_freeres ();
   vdl_alloc_free (g_vdl.shm_path);
   vdl_hashmap_delete (g_vdl.readonly_cache);
+  vdl_hashmap_delete (g_vdl.reloc_cache);
   vdl_rbdelete (g_vdl.address_ranges);
   vdl_list_delete (g_vdl.preloads);
   vdl_hashmap_delete (g_vdl.module_map);
@@ -205,6 +205,13 @@ setup_env_vars (const char **envp)
       g_vdl.bind_now = 1;
     }
 
+  // setup readonly section sharing from LD_SHARE_READONLY
+  const char *share_readonly = vdl_utils_getenv (envp, "LD_SHARE_READONLY");
+  if (share_readonly != 0)
+    {
+      g_vdl.share_readonly = !vdl_utils_strisequal (share_readonly, "0");
+    }
+
   // get additional static TLS size from LD_STATIC_TLS_EXTRA
   const char *static_tls_extra =
     vdl_utils_getenv (envp, "LD_STATIC_TLS_EXTRA");
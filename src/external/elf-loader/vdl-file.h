@@ -45,6 +45,9 @@ struct VdlFileMap
   // zero-initialized anon pages.
   unsigned long mem_anon_start_align;
   unsigned long mem_anon_size_align;
+  // set if this map is backed by a readonly cache mapping that is
+  // shared with every other namespace which loaded the same file.
+  int is_shared;
 };
 
 // equivalent of link_map in include/link.h in glibc
@@ -119,6 +119,7 @@ pt_load_to_file_map (const ElfW (Phdr) *phdr)
     {
       map->mem_zero_size = phdr->p_memsz - phdr->p_filesz;
     }
+  map->is_shared = 0;
   map->mmap_flags = 0;
   map->mmap_flags |= (phdr->p_flags & PF_X) ? PROT_EXEC : 0;
   map->mmap_flags |= (phdr->p_flags & PF_R) ? PROT_READ : 0;
@@ -583,34 +584,27 @@ file_new (unsigned long load_base, unsigned long dynamic, struct VdlList *maps,
   return file;
 }
 
+// readonly sections are keyed by the file identity rather than its name,
+// so that the same library reached through different paths (e.g. a symlink
+// to a versioned soname) is still only copied once.
 struct VdlMapCacheItem
 {
-  char *filename;
+  dev_t st_dev;
+  ino_t st_ino;
   unsigned long section;
   int fd;
 };
 
-struct VdlMapCacheItem *
-map_cache_item_new (const char *filename, const struct VdlFileMap *map,
-                    int fd)
+static uint32_t
+readonly_cache_hash (const struct VdlMapCacheItem *item)
 {
-  struct VdlMapCacheItem *item = vdl_alloc_new (struct VdlMapCacheItem);
-  item->filename = vdl_utils_strdup (filename);
-  item->section = map->file_start_align;
-  item->fd = fd;
-  return item;
+  unsigned long hash = (unsigned long) item->st_ino;
+  hash = hash * 31 + (unsigned long) item->st_dev;
+  hash = hash * 31 + item->section;
+  return (uint32_t) (hash ^ (hash >> 32));
 }
 
-#ifndef DEBUG
-static void
-readonly_cache_insert (const char *filename, const struct VdlFileMap *map,
-                       int fd, unsigned long hash)
-{
-  struct VdlMapCacheItem *item = map_cache_item_new (filename, map, fd);
-  vdl_hashmap_insert (g_vdl.readonly_cache, hash, item);
-}
-
-int
+static int
 readonly_cache_compare (const void *query_void, const void *cached_void)
 {
   const struct VdlMapCacheItem *query =
@@ -618,17 +612,17 @@ readonly_cache_compare (const void *query_void, const void *cached_void)
   const struct VdlMapCacheItem *cached =
     (const struct VdlMapCacheItem *) cached_void;
   return (query->section == cached->section
-          && vdl_utils_strisequal (query->filename, cached->filename));
+          && query->st_ino == cached->st_ino
+          && query->st_dev == cached->st_dev);
 }
 
 static int
-readonly_cache_find (const char *filename, const struct VdlFileMap *map,
-                     unsigned long hash)
+readonly_cache_find (const struct VdlMapCacheItem *query, uint32_t hash)
 {
-  struct VdlMapCacheItem *tmp = map_cache_item_new (filename, map, 0);
   struct VdlMapCacheItem *item =
     (struct VdlMapCacheItem *) vdl_hashmap_get (g_vdl.readonly_cache, hash,
-                                                tmp, readonly_cache_compare);
+                                                (void *) query,
+                                                readonly_cache_compare);
   if (item)
     {
       return item->fd;
@@ -637,12 +631,13 @@ readonly_cache_find (const char *filename, const struct VdlFileMap *map,
 }
 
 static unsigned long
-readonly_cache_map (const char *filename, const struct VdlFileMap *map,
-                    int fd, int prot, unsigned long load_base)
+readonly_cache_map (const char *filename, const struct stat *st_buf,
+                    const struct VdlFileMap *map, int fd, int prot,
+                    unsigned long load_base)
 {
   // With enough clever hacking around the locks here, we could reduce
   // contention around insertions, since the ro_cache_futex is really only
-  // neccessary on a per-filename basis (we don't want to map the same section
+  // neccessary on a per-file basis (we don't want to map the same section
   // twice). E.g., we could use the locks in the linked lists in the hashmap.
   // I'm not doing this now, because it would pretty significantly increase the
   // code complexity, and I can't think of any usecases that involve opening
@@ -654,17 +649,19 @@ readonly_cache_map (const char *filename, const struct VdlFileMap *map,
   // add a memory overhead but not a stability problem (assuming you also added
   // a means to make shm_path unique on each call, not just each process).
 
-  char *section = vdl_utils_itoa (map->file_start_align);
-  char *hashname = vdl_utils_strconcat (filename, section);
-  unsigned long hash = vdl_gnu_hash (hashname);
-  vdl_alloc_free (section);
-  vdl_alloc_free (hashname);
-  int cfd = readonly_cache_find (filename, map, hash);
+  struct VdlMapCacheItem query;
+  query.st_dev = st_buf->st_dev;
+  query.st_ino = st_buf->st_ino;
+  query.section = map->file_start_align;
+  query.fd = -1;
+  uint32_t hash = readonly_cache_hash (&query);
+
+  int cfd = readonly_cache_find (&query, hash);
   if (cfd < 0)
     {
       futex_lock (g_vdl.ro_cache_futex);
       // double check that the section wasn't cached before we had the lock
-      cfd = readonly_cache_find (filename, map, hash);
+      cfd = readonly_cache_find (&query, hash);
       if (cfd >= 0)
         {
           futex_unlock (g_vdl.ro_cache_futex);
@@ -694,11 +691,15 @@ readonly_cache_map (const char *filename, const struct VdlFileMap *map,
         {
           VDL_LOG_ERROR ("Could not sendfile from %s to %s: %d\n", filename,
                          g_vdl.shm_path, result);
+          system_close (cfd);
           futex_unlock (g_vdl.ro_cache_futex);
           return 0;
         }
 
-      readonly_cache_insert (filename, map, cfd, hash);
+      struct VdlMapCacheItem *item = vdl_alloc_new (struct VdlMapCacheItem);
+      *item = query;
+      item->fd = cfd;
+      vdl_hashmap_insert (g_vdl.readonly_cache, hash, item);
       futex_unlock (g_vdl.ro_cache_futex);
     }
 found:
@@ -707,33 +708,41 @@ found:
                                       map->mem_size_align, prot,
                                       MAP_SHARED | MAP_FIXED, cfd, 0);
 }
-#endif
+
+static unsigned long
+file_map_private (const struct VdlFileMap *map, int fd, int prot,
+                  unsigned long load_base)
+{
+  return (unsigned long) system_mmap ((void *) load_base +
+                                      map->mem_start_align,
+                                      map->mem_size_align, prot,
+                                      MAP_PRIVATE | MAP_FIXED, fd,
+                                      map->file_start_align);
+}
 
 static void
-file_map_do (const char *filename, const struct VdlFileMap *map,
-             int fd, int prot, unsigned long load_base)
+file_map_do (const char *filename, const struct stat *st_buf,
+             struct VdlFileMap *map, int fd, int prot,
+             unsigned long load_base, int share)
 {
   // Now, map again the area at the right location.
   VDL_LOG_FUNCTION ("file=%s, fd=0x%x, prot=0x%x, load_base=0x%lx", filename,
                     fd, prot, load_base);
   int int_result;
-  unsigned long address;
-  // shared pages for code breaks gdb, so just don't use them in debug builds
-#ifndef DEBUG
-  if (!(prot & PROT_WRITE))
+  unsigned long address = 0;
+  map->is_shared = 0;
+  if (share && !(prot & PROT_WRITE))
     {
-      // this area is read-only, so we only load it once
-      address = readonly_cache_map (filename, map, fd, prot, load_base);
+      // this area is read-only, so we only load it once and every
+      // namespace maps the same pages; only writable sections
+      // (.data, .bss, GOT) stay private copy-on-write mappings
+      address = readonly_cache_map (filename, st_buf, map, fd, prot,
+                                    load_base);
+      map->is_shared = (address == load_base + map->mem_start_align);
     }
-  else
-#endif
+  if (!map->is_shared)
     {
-      address =
-        (unsigned long) system_mmap ((void *) load_base +
-                                     map->mem_start_align,
-                                     map->mem_size_align, prot,
-                                     MAP_PRIVATE | MAP_FIXED, fd,
-                                     map->file_start_align);
+      address = file_map_private (map, fd, prot, load_base);
     }
 
   VDL_LOG_ASSERT (address == load_base + map->mem_start_align,
@@ -872,6 +881,14 @@ vdl_file_map_single (struct VdlContext *context,
   // calculate the offset between the start address we asked for and the one we got
   unsigned long load_base = mapping_start - requested_mapping_start;
 
+  // the file identity keys the readonly cache
+  struct stat st_buf;
+  if (system_fstat (filename, &st_buf) == -1)
+    {
+      VDL_LOG_ERROR ("Unable to stat file %s\n", filename);
+      goto error;
+    }
+
   // remap the portions we want.
   // To prevent concurrency problems, we don't munmap the mmap at mapping_start.
   // We can do this because the remaps use MAP_FIXED. (see man mmap)
@@ -881,14 +898,8 @@ vdl_file_map_single (struct VdlContext *context,
        i = vdl_list_next (maps, i))
     {
       struct VdlFileMap *map = *i;
-      file_map_do (filename, map, fd, map->mmap_flags, load_base);
-    }
-
-  struct stat st_buf;
-  if (system_fstat (filename, &st_buf) == -1)
-    {
-      VDL_LOG_ERROR ("Unable to stat file %s\n", filename);
-      goto error;
+      file_map_do (filename, &st_buf, map, fd, map->mmap_flags, load_base,
+                   g_vdl.share_readonly);
     }
 
   struct VdlFile *file = file_new (load_base, dynamic, maps,
@@ -896,6 +907,23 @@ vdl_file_map_single (struct VdlContext *context,
   file->st_dev = st_buf.st_dev;
   file->st_ino = st_buf.st_ino;
 
+  if (file->dt_flags & DF_TEXTREL)
+    {
+      // text relocations write into readonly sections with
+      // namespace-specific addresses, so those must not be shared
+      for (i = vdl_list_begin (maps);
+           i != vdl_list_end (maps);
+           i = vdl_list_next (maps, i))
+        {
+          struct VdlFileMap *map = *i;
+          if (map->is_shared)
+            {
+              // file_new already added load_base to the map addresses
+              file_map_do (filename, &st_buf, map, fd, map->mmap_flags, 0, 0);
+            }
+        }
+    }
+
   file->phdr = phdr;
   file->phnum = header.e_phnum;
   file->e_type = header.e_type;
@@ -10,9 +10,269 @@
 #include "vdl-file.h"
 #include "vdl-context.h"
 #include "vdl-alloc.h"
+#include "vdl-hashmap.h"
+#include "vdl.h"
 #include <sys/mman.h>
 #include <stdbool.h>
 
+// When the same files are loaded into many contexts, every context resolves
+// the same symbols against an equivalent scope: only the load bases differ.
+// We therefore remember, per relocated file and per sequence of files in its
+// lookup scope (both identified by device and inode), which scope entry
+// defined each symbol and the file-relative symbol, and replay that in
+// later contexts instead of walking the scope and hash tables again.
+struct VdlRelocFileId
+{
+  dev_t st_dev;
+  ino_t st_ino;
+};
+
+struct VdlRelocCache
+{
+  struct VdlRelocFileId file;
+  uint32_t n_scope;
+  struct VdlRelocFileId *scope;
+  // VdlRelocCacheEntry items
+  struct VdlHashMap *entries;
+};
+
+struct VdlRelocCacheEntry
+{
+  unsigned long reloc_sym;
+  int flags;
+  // position of the defining file in the scope, or -1 if unresolved
+  long scope_index;
+  ElfW (Sym) symbol;
+};
+
+// the scope of the file being relocated, in lookup order
+struct VdlRelocScope
+{
+  struct VdlFile **files;
+  uint32_t n_files;
+  struct VdlRelocCache *cache;
+};
+
+static uint32_t
+reloc_cache_hash (const struct VdlRelocCache *cache)
+{
+  unsigned long hash = (unsigned long) cache->file.st_ino;
+  hash = hash * 31 + (unsigned long) cache->file.st_dev;
+  uint32_t i;
+  for (i = 0; i < cache->n_scope; i++)
+    {
+      hash = hash * 31 + (unsigned long) cache->scope[i].st_ino;
+      hash = hash * 31 + (unsigned long) cache->scope[i].st_dev;
+    }
+  return (uint32_t) (hash ^ (hash >> 32));
+}
+
+static int
+reloc_cache_compare (const void *query_void, const void *cached_void)
+{
+  const struct VdlRelocCache *query = query_void;
+  const struct VdlRelocCache *cached = cached_void;
+  if (query->file.st_ino != cached->file.st_ino
+      || query->file.st_dev != cached->file.st_dev
+      || query->n_scope != cached->n_scope)
+    {
+      return 0;
+    }
+  uint32_t i;
+  for (i = 0; i < query->n_scope; i++)
+    {
+      if (query->scope[i].st_ino != cached->scope[i].st_ino
+          || query->scope[i].st_dev != cached->scope[i].st_dev)
+        {
+          return 0;
+        }
+    }
+  return 1;
+}
+
+static uint32_t
+reloc_cache_entry_hash (const struct VdlRelocCacheEntry *entry)
+{
+  return (uint32_t) (entry->reloc_sym * 2 + (entry->flags & VDL_LOOKUP_NO_EXEC));
+}
+
+static int
+reloc_cache_entry_compare (const void *query_void, const void *cached_void)
+{
+  const struct VdlRelocCacheEntry *query = query_void;
+  const struct VdlRelocCacheEntry *cached = cached_void;
+  return (query->reloc_sym == cached->reloc_sym
+          && query->flags == cached->flags);
+}
+
+static void
+reloc_scope_append (struct VdlRelocScope *scope, struct VdlList *list)
+{
+  if (list == 0)
+    {
+      return;
+    }
+  void **i;
+  for (i = vdl_list_begin (list); i != vdl_list_end (list);
+       i = vdl_list_next (list, i))
+    {
+      scope->files[scope->n_files++] = *i;
+    }
+}
+
+static void
+reloc_scope_init (struct VdlFile *file, struct VdlRelocScope *scope)
+{
+  scope->files = 0;
+  scope->n_files = 0;
+  scope->cache = 0;
+
+  // files mapped from memory have no identity, and symbol remaps are
+  // specific to a context, so neither can be replayed elsewhere
+  if (file->st_ino == 0 || !vdl_list_empty (file->context->symbol_remaps))
+    {
+      return;
+    }
+
+  // the same order vdl_lookup searches in
+  struct VdlList *first = 0;
+  struct VdlList *second = 0;
+  switch (file->lookup_type)
+    {
+    case FILE_LOOKUP_LOCAL_GLOBAL:
+      first = file->local_scope;
+      second = file->context->global_scope;
+      break;
+    case FILE_LOOKUP_GLOBAL_LOCAL:
+      first = file->context->global_scope;
+      second = file->local_scope;
+      break;
+    case FILE_LOOKUP_GLOBAL_ONLY:
+      first = file->context->global_scope;
+      break;
+    case FILE_LOOKUP_LOCAL_ONLY:
+      first = file->local_scope;
+      break;
+    }
+  uint32_t n_files = (first ? vdl_list_size (first) : 0) +
+    (second ? vdl_list_size (second) : 0);
+  scope->files = vdl_alloc_malloc (n_files * sizeof (struct VdlFile *));
+  reloc_scope_append (scope, first);
+  reloc_scope_append (scope, second);
+
+  struct VdlRelocCache query;
+  query.file.st_dev = file->st_dev;
+  query.file.st_ino = file->st_ino;
+  query.n_scope = scope->n_files;
+  query.scope = vdl_alloc_malloc (n_files * sizeof (struct VdlRelocFileId));
+  uint32_t i;
+  for (i = 0; i < scope->n_files; i++)
+    {
+      if (scope->files[i]->st_ino == 0)
+        {
+          vdl_alloc_free (query.scope);
+          return;
+        }
+      query.scope[i].st_dev = scope->files[i]->st_dev;
+      query.scope[i].st_ino = scope->files[i]->st_ino;
+    }
+
+  uint32_t hash = reloc_cache_hash (&query);
+  scope->cache = vdl_hashmap_get (g_vdl.reloc_cache, hash, &query,
+                                  reloc_cache_compare);
+  if (scope->cache == 0)
+    {
+      // a concurrent insertion of the same scope only wastes memory,
+      // since every cache for it holds the same results
+      scope->cache = vdl_alloc_new (struct VdlRelocCache);
+      *scope->cache = query;
+      scope->cache->entries = vdl_hashmap_new ();
+      vdl_hashmap_insert (g_vdl.reloc_cache, hash, scope->cache);
+    }
+  else
+    {
+      vdl_alloc_free (query.scope);
+    }
+}
+
+static void
+reloc_scope_destroy (struct VdlRelocScope *scope)
+{
+  vdl_alloc_free (scope->files);
+}
+
+static struct VdlLookupResult *
+reloc_scope_lookup (struct VdlRelocScope *scope, struct VdlFile *file,
+                    unsigned long reloc_sym, const char *name,
+                    const char *ver_name, const char *ver_filename,
+                    int flags)
+{
+  if (scope == 0 || scope->cache == 0)
+    {
+      return vdl_lookup (file, name, ver_name, ver_filename, flags);
+    }
+
+  struct VdlRelocCacheEntry query;
+  query.reloc_sym = reloc_sym;
+  query.flags = flags;
+  uint32_t hash = reloc_cache_entry_hash (&query);
+  struct VdlRelocCacheEntry *entry =
+    vdl_hashmap_get (scope->cache->entries, hash, &query,
+                     reloc_cache_entry_compare);
+  if (entry != 0)
+    {
+      if (entry->scope_index < 0)
+        {
+          return 0;
+        }
+      struct VdlFile *item = scope->files[entry->scope_index];
+      if (item != file)
+        {
+          // keep the same bookkeeping vdl_lookup does for the gc
+          vdl_list_sorted_insert (file->gc_symbols_resolved_in, item);
+        }
+      struct VdlLookupResult *result =
+        vdl_alloc_new (struct VdlLookupResult);
+      result->file = item;
+      result->symbol = entry->symbol;
+      result->found = true;
+      return result;
+    }
+
+  struct VdlLookupResult *result =
+    vdl_lookup (file, name, ver_name, ver_filename, flags);
+
+  long scope_index = -1;
+  if (result)
+    {
+      uint32_t i;
+      for (i = 0; i < scope->n_files; i++)
+        {
+          if (scope->files[i] == result->file)
+            {
+              scope_index = i;
+              break;
+            }
+        }
+      if (scope_index < 0)
+        {
+          // resolved outside of the scope we know about, do not remember it
+          return result;
+        }
+    }
+
+  entry = vdl_alloc_new (struct VdlRelocCacheEntry);
+  entry->reloc_sym = reloc_sym;
+  entry->flags = flags;
+  entry->scope_index = scope_index;
+  if (result)
+    {
+      entry->symbol = result->symbol;
+    }
+  vdl_hashmap_insert (scope->cache->entries, hash, entry);
+  return result;
+}
+
 // This function populates ver_name and ver_filename with the symbol version
 // and the file version, respectively, if the symbol has a version requirement
 static bool
@@ -71,7 +331,7 @@ sym_to_ver_req (struct VdlFile *file,
 }
 
 static unsigned long
-do_process_reloc (struct VdlFile *file,
+do_process_reloc (struct VdlFile *file, struct VdlRelocScope *scope,
                   unsigned long reloc_type, unsigned long *reloc_addr,
                   unsigned long reloc_addend, unsigned long reloc_sym)
 {
@@ -108,7 +368,8 @@ do_process_reloc (struct VdlFile *file,
       sym_to_ver_req (file, reloc_sym, &ver_name, &ver_filename);
 
       struct VdlLookupResult *result;
-      result = vdl_lookup (file, symbol_name, ver_name, ver_filename, flags);
+      result = reloc_scope_lookup (scope, file, reloc_sym, symbol_name,
+                                   ver_name, ver_filename, flags);
       if (!result)
         {
           if (ELFW_ST_BIND (sym->st_info) == STB_WEAK)
@@ -161,7 +422,8 @@ do_process_reloc (struct VdlFile *file,
 }
 
 static unsigned long
-process_rel (struct VdlFile *file, ElfW (Rel) * rel)
+process_rel (struct VdlFile *file, struct VdlRelocScope *scope,
+             ElfW (Rel) * rel)
 {
   unsigned long reloc_type = ELFW_R_TYPE (rel->r_info);
   unsigned long *reloc_addr =
@@ -169,12 +431,13 @@ process_rel (struct VdlFile *file, ElfW (Rel) * rel)
   unsigned long reloc_addend = *reloc_addr;
   unsigned long reloc_sym = ELFW_R_SYM (rel->r_info);
 
-  return do_process_reloc (file, reloc_type, reloc_addr, reloc_addend,
-                           reloc_sym);
+  return do_process_reloc (file, scope, reloc_type, reloc_addr,
+                           reloc_addend, reloc_sym);
 }
 
 static unsigned long
-process_rela (struct VdlFile *file, ElfW (Rela) * rela)
+process_rela (struct VdlFile *file, struct VdlRelocScope *scope,
+              ElfW (Rela) * rela)
 {
   unsigned long reloc_type = ELFW_R_TYPE (rela->r_info);
   unsigned long *reloc_addr =
@@ -182,12 +445,12 @@ process_rela (struct VdlFile *file, ElfW (Rela) * rela)
   unsigned long reloc_addend = rela->r_addend;
   unsigned long reloc_sym = ELFW_R_SYM (rela->r_info);
 
-  return do_process_reloc (file, reloc_type, reloc_addr, reloc_addend,
-                           reloc_sym);
+  return do_process_reloc (file, scope, reloc_type, reloc_addr,
+                           reloc_addend, reloc_sym);
 }
 
 static void
-reloc_jmprel (struct VdlFile *file)
+reloc_jmprel (struct VdlFile *file, struct VdlRelocScope *scope)
 {
   VDL_LOG_FUNCTION ("file=%s", file->name);
   unsigned long dt_jmprel = file->dt_jmprel;
@@ -204,7 +467,7 @@ reloc_jmprel (struct VdlFile *file)
       for (i = 0; i < dt_pltrelsz / sizeof (ElfW (Rel)); i++)
         {
           ElfW (Rel) * rel = &(((ElfW (Rel) *) dt_jmprel)[i]);
-          process_rel (file, rel);
+          process_rel (file, scope, rel);
         }
     }
   else
@@ -213,7 +476,7 @@ reloc_jmprel (struct VdlFile *file)
       for (i = 0; i < dt_pltrelsz / sizeof (ElfW (Rela)); i++)
         {
           ElfW (Rela) * rela = &(((ElfW (Rela) *) dt_jmprel)[i]);
-          process_rela (file, rela);
+          process_rela (file, scope, rela);
         }
     }
 }
@@ -242,12 +505,12 @@ vdl_reloc_offset_jmprel (struct VdlFile *file, unsigned long offset)
   if (dt_pltrel == DT_REL)
     {
       ElfW (Rel) * rel = (ElfW (Rel) *) (dt_jmprel + offset);
-      symbol = process_rel (file, rel);
+      symbol = process_rel (file, 0, rel);
     }
   else
     {
       ElfW (Rela) * rela = (ElfW (Rela) *) (dt_jmprel + offset);
-      symbol = process_rela (file, rela);
+      symbol = process_rela (file, 0, rela);
     }
   write_unlock (file->lock);
   read_unlock (file->context->lock);
@@ -280,14 +543,14 @@ vdl_reloc_index_jmprel (struct VdlFile *file, unsigned long index)
       VDL_LOG_ASSERT (index < dt_pltrelsz / sizeof (ElfW (Rel)),
                       "Relocation entry not within range");
       ElfW (Rel) * rel = &((ElfW (Rel) *) dt_jmprel)[index];
-      symbol = process_rel (file, rel);
+      symbol = process_rel (file, 0, rel);
     }
   else
     {
       VDL_LOG_ASSERT (index < dt_pltrelsz / sizeof (ElfW (Rela)),
                       "Relocation entry not within range");
       ElfW (Rela) * rela = &((ElfW (Rela) *) dt_jmprel)[index];
-      symbol = process_rela (file, rela);
+      symbol = process_rela (file, 0, rela);
     }
   write_unlock (file->lock);
   read_unlock (file->context->lock);
@@ -297,7 +560,7 @@ vdl_reloc_index_jmprel (struct VdlFile *file, unsigned long index)
 
 
 static void
-reloc_dtrel (struct VdlFile *file)
+reloc_dtrel (struct VdlFile *file, struct VdlRelocScope *scope)
 {
   VDL_LOG_FUNCTION ("file=%s", file->name);
   ElfW (Rel) * dt_rel = file->dt_rel;
@@ -311,12 +574,12 @@ reloc_dtrel (struct VdlFile *file)
   for (i = 0; i < dt_relsz / dt_relent; i++)
     {
       ElfW (Rel) * rel = &dt_rel[i];
-      process_rel (file, rel);
+      process_rel (file, scope, rel);
     }
 }
 
 static void
-reloc_dtrela (struct VdlFile *file)
+reloc_dtrela (struct VdlFile *file, struct VdlRelocScope *scope)
 {
   VDL_LOG_FUNCTION ("file=%s", file->name);
   ElfW (Rela) * dt_rela = file->dt_rela;
@@ -330,7 +593,7 @@ reloc_dtrela (struct VdlFile *file)
   for (i = 0; i < dt_relasz / dt_relaent; i++)
     {
       ElfW (Rela) * rela = &dt_rela[i];
-      process_rela (file, rela);
+      process_rela (file, scope, rela);
     }
 }
 
@@ -358,17 +621,20 @@ do_reloc (struct VdlFile *file, int now)
         }
     }
 
-  reloc_dtrel (file);
-  reloc_dtrela (file);
+  struct VdlRelocScope scope;
+  reloc_scope_init (file, &scope);
+  reloc_dtrel (file, &scope);
+  reloc_dtrela (file, &scope);
   if (now)
     {
       // perform full PLT relocs _now_
-      reloc_jmprel (file);
+      reloc_jmprel (file, &scope);
     }
   else
     {
       machine_lazy_reloc (file);
     }
+  reloc_scope_destroy (&scope);
   if (file->dt_flags & DF_TEXTREL)
     {
       // undo the write access
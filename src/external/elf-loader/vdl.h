@@ -99,6 +99,11 @@ struct Vdl
   struct Futex *ro_cache_futex;
   // the unique ephemeral path we use for our shared memory mappings
   char* shm_path;
+  // whether readonly sections go through the readonly cache (LD_SHARE_READONLY)
+  int share_readonly;
+  // hash map of symbol resolutions per (file, lookup scope) for replay in
+  // other contexts which load the same files
+  struct VdlHashMap *reloc_cache;
   // list of thread-local allocators for cleanup
   struct VdlList *allocators;
   // the garbage collector spans multiple contexts, so needs a global futex
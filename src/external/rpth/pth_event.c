@@ -391,6 +391,17 @@ static void _pth_event_register(pth_event_t pth_ev) {
 		if(epoll_ev.events != 0) {
 		    target_fd = pth_ev->ev_args.FD.fd;
 		}
+	} else if((pth_ev->ev_type == PTH_EVENT_TIME || pth_ev->ev_type == PTH_EVENT_FUNC)
+	        && pth_gctx_has_notifier()) {
+	    /* no timer descriptor needed, the scheduler compares the expiry
+	     * against its own clock and the host wakes us up in time */
+	    if(pth_ev->ev_type == PTH_EVENT_TIME) {
+	        pth_ev->ev_args.TIME.fd = -1;
+	        pth_gctx_wakeup(pth_ev->ev_args.TIME.tv);
+	    } else {
+	        pth_ev->ev_args.FUNC.fd = -1;
+	        pth_gctx_wakeup(pth_ev->ev_args.FUNC.tv);
+	    }
 	} else if(pth_ev->ev_type == PTH_EVENT_TIME || pth_ev->ev_type == PTH_EVENT_FUNC) {
 	    pth_time_t* target_tv = NULL;
 	    target_fd = pth_sc(timerfd_create)(CLOCK_MONOTONIC, TFD_NONBLOCK);
@@ -423,12 +434,12 @@ static void _pth_event_register(pth_event_t pth_ev) {
 	}
 
 	if(target_fd > 0) {
-        int rc = pth_sc(epoll_ctl)(pth_gctx_get()->main_efd, EPOLL_CTL_ADD, target_fd, &epoll_ev);
+        int rc = pth_gctx_watch(EPOLL_CTL_ADD, target_fd, &epoll_ev);
 
         if(rc < 0) {
             if(errno == EEXIST) {
                 /* this didnt get added because it was already there. so try to mod it instead */
-                rc = pth_sc(epoll_ctl)(pth_gctx_get()->main_efd, EPOLL_CTL_MOD, target_fd, &epoll_ev);
+                rc = pth_gctx_watch(EPOLL_CTL_MOD, target_fd, &epoll_ev);
             }
             if (rc < 0) {
                 /* this didnt get added because of some other error, or the mod failed too */
@@ -456,7 +467,7 @@ static void _pth_event_deregister(pth_event_t pth_ev) {
     }
 
     if(target_fd > 0) {
-        pth_sc(epoll_ctl)(pth_gctx_get()->main_efd, EPOLL_CTL_DEL, target_fd, NULL);
+        pth_gctx_watch(EPOLL_CTL_DEL, target_fd, NULL);
 
         /* do we need to delete the timer we created in _pth_event_register()? */
         if(pth_ev->ev_type == PTH_EVENT_TIME || pth_ev->ev_type == PTH_EVENT_FUNC) {
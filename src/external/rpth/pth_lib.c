@@ -60,7 +60,9 @@ struct pth_gctx_st {
     pth_time_t   pth_loadticknext;
     pth_time_t   pth_loadtickgap;
 
-    int main_efd; // epoll fd
+    int main_efd; // epoll fd, created on first use when no notifier is set
+    int has_notifier;
+    pth_notifier_t notifier;
 
     struct pth_keytab_st pth_keytab[PTH_KEY_MAX];
     pth_key_t ev_key_join;
@@ -141,6 +143,7 @@ pth_gctx_t pth_gctx_new(int may_block)
     gctx->mutex_pread = __mutex_initializer;
     gctx->mutex_pwrite = __mutex_initializer;
     gctx->pth_atfork_idx = 0;
+    gctx->main_efd = -1;
 
     gctx->ev_key_join = PTH_KEY_INIT;
     gctx->ev_key_nap = PTH_KEY_INIT;
@@ -174,6 +177,58 @@ int pth_gctx_get_main_epollfd(pth_gctx_t gctx) {
     return gctx->main_efd;
 }
 
+int pth_gctx_set_notifier(pth_gctx_t gctx, const pth_notifier_t *notifier) {
+    if(!gctx) return pth_error(FALSE, EINVAL);
+    if(notifier) {
+        if(!notifier->watch || !notifier->collect || !notifier->wakeup)
+            return pth_error(FALSE, EINVAL);
+        gctx->notifier = *notifier;
+        gctx->has_notifier = TRUE;
+    } else {
+        memset(&gctx->notifier, 0, sizeof(pth_notifier_t));
+        gctx->has_notifier = FALSE;
+    }
+    return TRUE;
+}
+
+intern int pth_gctx_has_notifier(void)
+{
+    return pth_gctx_get()->has_notifier;
+}
+
+/* track readiness of fd, either through the host notifier or our own epoll */
+intern int pth_gctx_watch(int op, int fd, struct epoll_event *ev)
+{
+    pth_gctx_t gctx = pth_gctx_get();
+    if(gctx->has_notifier)
+        return gctx->notifier.watch(gctx->notifier.arg, op, fd, ev);
+    if(gctx->main_efd < 0) {
+        gctx->main_efd = pth_sc(epoll_create)(1);
+        if(gctx->main_efd < 0)
+            return -1;
+    }
+    return pth_sc(epoll_ctl)(gctx->main_efd, op, fd, ev);
+}
+
+/* fetch ready events without blocking */
+intern int pth_gctx_collect(struct epoll_event *evs, int maxevs)
+{
+    pth_gctx_t gctx = pth_gctx_get();
+    if(gctx->has_notifier)
+        return gctx->notifier.collect(gctx->notifier.arg, evs, maxevs);
+    if(gctx->main_efd < 0)
+        return 0;
+    return pth_sc(epoll_wait)(gctx->main_efd, evs, maxevs, 0);
+}
+
+/* ask the host to run the scheduler again at the absolute time when */
+intern void pth_gctx_wakeup(pth_time_t when)
+{
+    pth_gctx_t gctx = pth_gctx_get();
+    if(gctx->has_notifier)
+        gctx->notifier.wakeup(gctx->notifier.arg, when);
+}
+
 /* initialize the package */
 
 static int pth_init_helper(void)
@@ -233,9 +288,6 @@ static int pth_init_helper(void)
     }
     pth_attr_destroy(t_attr);
 
-    /* create our epoll instance, used for scheduling */
-    pth_gctx_get()->main_efd = epoll_create(1);
-
     /*
      * The first time we've to manually switch into the scheduler to start
      * threading. Because at this time the only non-scheduler thread is the
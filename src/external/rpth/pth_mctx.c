@@ -29,6 +29,18 @@
 
 #if cpp
 
+/*
+ * Building with PTH_MCTX_X86_64_ASM defined replaces whatever method
+ * configure chose with a minimal x86-64 switch: only the callee-saved
+ * registers, the FPU/SSE control words and the stack pointer are saved, and
+ * the signal mask is left alone, so no switch needs a system call.
+ */
+#if defined(PTH_MCTX_X86_64_ASM) && defined(__x86_64__)
+#define PTH_MCTX_ASM 1
+#else
+#define PTH_MCTX_ASM 0
+#endif
+
 /*
  * machine context state structure
  *
@@ -45,7 +57,9 @@
 
 typedef struct pth_mctx_st pth_mctx_t;
 struct pth_mctx_st {
-#if PTH_MCTX_MTH(mcsc)
+#if PTH_MCTX_ASM
+    void *sp;
+#elif PTH_MCTX_MTH(mcsc)
     ucontext_t uc;
     int restored;
 #elif PTH_MCTX_MTH(sjlj)
@@ -64,10 +78,17 @@ struct pth_mctx_st {
 ** ____ MACHINE STATE SWITCHING ______________________________________
 */
 
+#if PTH_MCTX_ASM
+extern void pth_mctx_asm_switch(void **oldsp, void *newsp);
+extern void pth_mctx_asm_restore(void *newsp);
+#endif
+
 /*
  * save the current machine context
+ * (the asm method only switches, it never saves on its own)
  */
-#if PTH_MCTX_MTH(mcsc)
+#if PTH_MCTX_ASM
+#elif PTH_MCTX_MTH(mcsc)
 #define pth_mctx_save(mctx) \
         ( (mctx)->error = errno, \
           (mctx)->restored = 0, \
@@ -90,7 +111,11 @@ struct pth_mctx_st {
  * restore the current machine context
  * (at the location of the old context)
  */
-#if PTH_MCTX_MTH(mcsc)
+#if PTH_MCTX_ASM
+#define pth_mctx_restore(mctx) \
+        ( errno = (mctx)->error, \
+          pth_mctx_asm_restore((mctx)->sp) )
+#elif PTH_MCTX_MTH(mcsc)
 #define pth_mctx_restore(mctx) \
         ( errno = (mctx)->error, \
           (mctx)->restored = 1, \
@@ -125,7 +150,13 @@ struct pth_mctx_st {
 #else
 #define  _pth_mctx_switch_debug /*NOP*/
 #endif
-#if PTH_MCTX_MTH(mcsc)
+#if PTH_MCTX_ASM
+#define pth_mctx_switch(old,new) \
+    _pth_mctx_switch_debug \
+    (old)->error = errno; \
+    pth_mctx_asm_switch(&((old)->sp), (new)->sp); \
+    errno = (old)->error;
+#elif PTH_MCTX_MTH(mcsc)
 #define pth_mctx_switch(old,new) \
     _pth_mctx_switch_debug \
     swapcontext(&((old)->uc), &((new)->uc));
@@ -145,7 +176,87 @@ struct pth_mctx_st {
 ** ____ MACHINE STATE INITIALIZATION ________________________________
 */
 
-#if PTH_MCTX_MTH(mcsc)
+#if PTH_MCTX_ASM
+
+/*
+ * VARIANT 0: MINIMAL X86-64 SWITCH
+ *
+ * A context is just a stack pointer. The stack holds, from the saved
+ * pointer upwards: the MXCSR and x87 control words, r15, r14, r13, r12,
+ * rbx, rbp and the address to return to. Switching pushes these for the
+ * old context, swaps stack pointers and pops them for the new one.
+ */
+
+__asm__(
+    ".text\n"
+    ".p2align 4\n"
+    ".globl pth_mctx_asm_switch\n"
+    ".hidden pth_mctx_asm_switch\n"
+    ".type pth_mctx_asm_switch, @function\n"
+    "pth_mctx_asm_switch:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    subq $8, %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw 4(%rsp)\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rdi\n"
+    ".globl pth_mctx_asm_restore\n"
+    ".hidden pth_mctx_asm_restore\n"
+    ".type pth_mctx_asm_restore, @function\n"
+    "pth_mctx_asm_restore:\n"
+    "    movq %rdi, %rsp\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw 4(%rsp)\n"
+    "    addq $8, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size pth_mctx_asm_switch, .-pth_mctx_asm_switch\n"
+);
+
+intern int pth_mctx_set(
+    pth_mctx_t *mctx, void (*func)(void), char *sk_addr_lo, char *sk_addr_hi)
+{
+    unsigned long *sp;
+    unsigned int mxcsr;
+    unsigned short fpucw;
+
+    if (sk_addr_hi - sk_addr_lo < 256)
+        return FALSE;
+
+    /* the first switch "returns" into func with the stack aligned as if
+       it had been called, and a zero return address above it */
+    sp = (unsigned long *)((unsigned long)sk_addr_hi & ~15UL);
+    *--sp = 0;
+    *--sp = (unsigned long)func;
+    *--sp = 0; /* rbp */
+    *--sp = 0; /* rbx */
+    *--sp = 0; /* r12 */
+    *--sp = 0; /* r13 */
+    *--sp = 0; /* r14 */
+    *--sp = 0; /* r15 */
+
+    /* start with the control words of the creating thread */
+    __asm__ __volatile__("stmxcsr %0" : "=m"(mxcsr));
+    __asm__ __volatile__("fnstcw %0" : "=m"(fpucw));
+    *--sp = (unsigned long)mxcsr | ((unsigned long)fpucw << 32);
+
+    mctx->sp = (void *)sp;
+    mctx->error = 0;
+    sigemptyset(&mctx->sigs);
+    return TRUE;
+}
+
+#elif PTH_MCTX_MTH(mcsc)
 
 /*
  * VARIANT 1: THE STANDARDIZED SVR4/SUSv2 APPROACH
@@ -27,6 +27,9 @@
                                      -- Unknown   */
 #include "pth_p.h"
 
+/* how many ready events the async scheduler collects per pass */
+#define PTH_SCHED_EVENTS_MAX 100
+
 /* initialize the scheduler ingredients */
 intern int pth_scheduler_init(void)
 {
@@ -100,11 +103,17 @@ intern void pth_scheduler_kill(void)
     /* remove the internal signal pipe */
     close(pth_gctx_get()->pth_sigpipe[0]);
     close(pth_gctx_get()->pth_sigpipe[1]);
+
+    /* remove the epoll instance, if we ever needed one */
+    if (pth_gctx_get()->main_efd >= 0) {
+        pth_sc(close)(pth_gctx_get()->main_efd);
+        pth_gctx_get()->main_efd = -1;
+    }
     return;
 }
 
 
-static int pth_sched_check_pth_events(pth_t t) {
+static int pth_sched_check_pth_events(pth_t t, pth_time_t *now) {
     if(!t || !t->events) {
         return 0;
     }
@@ -118,8 +127,16 @@ static int pth_sched_check_pth_events(pth_t t) {
              * here we wait check on other pth event types that epoll does not watch */
             int did_occur = FALSE;
 
+            /* Timers, when a host notifier replaced the timer descriptors */
+            if ((ev->ev_type == PTH_EVENT_TIME || ev->ev_type == PTH_EVENT_FUNC)
+                    && pth_gctx_has_notifier()) {
+                pth_time_t *tv = (ev->ev_type == PTH_EVENT_TIME) ?
+                        &ev->ev_args.TIME.tv : &ev->ev_args.FUNC.tv;
+                if (pth_time_cmp(tv, now) <= 0)
+                    did_occur = TRUE;
+            }
             /* Message Port Arrivals */
-            if (ev->ev_type == PTH_EVENT_MSG) {
+            else if (ev->ev_type == PTH_EVENT_MSG) {
                 if (pth_ring_elements(&(ev->ev_args.MSG.mp->mp_queue)) > 0)
                     did_occur = TRUE;
             }
@@ -220,9 +237,10 @@ static void pth_sched_eventmanager_async(pth_time_t *now) {
         return;
     }
 
-    /* check for events without blocking!! */
-    struct epoll_event* events_ready = calloc(100, sizeof(struct epoll_event));
-    int n_events_ready = pth_sc(epoll_wait)(pth_gctx_get()->main_efd, events_ready, 100, 0);
+    /* check for events without blocking!! events are level triggered, so
+     * anything beyond this batch is picked up on the next pass */
+    struct epoll_event events_ready[PTH_SCHED_EVENTS_MAX];
+    int n_events_ready = pth_gctx_collect(events_ready, PTH_SCHED_EVENTS_MAX);
 
     /* mark events based on the status we got from epoll */
     int i;
@@ -258,10 +276,6 @@ static void pth_sched_eventmanager_async(pth_time_t *now) {
         }
     }
 
-    /* cleanup */
-    free(events_ready);
-    events_ready = NULL;
-
     /* now comes the final cleanup loop where we've to do two jobs:
      * 1 handle all pth event types for all threads
      * 2 move threads with occurred events from the waiting queue to the ready queue */
@@ -270,7 +284,7 @@ static void pth_sched_eventmanager_async(pth_time_t *now) {
     while (t != NULL) {
         /* do the late handling of the fd I/O and signal
            events in the waiting event ring */
-        int n_events_occurred = pth_sched_check_pth_events(t);
+        int n_events_occurred = pth_sched_check_pth_events(t, now);
 
         /* cancellation support */
         if (t->cancelreq == TRUE) {
@@ -571,11 +585,11 @@ intern void *pth_scheduler(void *dummy)
 }
 
 static int rpth_epoll_ctl_helper(int epollfd, int op, int fd, void* data, uint32_t evset) {
-    struct epoll_event* epollev = calloc(1, sizeof(struct epoll_event));
-    epollev->events = evset;
-    epollev->data.ptr = data;
-    int ret = epoll_ctl(epollfd, op, fd, epollev);
-    free(epollev);
+    struct epoll_event epollev;
+    memset(&epollev, 0, sizeof(struct epoll_event));
+    epollev.events = evset;
+    epollev.data.ptr = data;
+    int ret = epoll_ctl(epollfd, op, fd, &epollev);
     if(ret == 0) {
         /* all good, 1 fd got added */
         return 1;
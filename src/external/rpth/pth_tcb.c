@@ -26,6 +26,8 @@
                                 Doctor: Well, then don't do it. */
 #include "pth_p.h"
 
+#include <sys/mman.h>
+
 #if cpp
 
 #define PTH_TCB_NAMELEN 40
@@ -108,6 +110,96 @@ intern const char *pth_state_names[] = {
 #endif
 #endif
 
+/*
+ * Thread stacks are private anonymous mappings that the kernel only commits
+ * as the thread touches them, with an inaccessible guard page at the end
+ * the stack grows towards. Released stacks are kept in a small per-OS-thread
+ * pool and reused by later threads of the same stack size, so thread churn
+ * neither goes back to the kernel nor to the heap.
+ */
+#define PTH_STACKPOOL_MAX 64
+
+struct pth_stackpool_st {
+    char        *stack;
+    unsigned int stacksize;
+};
+static __thread struct pth_stackpool_st pth_stackpool[PTH_STACKPOOL_MAX];
+static __thread int pth_stackpool_len = 0;
+
+static size_t pth_stack_pagesize(void)
+{
+    static size_t pagesize = 0;
+    if (pagesize == 0) {
+        long ps = sysconf(_SC_PAGESIZE);
+        pagesize = (ps > 0 ? (size_t)ps : 4096);
+    }
+    return pagesize;
+}
+
+/* the stack size rounded up to whole pages, as used for mapped stacks */
+static unsigned int pth_stack_roundsize(unsigned int stacksize)
+{
+    size_t pagesize = pth_stack_pagesize();
+    return (unsigned int)(((size_t)stacksize + pagesize - 1) & ~(pagesize - 1));
+}
+
+static char *pth_stack_map(unsigned int stacksize)
+{
+    size_t pagesize = pth_stack_pagesize();
+    size_t mapsize = (size_t)stacksize + pagesize;
+    char *region;
+    int i;
+
+    /* reuse the most recently released stack of the same size */
+    for (i = pth_stackpool_len - 1; i >= 0; i--) {
+        if (pth_stackpool[i].stacksize == stacksize) {
+            char *stack = pth_stackpool[i].stack;
+            pth_stackpool[i] = pth_stackpool[--pth_stackpool_len];
+            return stack;
+        }
+    }
+
+    region = (char *)mmap(NULL, mapsize, PROT_READ|PROT_WRITE,
+                          MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+    if (region == MAP_FAILED)
+        return NULL;
+
+#if PTH_STACKGROWTH < 0
+    if (mprotect(region, pagesize, PROT_NONE) != 0) {
+        pth_shield { munmap(region, mapsize); }
+        return NULL;
+    }
+    return region + pagesize;
+#else
+    if (mprotect(region + stacksize, pagesize, PROT_NONE) != 0) {
+        pth_shield { munmap(region, mapsize); }
+        return NULL;
+    }
+    return region;
+#endif
+}
+
+static void pth_stack_unmap(char *stack, unsigned int stacksize)
+{
+    size_t pagesize = pth_stack_pagesize();
+
+    if (pth_stackpool_len < PTH_STACKPOOL_MAX) {
+        /* drop the pages the thread used, so the stack is zero-filled and
+           uncommitted again when it is reused */
+        madvise(stack, (size_t)stacksize, MADV_DONTNEED);
+        pth_stackpool[pth_stackpool_len].stack = stack;
+        pth_stackpool[pth_stackpool_len].stacksize = stacksize;
+        pth_stackpool_len++;
+        return;
+    }
+
+#if PTH_STACKGROWTH < 0
+    munmap(stack - pagesize, (size_t)stacksize + pagesize);
+#else
+    munmap(stack, (size_t)stacksize + pagesize);
+#endif
+}
+
 /* allocate a thread control block */
 intern pth_t pth_tcb_alloc(unsigned int stacksize, void *stackaddr)
 {
@@ -115,6 +207,8 @@ intern pth_t pth_tcb_alloc(unsigned int stacksize, void *stackaddr)
 
     if (stacksize > 0 && stacksize < SIGSTKSZ)
         stacksize = SIGSTKSZ;
+    if (stacksize > 0 && stackaddr == NULL)
+        stacksize = pth_stack_roundsize(stacksize);
     if ((t = (pth_t)calloc(1, sizeof(struct pth_st))) == NULL)
         return NULL;
 
@@ -128,7 +222,7 @@ intern pth_t pth_tcb_alloc(unsigned int stacksize, void *stackaddr)
         if (stackaddr != NULL)
             t->stack = (char *)(stackaddr);
         else {
-            if ((t->stack = (char *)calloc(1, stacksize)) == NULL) {
+            if ((t->stack = pth_stack_map(stacksize)) == NULL) {
                 pth_shield { free(t); }
                 return NULL;
             }
@@ -160,17 +254,14 @@ intern void pth_tcb_free(pth_t t)
 {
     if (t == NULL || t->stackguard == NULL)
         return;
-    if (t->stack != NULL && !t->stackloan) {
-        if(t->stacksize > 0) {
+    if (t->stack != NULL && !t->stackloan && t->stacksize > 0) {
 #ifdef PTH_VALGRIND
 #ifdef PTH_DEBUG
-            pth_debug5("pth_tcb_free: freeing stack of size %u at [0x%p-0x%p] with valgrind id %i",
-              t->stacksize, t->stack, &t->stack[t->stacksize], t->valgrind_id);
+        pth_debug5("pth_tcb_free: freeing stack of size %u at [0x%p-0x%p] with valgrind id %i",
+          t->stacksize, t->stack, &t->stack[t->stacksize], t->valgrind_id);
 #endif
 #endif
-            memset(t->stack, 0, (size_t)t->stacksize);
-        }
-        free(t->stack);
+        pth_stack_unmap(t->stack, t->stacksize);
     }
     if (t->data_value != NULL)
         free(t->data_value);
@@ -186,4 +277,3 @@ intern void pth_tcb_free(pth_t t)
     free(t);
     return;
 }
-
@@ -3,76 +3,436 @@
  * See LICENSE for licensing information
  */
 
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 #include "shadow.h"
 
+/* log records are compact binary entries stored back to back in the chunks of
+ * a per-thread bundle: the call site info, the format string pointer, and the
+ * raw arguments the format consumes. all string formatting is deferred until
+ * the logger helper thread writes the record out. */
+
+/* default capacity of the chunks that hold packed records */
+#define LOGRECORD_CHUNK_SIZE (64*1024)
+/* longest single conversion spec (e.g. "%-08.3lf") we carry over */
+#define LOGRECORD_MAX_SPEC 32
+/* all records and packed arguments start on this boundary */
+#define LOGRECORD_ALIGN(x) (((x) + 7) & ~((gsize)7))
+/* marks a NULL string argument */
+#define LOGRECORD_NULL_STRING G_MAXUINT32
+
+typedef enum _LogRecordArgType LogRecordArgType;
+enum _LogRecordArgType {
+    LRA_INT, LRA_LONG, LRA_LONGLONG, LRA_INTMAX, LRA_SIZE, LRA_PTRDIFF,
+    LRA_DOUBLE, LRA_LONGDOUBLE, LRA_STRING, LRA_POINTER, LRA_UNSUPPORTED,
+};
+
 struct _LogRecord {
-    /* required */
     LogLevel level;
-    gchar* callInfo;
-
-    /* optional */
+    gint threadID;
+    GQuark hostID;
+    gint lineNumber;
     SimulationTime simElapsedNanos;
     gdouble wallElapsedSeconds;
-    gchar* threadName;
-    gchar* hostName;
-    gchar* message;
-
-    /* for memory management */
-    gint referenceCount;
+    /* these point into static storage of the shadow binary */
+    const gchar* fileName;
+    const gchar* functionName;
+    const gchar* format;
+    /* size of this record including the packed arguments that follow it */
+    gsize length;
     MAGIC_DECLARE;
 };
 
-LogRecord* logrecord_new(LogLevel level, gdouble timespan, const gchar* fileName, const gchar* functionName, const gint lineNumber) {
-    LogRecord* record = g_new0(LogRecord, 1);
-    MAGIC_INIT(record);
+typedef struct _LogRecordChunk LogRecordChunk;
+struct _LogRecordChunk {
+    gsize capacity;
+    gsize used;
+    gsize readOffset;
+    guchar* data;
+};
 
-    record->level = level;
-    record->simElapsedNanos = SIMTIME_INVALID;
-    record->wallElapsedSeconds = timespan;
+struct _LogRecordBundle {
+    GQueue* chunks;
+    /* the chunk the reader is currently in */
+    GList* readLink;
+    gsize numRecords;
+    MAGIC_DECLARE;
+};
 
-    gchar* baseName = (fileName != NULL) ? g_path_get_basename(fileName) : NULL;
+/* a format or call site string may only be kept by pointer if it lives in our
+ * own image (.rodata), since anything else may be gone before we format it */
+static gboolean _logrecord_isStaticString(const gchar* str) {
+    extern gchar __executable_start[];
+    extern gchar edata[];
+    return (str != NULL && str >= __executable_start && str < edata) ? TRUE : FALSE;
+}
 
-    record->callInfo = g_strdup_printf("[%s:%i] [%s]",
-            (baseName != NULL) ? baseName : "n/a", lineNumber, functionName ? functionName : "n/a");
+/* finds the next conversion in format, returning a pointer to its '%' or NULL
+ * if there are no more. sets the length of the whole spec, the type of the
+ * argument it consumes, and its precision (or -1 if none was given). */
+static const gchar* _logrecord_nextConversion(const gchar* format, gsize* specLength,
+        LogRecordArgType* type, gint* precision) {
+    const gchar* p = format;
+    while((p = strchr(p, '%')) != NULL) {
+        if(p[1] == '%') {
+            p += 2;
+            continue;
+        }
+
+        const gchar* s = p + 1;
+        *precision = -1;
+
+        /* positional arguments would need the whole list at once */
+        const gchar* digits = s;
+        while(g_ascii_isdigit(*digits)) {
+            digits++;
+        }
+        if(*digits == '$') {
+            *specLength = (gsize)(digits - p) + 1;
+            *type = LRA_UNSUPPORTED;
+            return p;
+        }
+
+        while(*s && strchr("-+ #0'I", *s)) {
+            s++;
+        }
+        /* so would widths and precisions taken from the arguments */
+        if(*s == '*') {
+            *specLength = (gsize)(s - p) + 1;
+            *type = LRA_UNSUPPORTED;
+            return p;
+        }
+        while(g_ascii_isdigit(*s)) {
+            s++;
+        }
+        if(*s == '.') {
+            s++;
+            if(*s == '*') {
+                *specLength = (gsize)(s - p) + 1;
+                *type = LRA_UNSUPPORTED;
+                return p;
+            }
+            *precision = 0;
+            while(g_ascii_isdigit(*s)) {
+                *precision = (*precision * 10) + (*s - '0');
+                s++;
+            }
+        }
+
+        gint numLongs = 0;
+        gchar modifier = 0;
+        while(*s) {
+            if(*s == 'l') {
+                numLongs++;
+            } else if(strchr("hLqjzt", *s)) {
+                modifier = *s;
+            } else {
+                break;
+            }
+            s++;
+        }
+
+        gchar conversion = *s;
+        if(conversion == '\0') {
+            *specLength = (gsize)(s - p);
+            *type = LRA_UNSUPPORTED;
+            return p;
+        }
+        s++;
+        *specLength = (gsize)(s - p);
+
+        switch(conversion) {
+            case 'd': case 'i': case 'o': case 'u': case 'x': case 'X': {
+                if(modifier == 'j') {
+                    *type = LRA_INTMAX;
+                } else if(modifier == 'z') {
+                    *type = LRA_SIZE;
+                } else if(modifier == 't') {
+                    *type = LRA_PTRDIFF;
+                } else if(numLongs >= 2 || modifier == 'L' || modifier == 'q') {
+                    *type = LRA_LONGLONG;
+                } else if(numLongs == 1) {
+                    *type = LRA_LONG;
+                } else {
+                    *type = LRA_INT;
+                }
+                break;
+            }
+            case 'c': {
+                *type = (numLongs > 0) ? LRA_UNSUPPORTED : LRA_INT;
+                break;
+            }
+            case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A': {
+                *type = (modifier == 'L') ? LRA_LONGDOUBLE : LRA_DOUBLE;
+                break;
+            }
+            case 's': {
+                *type = (numLongs > 0) ? LRA_UNSUPPORTED : LRA_STRING;
+                break;
+            }
+            case 'p': {
+                *type = LRA_POINTER;
+                break;
+            }
+            default: {
+                /* %n, %m, wide chars, and anything we do not know */
+                *type = LRA_UNSUPPORTED;
+                break;
+            }
+        }
+        return p;
+    }
+    return NULL;
+}
 
-    if(baseName != NULL) {
-        g_free(baseName);
+static gboolean _logrecord_canDefer(const gchar* format) {
+    if(!_logrecord_isStaticString(format)) {
+        return FALSE;
     }
 
-    return record;
+    gsize specLength = 0;
+    LogRecordArgType type = LRA_UNSUPPORTED;
+    gint precision = -1;
+    const gchar* conversion = format;
+    while((conversion = _logrecord_nextConversion(conversion, &specLength, &type, &precision)) != NULL) {
+        if(type == LRA_UNSUPPORTED || specLength >= LOGRECORD_MAX_SPEC) {
+            return FALSE;
+        }
+        conversion += specLength;
+    }
+    return TRUE;
 }
 
-static void _logrecord_free(LogRecord* record) {
-    MAGIC_ASSERT(record);
+static LogRecordChunk* _logrecordchunk_new(gsize capacity) {
+    LogRecordChunk* chunk = g_new0(LogRecordChunk, 1);
+    chunk->capacity = capacity;
+    chunk->data = g_malloc(capacity);
+    return chunk;
+}
+
+static void _logrecordchunk_free(LogRecordChunk* chunk) {
+    g_free(chunk->data);
+    g_free(chunk);
+}
+
+LogRecordBundle* logrecordbundle_new() {
+    LogRecordBundle* bundle = g_new0(LogRecordBundle, 1);
+    MAGIC_INIT(bundle);
+    bundle->chunks = g_queue_new();
+    return bundle;
+}
+
+void logrecordbundle_free(LogRecordBundle* bundle) {
+    MAGIC_ASSERT(bundle);
+    g_queue_free_full(bundle->chunks, (GDestroyNotify)_logrecordchunk_free);
+    MAGIC_CLEAR(bundle);
+    g_free(bundle);
+}
 
-    if(record->callInfo != NULL) {
-        g_free(record->callInfo);
+gboolean logrecordbundle_isEmpty(LogRecordBundle* bundle) {
+    MAGIC_ASSERT(bundle);
+    return (bundle->numRecords == 0) ? TRUE : FALSE;
+}
+
+/* makes room for needed more bytes of the record under construction, whose
+ * first recordLength bytes are already at the end of the tail chunk. the
+ * partial record moves to a fresh chunk if the tail one is full.
+ * returns the (possibly new) start of the record. */
+static guchar* _logrecordbundle_reserve(LogRecordBundle* bundle, gsize recordLength, gsize needed) {
+    LogRecordChunk* chunk = g_queue_peek_tail(bundle->chunks);
+    if(chunk == NULL || chunk->used + recordLength + needed > chunk->capacity) {
+        gsize capacity = MAX(LOGRECORD_CHUNK_SIZE, 2 * (recordLength + needed));
+        LogRecordChunk* newChunk = _logrecordchunk_new(capacity);
+        if(chunk != NULL && recordLength > 0) {
+            memcpy(newChunk->data, chunk->data + chunk->used, recordLength);
+        }
+        g_queue_push_tail(bundle->chunks, newChunk);
+        chunk = newChunk;
     }
-    if(record->hostName != NULL) {
-        g_free(record->hostName);
+    return chunk->data + chunk->used;
+}
+
+static guchar* _logrecordbundle_packValue(LogRecordBundle* bundle, gsize* recordLength,
+        gconstpointer value, gsize valueLength) {
+    gsize slotLength = LOGRECORD_ALIGN(valueLength);
+    guchar* recordStart = _logrecordbundle_reserve(bundle, *recordLength, slotLength);
+    memcpy(recordStart + *recordLength, value, valueLength);
+    *recordLength += slotLength;
+    return recordStart;
+}
+
+static guchar* _logrecordbundle_packString(LogRecordBundle* bundle, gsize* recordLength,
+        const gchar* str, gint precision) {
+    guint32 stringLength = LOGRECORD_NULL_STRING;
+    gsize copyLength = 0;
+    if(str != NULL) {
+        /* with a precision, the string need not be terminated */
+        copyLength = (precision >= 0) ? strnlen(str, (gsize)precision) : strlen(str);
+        stringLength = (guint32)copyLength;
     }
-    if(record->threadName != NULL) {
-        g_free(record->threadName);
+
+    gsize slotLength = LOGRECORD_ALIGN(sizeof(guint32) + copyLength + 1);
+    guchar* recordStart = _logrecordbundle_reserve(bundle, *recordLength, slotLength);
+    guchar* slot = recordStart + *recordLength;
+    memcpy(slot, &stringLength, sizeof(guint32));
+    if(copyLength > 0) {
+        memcpy(slot + sizeof(guint32), str, copyLength);
     }
-    if(record->message != NULL) {
-        g_free(record->message);
+    slot[sizeof(guint32) + copyLength] = '\0';
+    *recordLength += slotLength;
+    return recordStart;
+}
+
+static guchar* _logrecordbundle_packArguments(LogRecordBundle* bundle, gsize* recordLength,
+        const gchar* format, va_list vargs) {
+    guchar* recordStart = _logrecordbundle_reserve(bundle, *recordLength, 0);
+
+    gsize specLength = 0;
+    LogRecordArgType type = LRA_UNSUPPORTED;
+    gint precision = -1;
+    const gchar* conversion = format;
+    while((conversion = _logrecord_nextConversion(conversion, &specLength, &type, &precision)) != NULL) {
+        conversion += specLength;
+
+        switch(type) {
+            case LRA_INT: {
+                gint64 value = (gint64)va_arg(vargs, int);
+                recordStart = _logrecordbundle_packValue(bundle, recordLength, &value, sizeof(value));
+                break;
+            }
+            case LRA_LONG: {
+                gint64 value = (gint64)va_arg(vargs, long);
+                recordStart = _logrecordbundle_packValue(bundle, recordLength, &value, sizeof(value));
+                break;
+            }
+            case LRA_LONGLONG: {
+                gint64 value = (gint64)va_arg(vargs, long long);
+                recordStart = _logrecordbundle_packValue(bundle, recordLength, &value, sizeof(value));
+                break;
+            }
+            case LRA_INTMAX: {
+                intmax_t value = va_arg(vargs, intmax_t);
+                recordStart = _logrecordbundle_packValue(bundle, recordLength, &value, sizeof(value));
+                break;
+            }
+            case LRA_SIZE: {
+                size_t value = va_arg(vargs, size_t);
+                recordStart = _logrecordbundle_packValue(bundle, recordLength, &value, sizeof(value));
+                break;
+            }
+            case LRA_PTRDIFF: {
+                ptrdiff_t value = va_arg(vargs, ptrdiff_t);
+                recordStart = _logrecordbundle_packValue(bundle, recordLength, &value, sizeof(value));
+                break;
+            }
+            case LRA_DOUBLE: {
+                gdouble value = va_arg(vargs, double);
+                recordStart = _logrecordbundle_packValue(bundle, recordLength, &value, sizeof(value));
+                break;
+            }
+            case LRA_LONGDOUBLE: {
+                long double value = va_arg(vargs, long double);
+                recordStart = _logrecordbundle_packValue(bundle, recordLength, &value, sizeof(value));
+                break;
+            }
+            case LRA_STRING: {
+                const gchar* value = va_arg(vargs, const gchar*);
+                recordStart = _logrecordbundle_packString(bundle, recordLength, value, precision);
+                break;
+            }
+            case LRA_POINTER: {
+                gpointer value = va_arg(vargs, gpointer);
+                recordStart = _logrecordbundle_packValue(bundle, recordLength, &value, sizeof(value));
+                break;
+            }
+            default: {
+                /* _logrecord_canDefer already made sure we do not get here */
+                utility_assert(FALSE && "unsupported log format conversion");
+                break;
+            }
+        }
     }
 
-    MAGIC_CLEAR(record);
-    g_free(record);
+    return recordStart;
 }
 
-void logrecord_ref(LogRecord* record) {
-    MAGIC_ASSERT(record);
-    record->referenceCount++;
+LogRecord* logrecordbundle_append(LogRecordBundle* bundle, LogLevel level, gdouble timespan,
+        const gchar* fileName, const gchar* functionName, const gint lineNumber,
+        const gchar* format, va_list vargs) {
+    MAGIC_ASSERT(bundle);
+
+    /* the header is written in place so it moves along with the partial
+     * record if the arguments do not fit into the current chunk */
+    gsize recordLength = LOGRECORD_ALIGN(sizeof(LogRecord));
+    guchar* recordStart = _logrecordbundle_reserve(bundle, 0, recordLength);
+
+    LogRecord* record = (LogRecord*)recordStart;
+    memset(record, 0, sizeof(LogRecord));
+    MAGIC_INIT(record);
+    record->level = level;
+    record->simElapsedNanos = SIMTIME_INVALID;
+    record->wallElapsedSeconds = timespan;
+    record->lineNumber = lineNumber;
+    record->fileName = _logrecord_isStaticString(fileName) ? fileName : NULL;
+    record->functionName = _logrecord_isStaticString(functionName) ? functionName : NULL;
+
+    const gchar* recordFormat = NULL;
+    if(format != NULL && _logrecord_canDefer(format)) {
+        recordFormat = format;
+        recordStart = _logrecordbundle_packArguments(bundle, &recordLength, format, vargs);
+    } else if(format != NULL) {
+        /* we can not keep this format around, so pay for formatting it now */
+        gchar* message = g_strdup_vprintf(format, vargs);
+        recordFormat = "%s";
+        recordStart = _logrecordbundle_packString(bundle, &recordLength, message, -1);
+        g_free(message);
+    }
+
+    record = (LogRecord*)recordStart;
+    record->format = recordFormat;
+    record->length = recordLength;
+
+    LogRecordChunk* chunk = g_queue_peek_tail(bundle->chunks);
+    chunk->used += recordLength;
+    bundle->numRecords++;
+
+    return record;
 }
 
-void logrecord_unref(LogRecord* record) {
-    MAGIC_ASSERT(record);
-    record->referenceCount--;
-    if(record->referenceCount <= 0) {
-        _logrecord_free(record);
+LogRecord* logrecordbundle_peekHead(LogRecordBundle* bundle) {
+    MAGIC_ASSERT(bundle);
+
+    /* chunks that were read entirely stay around until the bundle is freed,
+     * since callers may still hold pointers to their records */
+    if(bundle->readLink == NULL) {
+        bundle->readLink = g_queue_peek_head_link(bundle->chunks);
     }
+
+    while(bundle->readLink != NULL) {
+        LogRecordChunk* chunk = bundle->readLink->data;
+        if(chunk->readOffset < chunk->used) {
+            return (LogRecord*)(chunk->data + chunk->readOffset);
+        }
+        if(bundle->readLink->next == NULL) {
+            break;
+        }
+        bundle->readLink = bundle->readLink->next;
+    }
+
+    return NULL;
+}
+
+LogRecord* logrecordbundle_popHead(LogRecordBundle* bundle) {
+    LogRecord* record = logrecordbundle_peekHead(bundle);
+    if(record != NULL) {
+        MAGIC_ASSERT(record);
+        LogRecordChunk* chunk = bundle->readLink->data;
+        chunk->readOffset += record->length;
+        bundle->numRecords--;
+    }
+    return record;
 }
 
 gint logrecord_compare(const LogRecord* a, const LogRecord* b, gpointer userData) {
@@ -86,53 +446,130 @@ void logrecord_setTime(LogRecord* record, SimulationTime simElapsedNanos) {
     record->simElapsedNanos = simElapsedNanos;
 }
 
-void logrecord_setNames(LogRecord* record, const gchar* threadName, const gchar* hostName) {
+void logrecord_setSource(LogRecord* record, gint threadID, GQuark hostID) {
     MAGIC_ASSERT(record);
+    record->threadID = threadID;
+    record->hostID = hostID;
+}
 
-    /* free the old ones if they exist */
-    if(record->hostName != NULL) {
-        g_free(record->hostName);
-        record->hostName = NULL;
-    }
-    if(record->threadName != NULL) {
-        g_free(record->threadName);
-        record->threadName = NULL;
-    }
+GQuark logrecord_getHostID(LogRecord* record) {
+    MAGIC_ASSERT(record);
+    return record->hostID;
+}
 
-    /* save the new ones */
-    if(hostName != NULL) {
-        record->hostName = g_strdup(hostName);
-    }
-    if(threadName != NULL) {
-        record->threadName = g_strdup(threadName);
+/* appends the literal text between conversions, where %% stands for % */
+static void _logrecord_appendLiteral(GString* buffer, const gchar* text, gsize length) {
+    const gchar* end = text + length;
+    while(text < end) {
+        const gchar* percent = memchr(text, '%', (gsize)(end - text));
+        if(percent == NULL) {
+            g_string_append_len(buffer, text, (gssize)(end - text));
+            break;
+        }
+        g_string_append_len(buffer, text, (gssize)(percent - text) + 1);
+        /* skip the second % of the pair */
+        text = percent + 2;
     }
 }
 
-void logrecord_formatMessageVA(LogRecord* record, const gchar *messageFormat, va_list vargs) {
-    MAGIC_ASSERT(record);
-
-    /* free the old one if it exists */
-    if(record->message != NULL) {
-        g_free(record->message);
-        record->message = NULL;
+static void _logrecord_appendMessage(LogRecord* record, GString* buffer) {
+    if(record->format == NULL) {
+        g_string_append(buffer, "NOMESSAGE");
+        return;
     }
 
-    if(messageFormat != NULL) {
-        record->message = g_strdup_vprintf(messageFormat, vargs);
+    const guchar* args = ((const guchar*)record) + LOGRECORD_ALIGN(sizeof(LogRecord));
+    gchar spec[LOGRECORD_MAX_SPEC];
+
+    gsize specLength = 0;
+    LogRecordArgType type = LRA_UNSUPPORTED;
+    gint precision = -1;
+    const gchar* text = record->format;
+    const gchar* conversion = NULL;
+    while((conversion = _logrecord_nextConversion(text, &specLength, &type, &precision)) != NULL) {
+        _logrecord_appendLiteral(buffer, text, (gsize)(conversion - text));
+        text = conversion + specLength;
+
+        memcpy(spec, conversion, specLength);
+        spec[specLength] = '\0';
+
+        switch(type) {
+            case LRA_INT: case LRA_LONG: case LRA_LONGLONG: {
+                gint64 value;
+                memcpy(&value, args, sizeof(value));
+                args += LOGRECORD_ALIGN(sizeof(value));
+                if(type == LRA_INT) {
+                    g_string_append_printf(buffer, spec, (int)value);
+                } else if(type == LRA_LONG) {
+                    g_string_append_printf(buffer, spec, (long)value);
+                } else {
+                    g_string_append_printf(buffer, spec, (long long)value);
+                }
+                break;
+            }
+            case LRA_INTMAX: {
+                intmax_t value;
+                memcpy(&value, args, sizeof(value));
+                args += LOGRECORD_ALIGN(sizeof(value));
+                g_string_append_printf(buffer, spec, value);
+                break;
+            }
+            case LRA_SIZE: {
+                size_t value;
+                memcpy(&value, args, sizeof(value));
+                args += LOGRECORD_ALIGN(sizeof(value));
+                g_string_append_printf(buffer, spec, value);
+                break;
+            }
+            case LRA_PTRDIFF: {
+                ptrdiff_t value;
+                memcpy(&value, args, sizeof(value));
+                args += LOGRECORD_ALIGN(sizeof(value));
+                g_string_append_printf(buffer, spec, value);
+                break;
+            }
+            case LRA_DOUBLE: {
+                gdouble value;
+                memcpy(&value, args, sizeof(value));
+                args += LOGRECORD_ALIGN(sizeof(value));
+                g_string_append_printf(buffer, spec, value);
+                break;
+            }
+            case LRA_LONGDOUBLE: {
+                long double value;
+                memcpy(&value, args, sizeof(value));
+                args += LOGRECORD_ALIGN(sizeof(value));
+                g_string_append_printf(buffer, spec, value);
+                break;
+            }
+            case LRA_STRING: {
+                guint32 stringLength;
+                memcpy(&stringLength, args, sizeof(guint32));
+                const gchar* value = (stringLength == LOGRECORD_NULL_STRING) ?
+                        NULL : (const gchar*)(args + sizeof(guint32));
+                gsize copyLength = (value != NULL) ? stringLength : 0;
+                args += LOGRECORD_ALIGN(sizeof(guint32) + copyLength + 1);
+                g_string_append_printf(buffer, spec, value);
+                break;
+            }
+            case LRA_POINTER: {
+                gpointer value;
+                memcpy(&value, args, sizeof(value));
+                args += LOGRECORD_ALIGN(sizeof(value));
+                g_string_append_printf(buffer, spec, value);
+                break;
+            }
+            default: {
+                utility_assert(FALSE && "unsupported log format conversion");
+                break;
+            }
+        }
     }
-}
 
-void logrecord_formatMessage(LogRecord* record, const gchar *messageFormat, ...) {
-    MAGIC_ASSERT(record);
-    va_list vargs;
-    va_start(vargs, messageFormat);
-    logrecord_formatMessageVA(record, messageFormat, vargs);
-    va_end(vargs);
+    _logrecord_appendLiteral(buffer, text, strlen(text));
 }
 
-static gchar* _logrecord_getNewSimTimeStr(LogRecord* record) {
-    MAGIC_ASSERT(record);
-
+static void _logrecord_appendSimTime(LogRecord* record, GString* buffer) {
     SimulationTime remainder = record->simElapsedNanos;
 
     SimulationTime hours = remainder / SIMTIME_ONE_HOUR;
@@ -143,13 +580,11 @@ static gchar* _logrecord_getNewSimTimeStr(LogRecord* record) {
     remainder %= SIMTIME_ONE_SECOND;
     SimulationTime nanoseconds = remainder;
 
-    return g_strdup_printf("%02"G_GUINT64_FORMAT":%02"G_GUINT64_FORMAT":%02"G_GUINT64_FORMAT".%09"G_GUINT64_FORMAT,
+    g_string_append_printf(buffer, "%02"G_GUINT64_FORMAT":%02"G_GUINT64_FORMAT":%02"G_GUINT64_FORMAT".%09"G_GUINT64_FORMAT,
             hours, minutes, seconds, nanoseconds);
 }
 
-static gchar* _logrecord_getNewWallTimeStr(LogRecord* record) {
-    MAGIC_ASSERT(record);
-
+static void _logrecord_appendWallTime(LogRecord* record, GString* buffer) {
     guint64 remainder = (guint64)record->wallElapsedSeconds;
     gdouble fraction = record->wallElapsedSeconds - ((gdouble)remainder);
 
@@ -160,34 +595,34 @@ static gchar* _logrecord_getNewWallTimeStr(LogRecord* record) {
     guint64 seconds = remainder;
     guint64 microseconds = (guint64)(fraction * ((gdouble)1000000));
 
-    return g_strdup_printf("%02"G_GUINT64_FORMAT":%02"G_GUINT64_FORMAT":%02"G_GUINT64_FORMAT".%06"G_GUINT64_FORMAT,
+    g_string_append_printf(buffer, "%02"G_GUINT64_FORMAT":%02"G_GUINT64_FORMAT":%02"G_GUINT64_FORMAT".%06"G_GUINT64_FORMAT,
             hours, minutes, seconds, microseconds);
 }
 
-
-gchar* logrecord_toString(LogRecord* record) {
+void logrecord_appendToString(LogRecord* record, const gchar* hostName, GString* buffer) {
     MAGIC_ASSERT(record);
-    utility_assert(record->callInfo);
+    utility_assert(buffer);
+
+    _logrecord_appendWallTime(record, buffer);
+    g_string_append_printf(buffer, " [thread-%i] ", record->threadID);
+    if(record->simElapsedNanos != SIMTIME_INVALID) {
+        _logrecord_appendSimTime(record, buffer);
+    } else {
+        g_string_append(buffer, "n/a");
+    }
 
-    gchar* wallTimeStr = _logrecord_getNewWallTimeStr(record);
-    gchar* simTimeStr = (record->simElapsedNanos != SIMTIME_INVALID) ? _logrecord_getNewSimTimeStr(record) : NULL;
+    const gchar* baseName = NULL;
+    if(record->fileName != NULL) {
+        baseName = strrchr(record->fileName, '/');
+        baseName = (baseName != NULL) ? baseName + 1 : record->fileName;
+    }
 
-    gchar* recordStr = g_strdup_printf("%s [%s] %s [%s] [%s] %s %s\n",
-            (wallTimeStr != NULL) ? wallTimeStr : "n/a",
-            (record->threadName != NULL) ? record->threadName : "thread-0",
-            (simTimeStr != NULL) ? simTimeStr : "n/a",
+    g_string_append_printf(buffer, " [%s] [%s] [%s:%i] [%s] ",
             loglevel_toStr(record->level),
-            (record->hostName != NULL) ? record->hostName : "n/a",
-            record->callInfo,
-            (record->message != NULL) ? record->message : "NOMESSAGE");
-
-
-    if(wallTimeStr != NULL) {
-        g_free(wallTimeStr);
-    }
-    if(simTimeStr != NULL) {
-        g_free(simTimeStr);
-    }
+            (hostName != NULL) ? hostName : "n/a",
+            (baseName != NULL) ? baseName : "n/a", record->lineNumber,
+            (record->functionName != NULL) ? record->functionName : "n/a");
 
-    return recordStr;
+    _logrecord_appendMessage(record, buffer);
+    g_string_append_c(buffer, '\n');
 }
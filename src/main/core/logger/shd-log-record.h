@@ -7,18 +7,23 @@
 #define SHD_LOG_RECORD_H_
 
 typedef struct _LogRecord LogRecord;
+typedef struct _LogRecordBundle LogRecordBundle;
 
-LogRecord* logrecord_new(LogLevel level, gdouble timespan, const gchar* fileName, const gchar* functionName, const gint lineNumber);
+LogRecordBundle* logrecordbundle_new();
+void logrecordbundle_free(LogRecordBundle* bundle);
 
-void logrecord_ref(LogRecord* record);
-void logrecord_unref(LogRecord* record);
+gboolean logrecordbundle_isEmpty(LogRecordBundle* bundle);
+LogRecord* logrecordbundle_append(LogRecordBundle* bundle, LogLevel level, gdouble timespan,
+        const gchar* fileName, const gchar* functionName, const gint lineNumber,
+        const gchar* format, va_list vargs);
+LogRecord* logrecordbundle_peekHead(LogRecordBundle* bundle);
+LogRecord* logrecordbundle_popHead(LogRecordBundle* bundle);
 
 gint logrecord_compare(const LogRecord* a, const LogRecord* b, gpointer userData);
 void logrecord_setTime(LogRecord* record, SimulationTime simElapsedNanos);
-void logrecord_setNames(LogRecord* record, const gchar* threadName, const gchar* hostName);
-void logrecord_formatMessageVA(LogRecord* record, const gchar *messageFormat, va_list vargs);
-void logrecord_formatMessage(LogRecord* record, const gchar *messageFormat, ...);
+void logrecord_setSource(LogRecord* record, gint threadID, GQuark hostID);
+GQuark logrecord_getHostID(LogRecord* record);
 
-gchar* logrecord_toString(LogRecord* record);
+void logrecord_appendToString(LogRecord* record, const gchar* hostName, GString* buffer);
 
 #endif /* SHD_LOG_RECORD_H_ */
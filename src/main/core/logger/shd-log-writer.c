@@ -0,0 +1,255 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#include <stdio.h>
+#include "shadow.h"
+
+#if defined(SHADOW_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(SHADOW_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+/* the log writer takes the formatted output of the logger helper and writes
+ * it to stdout, optionally through a streaming compressor so that large runs
+ * do not need a separate compression pass over the log file. */
+
+struct _LogWriter {
+    LogCompression compression;
+    LogFlushPolicy policy;
+    gsize blockSize;
+
+    /* compressed bytes wait here until they are written out */
+    guchar* outBuffer;
+
+#if defined(SHADOW_HAVE_ZLIB)
+    z_stream zstream;
+#endif
+#if defined(SHADOW_HAVE_ZSTD)
+    ZSTD_CCtx* zstdContext;
+#endif
+
+    /* set if the compressor failed and we stopped writing */
+    gboolean isBroken;
+    MAGIC_DECLARE;
+};
+
+LogCompression logcompression_fromStr(const gchar* compressionStr) {
+    if(compressionStr == NULL) {
+        return LOG_COMPRESSION_NONE;
+    } else if(!g_ascii_strcasecmp(compressionStr, "zlib") || !g_ascii_strcasecmp(compressionStr, "gzip")) {
+        return LOG_COMPRESSION_ZLIB;
+    } else if(!g_ascii_strcasecmp(compressionStr, "zstd")) {
+        return LOG_COMPRESSION_ZSTD;
+    } else {
+        return LOG_COMPRESSION_NONE;
+    }
+}
+
+gboolean logcompression_isAvailable(LogCompression compression) {
+    switch(compression) {
+        case LOG_COMPRESSION_NONE:
+            return TRUE;
+#if defined(SHADOW_HAVE_ZLIB)
+        case LOG_COMPRESSION_ZLIB:
+            return TRUE;
+#endif
+#if defined(SHADOW_HAVE_ZSTD)
+        case LOG_COMPRESSION_ZSTD:
+            return TRUE;
+#endif
+        default:
+            return FALSE;
+    }
+}
+
+static void _logwriter_writeOut(LogWriter* writer, gsize length) {
+    if(length > 0 && fwrite(writer->outBuffer, 1, length, stdout) != length) {
+        g_printerr("** log writer failed to write %"G_GSIZE_FORMAT" compressed bytes\n", length);
+    }
+}
+
+#if defined(SHADOW_HAVE_ZLIB)
+static void _logwriter_compressZlib(LogWriter* writer, const gchar* data, gsize length, gint flush) {
+    writer->zstream.next_in = (Bytef*)data;
+    writer->zstream.avail_in = (uInt)length;
+
+    gint result = Z_OK;
+    do {
+        writer->zstream.next_out = writer->outBuffer;
+        writer->zstream.avail_out = (uInt)writer->blockSize;
+        result = deflate(&(writer->zstream), flush);
+        if(result == Z_STREAM_ERROR) {
+            g_printerr("** zlib log compression failed, further log output is lost\n");
+            writer->isBroken = TRUE;
+            return;
+        }
+        _logwriter_writeOut(writer, writer->blockSize - writer->zstream.avail_out);
+    } while(writer->zstream.avail_out == 0 || (flush == Z_FINISH && result != Z_STREAM_END));
+}
+#endif
+
+#if defined(SHADOW_HAVE_ZSTD)
+static void _logwriter_compressZstd(LogWriter* writer, const gchar* data, gsize length, ZSTD_EndDirective mode) {
+    ZSTD_inBuffer input = {data, length, 0};
+
+    gsize remaining = 0;
+    do {
+        ZSTD_outBuffer output = {writer->outBuffer, writer->blockSize, 0};
+        remaining = ZSTD_compressStream2(writer->zstdContext, &output, &input, mode);
+        if(ZSTD_isError(remaining)) {
+            g_printerr("** zstd log compression failed (%s), further log output is lost\n",
+                    ZSTD_getErrorName(remaining));
+            writer->isBroken = TRUE;
+            return;
+        }
+        _logwriter_writeOut(writer, output.pos);
+    } while((mode == ZSTD_e_continue) ? (input.pos < input.size) : (remaining > 0));
+}
+#endif
+
+LogWriter* logwriter_new(LogCompression compression, gint level, gsize blockSize, LogFlushPolicy policy) {
+    if(!logcompression_isAvailable(compression)) {
+        return NULL;
+    }
+
+    LogWriter* writer = g_new0(LogWriter, 1);
+    MAGIC_INIT(writer);
+
+    writer->compression = compression;
+    writer->policy = policy;
+    writer->blockSize = (blockSize > 0) ? blockSize : CONFIG_LOG_COMPRESSION_BLOCK_SIZE;
+
+    if(compression == LOG_COMPRESSION_NONE) {
+        return writer;
+    }
+
+    writer->outBuffer = g_malloc(writer->blockSize);
+    gboolean success = FALSE;
+
+#if defined(SHADOW_HAVE_ZLIB)
+    if(compression == LOG_COMPRESSION_ZLIB) {
+        /* window bits above 15 select the gzip container */
+        gint result = deflateInit2(&(writer->zstream), (level > 0) ? MIN(level, 9) : Z_DEFAULT_COMPRESSION,
+                Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+        success = (result == Z_OK) ? TRUE : FALSE;
+    }
+#endif
+#if defined(SHADOW_HAVE_ZSTD)
+    if(compression == LOG_COMPRESSION_ZSTD) {
+        writer->zstdContext = ZSTD_createCCtx();
+        if(writer->zstdContext != NULL) {
+            gsize result = ZSTD_CCtx_setParameter(writer->zstdContext, ZSTD_c_compressionLevel,
+                    (level > 0) ? level : ZSTD_CLEVEL_DEFAULT);
+            success = ZSTD_isError(result) ? FALSE : TRUE;
+        }
+    }
+#endif
+
+    if(!success) {
+        /* the stream was not set up, so only free what we allocated here */
+#if defined(SHADOW_HAVE_ZSTD)
+        if(writer->zstdContext != NULL) {
+            ZSTD_freeCCtx(writer->zstdContext);
+        }
+#endif
+        g_free(writer->outBuffer);
+        MAGIC_CLEAR(writer);
+        g_free(writer);
+        return NULL;
+    }
+
+    return writer;
+}
+
+void logwriter_free(LogWriter* writer) {
+    MAGIC_ASSERT(writer);
+
+    /* finish the stream so the trailer makes the output a valid file */
+#if defined(SHADOW_HAVE_ZLIB)
+    if(writer->compression == LOG_COMPRESSION_ZLIB) {
+        if(!writer->isBroken) {
+            _logwriter_compressZlib(writer, NULL, 0, Z_FINISH);
+        }
+        deflateEnd(&(writer->zstream));
+    }
+#endif
+#if defined(SHADOW_HAVE_ZSTD)
+    if(writer->compression == LOG_COMPRESSION_ZSTD) {
+        if(!writer->isBroken) {
+            _logwriter_compressZstd(writer, NULL, 0, ZSTD_e_end);
+        }
+        ZSTD_freeCCtx(writer->zstdContext);
+    }
+#endif
+
+    if(writer->compression != LOG_COMPRESSION_NONE) {
+        fflush(stdout);
+    }
+
+    if(writer->outBuffer != NULL) {
+        g_free(writer->outBuffer);
+    }
+
+    MAGIC_CLEAR(writer);
+    g_free(writer);
+}
+
+gsize logwriter_getBlockSize(LogWriter* writer) {
+    MAGIC_ASSERT(writer);
+    return writer->blockSize;
+}
+
+void logwriter_write(LogWriter* writer, const gchar* data, gsize length) {
+    MAGIC_ASSERT(writer);
+
+    if(length == 0 || writer->isBroken) {
+        return;
+    }
+
+    switch(writer->compression) {
+#if defined(SHADOW_HAVE_ZLIB)
+        case LOG_COMPRESSION_ZLIB: {
+            _logwriter_compressZlib(writer, data, length, Z_NO_FLUSH);
+            break;
+        }
+#endif
+#if defined(SHADOW_HAVE_ZSTD)
+        case LOG_COMPRESSION_ZSTD: {
+            _logwriter_compressZstd(writer, data, length, ZSTD_e_continue);
+            break;
+        }
+#endif
+        default: {
+            g_print("%.*s", (gint)length, data);
+            break;
+        }
+    }
+}
+
+void logwriter_sync(LogWriter* writer) {
+    MAGIC_ASSERT(writer);
+
+    if(writer->compression == LOG_COMPRESSION_NONE || writer->policy != LOG_FLUSH_SYNC ||
+            writer->isBroken) {
+        return;
+    }
+
+    /* push out everything the compressor holds so far, so that what is on
+     * disk decompresses up to the last complete record */
+#if defined(SHADOW_HAVE_ZLIB)
+    if(writer->compression == LOG_COMPRESSION_ZLIB) {
+        _logwriter_compressZlib(writer, NULL, 0, Z_SYNC_FLUSH);
+    }
+#endif
+#if defined(SHADOW_HAVE_ZSTD)
+    if(writer->compression == LOG_COMPRESSION_ZSTD) {
+        _logwriter_compressZstd(writer, NULL, 0, ZSTD_e_flush);
+    }
+#endif
+
+    fflush(stdout);
+}
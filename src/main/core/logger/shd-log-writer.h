@@ -0,0 +1,36 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#ifndef SHD_LOG_WRITER_H_
+#define SHD_LOG_WRITER_H_
+
+typedef enum _LogCompression LogCompression;
+enum _LogCompression {
+    LOG_COMPRESSION_NONE, LOG_COMPRESSION_ZLIB, LOG_COMPRESSION_ZSTD,
+};
+
+typedef enum _LogFlushPolicy LogFlushPolicy;
+enum _LogFlushPolicy {
+    /* the stream is flushed every time the logger syncs to disk */
+    LOG_FLUSH_SYNC,
+    /* compressed output is only written once the compressor fills a block */
+    LOG_FLUSH_BLOCK,
+};
+
+typedef struct _LogWriter LogWriter;
+
+/* returns NULL if the compression type was not available at build time or
+ * failed to initialize */
+LogWriter* logwriter_new(LogCompression compression, gint level, gsize blockSize, LogFlushPolicy policy);
+void logwriter_free(LogWriter* writer);
+
+gsize logwriter_getBlockSize(LogWriter* writer);
+void logwriter_write(LogWriter* writer, const gchar* data, gsize length);
+void logwriter_sync(LogWriter* writer);
+
+LogCompression logcompression_fromStr(const gchar* compressionStr);
+gboolean logcompression_isAvailable(LogCompression compression);
+
+#endif /* SHD_LOG_WRITER_H_ */
@@ -40,31 +40,153 @@ void loggerhelpercommand_unref(LoggerHelperCommand* command) {
     }
 }
 
-static void _loggerhelper_sort(GAsyncQueue* incomingRecords, PriorityQueue* sortedRecords) {
-    if(incomingRecords == NULL || sortedRecords == NULL) {
+/* each worker thread sends its bundles over its own mailbox, and records
+ * within them are already in order. the helper keeps one source per worker
+ * and merges them with a small tournament tree instead of sorting. */
+typedef struct _LoggerHelperSource LoggerHelperSource;
+struct _LoggerHelperSource {
+    GAsyncQueue* incomingRecords;
+    /* bundles received but not yet written, oldest first */
+    GQueue* pendingBundles;
+    /* the next record of this source to write, or NULL */
+    LogRecord* head;
+};
+
+static LoggerHelperSource* _loggerhelpersource_new(GAsyncQueue* incomingRecords) {
+    LoggerHelperSource* source = g_new0(LoggerHelperSource, 1);
+    source->incomingRecords = incomingRecords;
+    source->pendingBundles = g_queue_new();
+    return source;
+}
+
+static void _loggerhelpersource_free(LoggerHelperSource* source) {
+    g_queue_free_full(source->pendingBundles, (GDestroyNotify)logrecordbundle_free);
+    g_async_queue_unref(source->incomingRecords);
+    g_free(source);
+}
+
+/* finds the next record, freeing bundles that have been written entirely */
+static void _loggerhelpersource_updateHead(LoggerHelperSource* source) {
+    source->head = NULL;
+    LogRecordBundle* bundle = NULL;
+    while((bundle = g_queue_peek_head(source->pendingBundles)) != NULL) {
+        source->head = logrecordbundle_peekHead(bundle);
+        if(source->head != NULL) {
+            break;
+        }
+        logrecordbundle_free(g_queue_pop_head(source->pendingBundles));
+    }
+}
+
+static void _loggerhelpersource_collect(LoggerHelperSource* source) {
+    LogRecordBundle* bundle = NULL;
+    while((bundle = g_async_queue_try_pop(source->incomingRecords)) != NULL) {
+        g_queue_push_tail(source->pendingBundles, bundle);
+    }
+    _loggerhelpersource_updateHead(source);
+}
+
+static void _loggerhelpersource_advance(LoggerHelperSource* source) {
+    logrecordbundle_popHead(g_queue_peek_head(source->pendingBundles));
+    _loggerhelpersource_updateHead(source);
+}
+
+/* returns the index of the source whose head comes first, preferring a on ties
+ * so records with equal times keep the order of registration */
+static gint _loggerhelper_playMatch(LoggerHelperSource** sources, gint a, gint b) {
+    if(a < 0) {
+        return b;
+    } else if(b < 0) {
+        return a;
+    }
+    return (logrecord_compare(sources[a]->head, sources[b]->head, NULL) <= 0) ? a : b;
+}
+
+static void _loggerhelper_writeRecords(GQueue* sourceQueue, GHashTable* hostIDToNameMap,
+        GMutex* hostNamesLock, GString* outputBuffer, LogWriter* writer) {
+    guint numSources = g_queue_get_length(sourceQueue);
+    if(numSources == 0) {
         return;
     }
 
-    GQueue* records = NULL;
-    while((records = g_async_queue_try_pop(incomingRecords)) != NULL) {
-        while(!g_queue_is_empty(records)) {
-            LogRecord* record = g_queue_pop_head(records);
-            if(record != NULL) {
-                priorityqueue_push(sortedRecords, record);
-            }
+    LoggerHelperSource** sources = g_new0(LoggerHelperSource*, numSources);
+    guint i = 0;
+    for(GList* item = g_queue_peek_head_link(sourceQueue); item != NULL; item = item->next) {
+        sources[i] = item->data;
+        _loggerhelpersource_collect(sources[i]);
+        i++;
+    }
+
+    /* the tree is stored as an implicit binary heap: leaves live at
+     * [numLeaves, 2*numLeaves), the overall winner at index 1, and
+     * exhausted sources are marked with -1 */
+    guint numLeaves = 1;
+    while(numLeaves < numSources) {
+        numLeaves <<= 1;
+    }
+    gint* tree = g_new(gint, 2 * numLeaves);
+    for(i = 0; i < numLeaves; i++) {
+        tree[numLeaves + i] = (i < numSources && sources[i]->head != NULL) ? (gint)i : -1;
+    }
+    for(i = numLeaves - 1; i >= 1; i--) {
+        tree[i] = _loggerhelper_playMatch(sources, tree[2 * i], tree[2 * i + 1]);
+    }
+
+    /* formatted records are handed to the writer in blocks of about this size */
+    gsize blockSize = logwriter_getBlockSize(writer);
+
+    g_mutex_lock(hostNamesLock);
+
+    gint winner = -1;
+    while((winner = tree[1]) >= 0) {
+        LoggerHelperSource* source = sources[winner];
+
+        LogRecord* record = source->head;
+        GQuark hostID = logrecord_getHostID(record);
+        const gchar* hostName = hostID ? g_hash_table_lookup(hostIDToNameMap, GUINT_TO_POINTER(hostID)) : NULL;
+
+        logrecord_appendToString(record, hostName, outputBuffer);
+
+        if(outputBuffer->len >= blockSize) {
+            logwriter_write(writer, outputBuffer->str, outputBuffer->len);
+            g_string_truncate(outputBuffer, 0);
+        }
+
+        /* the record was written, so its bundle may now be freed */
+        _loggerhelpersource_advance(source);
+
+        /* replay the matches on the path from the winner's leaf to the root */
+        guint node = numLeaves + (guint)winner;
+        tree[node] = (source->head != NULL) ? winner : -1;
+        for(node >>= 1; node >= 1; node >>= 1) {
+            tree[node] = _loggerhelper_playMatch(sources, tree[2 * node], tree[2 * node + 1]);
         }
-        g_queue_free(records);
     }
+
+    g_mutex_unlock(hostNamesLock);
+
+    if(outputBuffer->len > 0) {
+        logwriter_write(writer, outputBuffer->str, outputBuffer->len);
+        g_string_truncate(outputBuffer, 0);
+    }
+
+    g_free(tree);
+    g_free(sources);
 }
 
 gpointer loggerhelper_runHelperThread(LoggerHelperRunData* data) {
     GAsyncQueue* commands = data->commands;
     CountDownLatch* notifyDoneRunning = data->notifyDoneRunning;
+    GHashTable* hostIDToNameMap = data->hostIDToNameMap;
+    GMutex* hostNamesLock = data->hostNamesLock;
     g_free(data);
     data = NULL;
 
-    GQueue* queues = g_queue_new();
-    PriorityQueue* sortedRecords = priorityqueue_new((GCompareDataFunc)logrecord_compare, NULL, NULL);
+    GQueue* sources = g_queue_new();
+    GString* outputBuffer = g_string_new(NULL);
+
+    /* plain output until the logger configures something else */
+    LogWriter* writer = logwriter_new(LOG_COMPRESSION_NONE, 0, 0, LOG_FLUSH_SYNC);
 
     LoggerHelperCommand* command = NULL;
     gboolean stop = FALSE;
@@ -74,21 +196,20 @@ gpointer loggerhelper_runHelperThread(LoggerHelperRunData* data) {
         switch(command->type) {
             case LHC_REGISTER: {
                 GAsyncQueue* incomingRecords = command->argument;
-                g_queue_push_tail(queues, incomingRecords);
+                g_queue_push_tail(sources, _loggerhelpersource_new(incomingRecords));
+                break;
+            }
+
+            case LHC_CONFIGURE: {
+                LogWriter* newWriter = command->argument;
+                logwriter_free(writer);
+                writer = newWriter;
                 break;
             }
 
             case LHC_FLUSH: {
-                g_queue_foreach(queues, (GFunc)_loggerhelper_sort, sortedRecords);
-                while(!priorityqueue_isEmpty(sortedRecords)) {
-                    LogRecord* record = priorityqueue_pop(sortedRecords);
-                    gchar* logRecordStr = logrecord_toString(record);
-                    utility_assert(logRecordStr);
-                    g_print("%s", logRecordStr);
-                    g_free(logRecordStr);
-                    logrecord_unref(record);
-                }
-                utility_assert(priorityqueue_isEmpty(sortedRecords));
+                _loggerhelper_writeRecords(sources, hostIDToNameMap, hostNamesLock, outputBuffer, writer);
+                logwriter_sync(writer);
                 break;
             }
 
@@ -104,11 +225,10 @@ gpointer loggerhelper_runHelperThread(LoggerHelperRunData* data) {
         loggerhelpercommand_unref(command);
     }
 
-    while(!g_queue_is_empty(queues)) {
-        g_async_queue_unref(g_queue_pop_head(queues));
-    }
-    g_queue_free(queues);
-    priorityqueue_free(sortedRecords);
+    g_queue_free_full(sources, (GDestroyNotify)_loggerhelpersource_free);
+    g_string_free(outputBuffer, TRUE);
+    /* this finishes the compressed stream, if any */
+    logwriter_free(writer);
 
     countdownlatch_countDown(notifyDoneRunning);
     return NULL;
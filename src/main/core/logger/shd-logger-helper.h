@@ -10,7 +10,7 @@
 
 typedef enum _LoggerHelperCommmandType LoggerHelperCommmandType;
 enum _LoggerHelperCommmandType {
-    LHC_STOP, LHC_REGISTER, LHC_FLUSH,
+    LHC_STOP, LHC_REGISTER, LHC_FLUSH, LHC_CONFIGURE,
 };
 
 typedef struct _LoggerHelperCommand LoggerHelperCommand;
@@ -23,6 +23,9 @@ typedef struct _LoggerHelperRunData LoggerHelperRunData;
 struct _LoggerHelperRunData {
     GAsyncQueue* commands;
     CountDownLatch* notifyDoneRunning;
+    /* owned by the logger, which outlives the helper */
+    GHashTable* hostIDToNameMap;
+    GMutex* hostNamesLock;
 };
 
 gpointer loggerhelper_runHelperThread(LoggerHelperRunData* data);
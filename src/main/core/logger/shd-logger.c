@@ -15,7 +15,10 @@ struct _LoggerThreadData {
     gdouble loggerRunOffset;
 
     /* local temporary store for this threads log records */
-    GQueue* localRecordBundle;
+    LogRecordBundle* localRecordBundle;
+
+    /* hosts whose names this thread already made known to the logger */
+    GHashTable* knownHosts;
 
     /* remote queue over which to send helper thread messages */
     GAsyncQueue* remoteLogHelperMailbox;
@@ -33,6 +36,9 @@ struct _Logger {
     gboolean shouldBuffer;
     gdouble lastTimespan;
 
+    /* if set, stdout carries a compressed stream that nobody else may write into */
+    gboolean isCompressingOutput;
+
     /* helper to sort messages and handle file i/o */
     pthread_t helper;
     GAsyncQueue* helperCommands;
@@ -41,6 +47,10 @@ struct _Logger {
     /* store map of other threads that will call logging functions to thread-specific data */
     GHashTable* threadToDataMap;
 
+    /* records only carry the host id, the helper looks up the names here */
+    GHashTable* hostIDToNameMap;
+    GMutex hostNamesLock;
+
     /* for memory management */
     gint referenceCount;
     MAGIC_DECLARE;
@@ -55,7 +65,8 @@ static LoggerThreadData* _loggerthreaddata_new(GTimer* loggerTimer) {
     threadData->runTimer = g_timer_new();
     threadData->loggerRunOffset = g_timer_elapsed(loggerTimer, NULL);
 
-    threadData->localRecordBundle = g_queue_new();
+    threadData->localRecordBundle = logrecordbundle_new();
+    threadData->knownHosts = g_hash_table_new(g_direct_hash, g_direct_equal);
     threadData->remoteLogHelperMailbox = g_async_queue_new();
 
     return threadData;
@@ -64,12 +75,9 @@ static LoggerThreadData* _loggerthreaddata_new(GTimer* loggerTimer) {
 static void _loggerthreaddata_free(LoggerThreadData* threadData) {
     MAGIC_ASSERT(threadData);
 
-    /* free any remaining log records and the record queue */
-    LogRecord* record = NULL;
-    while((record = g_queue_pop_head(threadData->localRecordBundle)) != NULL) {
-        logrecord_unref(record);
-    }
-    g_queue_free(threadData->localRecordBundle);
+    /* free any remaining log records */
+    logrecordbundle_free(threadData->localRecordBundle);
+    g_hash_table_destroy(threadData->knownHosts);
     g_async_queue_unref(threadData->remoteLogHelperMailbox);
 
     g_timer_destroy(threadData->runTimer);
@@ -124,6 +132,28 @@ void logger_setEnableBuffering(Logger* logger, gboolean enabled) {
     logger->shouldBuffer = enabled;
 }
 
+gboolean logger_setOutputCompression(Logger* logger, LogCompression compression, gint level,
+        gsize blockSize, LogFlushPolicy policy) {
+    MAGIC_ASSERT(logger);
+
+    LogWriter* writer = logwriter_new(compression, level, blockSize, policy);
+    if(!writer) {
+        return FALSE;
+    }
+
+    /* commands are handled in order, so everything flushed after this
+     * goes through the new writer. the helper now owns it. */
+    LoggerHelperCommand* command = loggerhelpercommand_new(LHC_CONFIGURE, writer);
+    g_async_queue_push(logger->helperCommands, command);
+    logger->isCompressingOutput = (compression != LOG_COMPRESSION_NONE) ? TRUE : FALSE;
+    return TRUE;
+}
+
+gboolean logger_isCompressingOutput(Logger* logger) {
+    MAGIC_ASSERT(logger);
+    return logger->isCompressingOutput;
+}
+
 static void _logger_sendRegisterCommandToHelper(Logger* logger, LoggerThreadData* threadData) {
     LoggerHelperCommand* command = loggerhelpercommand_new(LHC_REGISTER, threadData->remoteLogHelperMailbox);
     g_async_queue_ref(threadData->remoteLogHelperMailbox);
@@ -152,6 +182,31 @@ static void _logger_stopHelper(Logger* logger) {
     countdownlatch_await(logger->helperLatch);
 }
 
+static void _logger_registerHostName(Logger* logger, LoggerThreadData* threadData, Host* host) {
+    MAGIC_ASSERT(logger);
+    MAGIC_ASSERT(threadData);
+
+    GQuark hostID = host_getID(host);
+    if(g_hash_table_contains(threadData->knownHosts, GUINT_TO_POINTER(hostID))) {
+        return;
+    }
+
+    /* until the host has an address we log it as n/a and try again next time */
+    Address* hostAddress = host_getDefaultAddress(host);
+    if(!hostAddress) {
+        return;
+    }
+
+    g_mutex_lock(&(logger->hostNamesLock));
+    if(!g_hash_table_contains(logger->hostIDToNameMap, GUINT_TO_POINTER(hostID))) {
+        gchar* hostName = g_strdup_printf("%s~%s", host_getName(host), address_toHostIPString(hostAddress));
+        g_hash_table_replace(logger->hostIDToNameMap, GUINT_TO_POINTER(hostID), hostName);
+    }
+    g_mutex_unlock(&(logger->hostNamesLock));
+
+    g_hash_table_add(threadData->knownHosts, GUINT_TO_POINTER(hostID));
+}
+
 void logger_logVA(Logger* logger, LogLevel level, const gchar* fileName, const gchar* functionName,
         const gint lineNumber, const gchar *format, va_list vargs) {
     if(!logger) {
@@ -170,35 +225,24 @@ void logger_logVA(Logger* logger, LogLevel level, const gchar* fileName, const g
 
     gdouble timespan = g_timer_elapsed(threadData->runTimer, NULL);
 
-    LogRecord* record = logrecord_new(level, timespan, fileName, functionName, lineNumber);
-    logrecord_formatMessageVA(record, format, vargs);
+    /* the message is formatted later by the helper, we only copy the arguments */
+    LogRecord* record = logrecordbundle_append(threadData->localRecordBundle, level, timespan,
+            fileName, functionName, lineNumber, format, vargs);
 
     if(worker_isAlive()) {
         /* time info */
         logrecord_setTime(record, worker_getCurrentTime());
 
-        /* name info for the host */
-        GString* hostNameBuffer = g_string_new("n/a");
+        /* source info, the helper resolves host ids to names */
+        GQuark hostID = 0;
         Host* activeHost = worker_getActiveHost();
         if(activeHost) {
-            Address* hostAddress = host_getDefaultAddress(activeHost);
-            if(hostAddress) {
-                g_string_printf(hostNameBuffer, "%s~%s", host_getName(activeHost), address_toHostIPString(hostAddress));
-            }
+            hostID = host_getID(activeHost);
+            _logger_registerHostName(logger, threadData, activeHost);
         }
-
-        /* name info for the thread */
-        GString* threadNameBuffer = g_string_new(NULL);
-        g_string_printf(threadNameBuffer, "thread-%i", worker_getThreadID());
-
-        /* set and cleanup */
-        logrecord_setNames(record, threadNameBuffer->str, hostNameBuffer->str);
-        g_string_free(threadNameBuffer, TRUE);
-        g_string_free(hostNameBuffer, TRUE);
+        logrecord_setSource(record, worker_getThreadID(), hostID);
     }
 
-    g_queue_push_tail(threadData->localRecordBundle, record);
-
     if(level == LOGLEVEL_ERROR || !logger->shouldBuffer || (timespan - logger->lastTimespan) >= 5) {
         /* make sure we have logged everything */
         logger_flushRecords(logger, pthread_self());
@@ -245,9 +289,9 @@ void logger_flushRecords(Logger* logger, pthread_t callerThread) {
     LoggerThreadData* threadData = g_hash_table_lookup(logger->threadToDataMap, GUINT_TO_POINTER(callerThread));
     MAGIC_ASSERT(threadData);
     /* send log messages from this thread to the helper */
-    if(!g_queue_is_empty(threadData->localRecordBundle)) {
+    if(!logrecordbundle_isEmpty(threadData->localRecordBundle)) {
         g_async_queue_push(threadData->remoteLogHelperMailbox, threadData->localRecordBundle);
-        threadData->localRecordBundle = g_queue_new();
+        threadData->localRecordBundle = logrecordbundle_new();
     }
 }
 
@@ -327,6 +371,8 @@ Logger* logger_new(LogLevel filterLevel) {
     logger->shouldBuffer = TRUE;
     logger->referenceCount = 1;
     logger->threadToDataMap = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)_loggerthreaddata_free);
+    logger->hostIDToNameMap = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+    g_mutex_init(&(logger->hostNamesLock));
 
     logger->helperCommands = g_async_queue_new();
     logger->helperLatch = countdownlatch_new(1);
@@ -335,6 +381,8 @@ Logger* logger_new(LogLevel filterLevel) {
     LoggerHelperRunData* runArgs = g_new0(LoggerHelperRunData, 1);
     runArgs->commands = logger->helperCommands;
     runArgs->notifyDoneRunning = logger->helperLatch;
+    runArgs->hostIDToNameMap = logger->hostIDToNameMap;
+    runArgs->hostNamesLock = &(logger->hostNamesLock);
 
     /* the thread will consume the reference to the runArgs struct, and will free it */
     gint returnVal = pthread_create(&(logger->helper), NULL, (void*(*)(void*))loggerhelper_runHelperThread, runArgs);
@@ -371,6 +419,8 @@ static void _logger_free(Logger* logger) {
     countdownlatch_free(logger->helperLatch);
 
     g_hash_table_destroy(logger->threadToDataMap);
+    g_hash_table_destroy(logger->hostIDToNameMap);
+    g_mutex_clear(&(logger->hostNamesLock));
     g_timer_destroy(logger->runTimer);
 
     MAGIC_CLEAR(logger);
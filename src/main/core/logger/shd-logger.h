@@ -36,6 +36,9 @@ void logger_setFilterLevel(Logger* logger, LogLevel level);
 gboolean logger_shouldFilter(Logger* logger, LogLevel level);
 
 void logger_setEnableBuffering(Logger* logger, gboolean enabled);
+gboolean logger_setOutputCompression(Logger* logger, LogCompression compression, gint level,
+        gsize blockSize, LogFlushPolicy policy);
+gboolean logger_isCompressingOutput(Logger* logger);
 
 void logger_logVA(Logger* logger, LogLevel level, const gchar* fileName, const gchar* functionName,
         const gint lineNumber, const gchar *format, va_list vargs);
@@ -31,6 +31,9 @@ struct _HostStealThreadData {
     GTimer* popIdleTime;
     /* which worker thread this is */
     guint tnumber;
+    /* hosts this thread finished and took from other threads this round */
+    guint nHostsProcessedRound;
+    guint nHostsStolenRound;
     GMutex lock;
 };
 
@@ -273,6 +276,9 @@ static Event* _schedulerpolicyhoststeal_popFromThread(SchedulerPolicy* policy, H
         /* if there's no running host, we completed the last assignment and need a new one */
         if(!tdata->runningHost) {
             tdata->runningHost = g_queue_pop_head(assignedHosts);
+            if(assignedHosts != tdata->unprocessedHosts) {
+                tdata->nHostsStolenRound++;
+            }
         }
         Host* host = tdata->runningHost;
         g_rw_lock_reader_lock(&data->lock);
@@ -299,6 +305,7 @@ static Event* _schedulerpolicyhoststeal_popFromThread(SchedulerPolicy* policy, H
             /* no more events on the runningHost, mark it as NULL so we get a new one */
             g_queue_push_tail(tdata->processedHosts, host);
             tdata->runningHost = NULL;
+            tdata->nHostsProcessedRound++;
         }
 
         g_mutex_unlock(&(qdata->lock));
@@ -445,6 +452,29 @@ static SimulationTime _schedulerpolicyhoststeal_getNextTime(SchedulerPolicy* pol
     return searchState.nextEventTime;
 }
 
+static void _schedulerpolicyhoststeal_getRoundStats(SchedulerPolicy* policy,
+        guint* nHostsProcessed, guint* nHostsStolen) {
+    MAGIC_ASSERT(policy);
+    HostStealPolicyData* data = policy->data;
+
+    g_rw_lock_reader_lock(&data->lock);
+    HostStealThreadData* tdata = g_hash_table_lookup(data->threadToThreadDataMap, GUINT_TO_POINTER(pthread_self()));
+    g_rw_lock_reader_unlock(&data->lock);
+
+    if(tdata) {
+        /* other threads only touch these while holding our lock to steal from us */
+        g_mutex_lock(&(tdata->lock));
+        *nHostsProcessed = tdata->nHostsProcessedRound;
+        *nHostsStolen = tdata->nHostsStolenRound;
+        tdata->nHostsProcessedRound = 0;
+        tdata->nHostsStolenRound = 0;
+        g_mutex_unlock(&(tdata->lock));
+    } else {
+        *nHostsProcessed = 0;
+        *nHostsStolen = 0;
+    }
+}
+
 static void _schedulerpolicyhoststeal_free(SchedulerPolicy* policy) {
     MAGIC_ASSERT(policy);
     HostStealPolicyData* data = policy->data;
@@ -474,6 +504,7 @@ SchedulerPolicy* schedulerpolicyhoststeal_new() {
     policy->push = _schedulerpolicyhoststeal_push;
     policy->pop = _schedulerpolicyhoststeal_pop;
     policy->getNextTime = _schedulerpolicyhoststeal_getNextTime;
+    policy->getRoundStats = _schedulerpolicyhoststeal_getRoundStats;
     policy->free = _schedulerpolicyhoststeal_free;
 
     policy->type = SP_PARALLEL_HOST_STEAL;
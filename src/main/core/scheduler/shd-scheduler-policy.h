@@ -32,6 +32,7 @@ typedef GQueue* (*SchedulerPolicyGetHostsFunc)(SchedulerPolicy*);
 typedef void (*SchedulerPolicyPushFunc)(SchedulerPolicy*, Event*, Host*, Host*, SimulationTime);
 typedef Event* (*SchedulerPolicyPopFunc)(SchedulerPolicy*, SimulationTime);
 typedef SimulationTime (*SchedulerPolicyGetNextTimeFunc)(SchedulerPolicy*);
+typedef void (*SchedulerPolicyGetRoundStatsFunc)(SchedulerPolicy*, guint*, guint*);
 typedef void (*SchedulerPolicyFreeFunc)(SchedulerPolicy*);
 
 struct _SchedulerPolicy {
@@ -43,6 +44,9 @@ struct _SchedulerPolicy {
     SchedulerPolicyPushFunc push;
     SchedulerPolicyPopFunc pop;
     SchedulerPolicyGetNextTimeFunc getNextTime;
+    /* optional, returns and clears the calling thread's count of hosts it
+     * processed and stole this round */
+    SchedulerPolicyGetRoundStatsFunc getRoundStats;
     SchedulerPolicyFreeFunc free;
     MAGIC_DECLARE;
 };
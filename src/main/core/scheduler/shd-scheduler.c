@@ -28,6 +28,23 @@ struct _Scheduler {
     /* holds a timer for each thread to track how long threads wait for execution barrier */
     GHashTable* threadToWaitTimerMap;
 
+    /* optional per-round timeline of every worker, in chrome trace format */
+    struct {
+        FILE* file;
+        GMutex lock;
+        gint64 startMicros;
+        gboolean needsSeparator;
+    } trace;
+
+    /* if set, each worker samples hardware and kernel counters at the round barriers */
+    gboolean collectPerfCounters;
+
+    /* if set, each worker adds up its busy and idle time for the live statistics */
+    gboolean collectLiveStats;
+
+    /* per-thread round state for the round trace, the counters, and the live statistics */
+    GHashTable* threadToRoundMap;
+
     /* the serial/parallel host/thread mapping/scheduling policy */
     SchedulerPolicy* policy;
     SchedulerPolicyType policyType;
@@ -42,6 +59,8 @@ struct _Scheduler {
     gboolean isRunning;
     SimulationTime endTime;
     struct {
+        guint64 number;
+        SimulationTime startTime;
         SimulationTime endTime;
         SimulationTime minNextEventTime;
     } currentRound;
@@ -51,6 +70,40 @@ struct _Scheduler {
     MAGIC_DECLARE;
 };
 
+/* what one worker did during the current round, for the round trace */
+typedef struct _SchedulerThreadRound SchedulerThreadRound;
+struct _SchedulerThreadRound {
+    gint threadID;
+    guint64 number;
+    SimulationTime windowStart;
+    SimulationTime windowEnd;
+    gint64 startMicros;
+    gint64 barrierMicros;
+    guint64 nEvents;
+    guint nHostsProcessed;
+    guint nHostsStolen;
+
+    /* NULL unless counters were requested and could be opened */
+    PerfCounters* counters;
+    /* counted while running events and while waiting at the barriers */
+    PerfCounterValues runValues;
+    PerfCounterValues barrierValues;
+    /* totals since the last heartbeat, protected by the global lock */
+    PerfCounterValues heartbeatValues;
+
+    /* time spent running events and at the barriers over all finished rounds,
+     * protected by the global lock */
+    gint64 totalRunMicros;
+    gint64 totalBarrierMicros;
+};
+
+static void _schedulerthreadround_free(SchedulerThreadRound* round) {
+    if(round->counters) {
+        perfcounters_free(round->counters);
+    }
+    g_free(round);
+}
+
 typedef struct _SchedulerThreadItem SchedulerThreadItem;
 struct _SchedulerThreadItem {
     pthread_t thread;
@@ -115,6 +168,9 @@ Scheduler* scheduler_new(SchedulerPolicyType policyType, guint nWorkers, gpointe
     scheduler->currentRound.minNextEventTime = SIMTIME_MAX;
 
     scheduler->threadToWaitTimerMap = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)g_timer_destroy);
+    scheduler->threadToRoundMap = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+            (GDestroyNotify)_schedulerthreadround_free);
+    g_mutex_init(&(scheduler->trace.lock));
     scheduler->hostIDToHostMap = g_hash_table_new(g_direct_hash, g_direct_equal);
 
     scheduler->random = random_new(schedulerSeed);
@@ -268,6 +324,13 @@ static void _scheduler_free(Scheduler* scheduler) {
         g_hash_table_destroy(scheduler->threadToWaitTimerMap);
     }
 
+    if(scheduler->trace.file) {
+        fprintf(scheduler->trace.file, "\n]\n");
+        fclose(scheduler->trace.file);
+    }
+    g_hash_table_destroy(scheduler->threadToRoundMap);
+    g_mutex_clear(&(scheduler->trace.lock));
+
     guint nWorkers = g_queue_get_length(scheduler->threadItems);
 
     while(!g_queue_is_empty(scheduler->threadItems)) {
@@ -340,6 +403,229 @@ gboolean scheduler_push(Scheduler* scheduler, Event* event, Host* sender, Host*
     return TRUE;
 }
 
+void scheduler_enableRoundTrace(Scheduler* scheduler, const gchar* tracePath) {
+    MAGIC_ASSERT(scheduler);
+
+    /* the workers may already be running awaitStart, but they only look at the trace
+     * after scheduler_start releases them from the start barrier */
+    utility_assert(!scheduler->isRunning);
+
+    if(scheduler->policyType == SP_SERIAL_GLOBAL) {
+        message("the scheduler round trace needs worker threads, not writing '%s'", tracePath);
+        return;
+    }
+
+    FILE* traceFile = fopen(tracePath, "w");
+    if(!traceFile) {
+        warning("unable to open scheduler round trace file '%s': %s", tracePath, g_strerror(errno));
+        return;
+    }
+    fprintf(traceFile, "[\n");
+
+    g_mutex_lock(&(scheduler->globalLock));
+    scheduler->trace.file = traceFile;
+    scheduler->trace.startMicros = g_get_monotonic_time();
+    g_mutex_unlock(&(scheduler->globalLock));
+
+    message("writing scheduler round trace to '%s'", tracePath);
+}
+
+void scheduler_enablePerfCounters(Scheduler* scheduler) {
+    MAGIC_ASSERT(scheduler);
+
+    /* the workers open their own counters once scheduler_start lets them pass the start barrier */
+    utility_assert(!scheduler->isRunning);
+
+    if(scheduler->policyType == SP_SERIAL_GLOBAL) {
+        message("performance counters are sampled at round barriers, which need worker threads");
+        return;
+    }
+
+    g_mutex_lock(&(scheduler->globalLock));
+    scheduler->collectPerfCounters = TRUE;
+    g_mutex_unlock(&(scheduler->globalLock));
+}
+
+static gboolean _scheduler_isTrackingRounds(Scheduler* scheduler) {
+    return (scheduler->trace.file || scheduler->collectPerfCounters || scheduler->collectLiveStats) ? TRUE : FALSE;
+}
+
+static void _scheduler_startThreadRound(Scheduler* scheduler, SchedulerThreadRound* round) {
+    round->number = scheduler->currentRound.number;
+    round->windowStart = scheduler->currentRound.startTime;
+    round->windowEnd = scheduler->currentRound.endTime;
+    round->startMicros = g_get_monotonic_time() - scheduler->trace.startMicros;
+    round->barrierMicros = round->startMicros;
+    round->nEvents = 0;
+}
+
+static void _scheduler_arriveAtBarrier(Scheduler* scheduler, SchedulerThreadRound* round) {
+    if(!round) {
+        return;
+    }
+    if(round->counters) {
+        perfcounters_sample(round->counters, &(round->runValues));
+    }
+    round->barrierMicros = g_get_monotonic_time() - scheduler->trace.startMicros;
+    round->nHostsProcessed = 0;
+    round->nHostsStolen = 0;
+    if(scheduler->policy->getRoundStats) {
+        scheduler->policy->getRoundStats(scheduler->policy, &(round->nHostsProcessed), &(round->nHostsStolen));
+    }
+}
+
+static void _scheduler_appendPerfCounterArgs(GString* buffer, SchedulerThreadRound* round, PerfCounterValues* values) {
+    for(gint i = 0; i < PERF_COUNTER_NUM_TYPES; i++) {
+        if(perfcounters_isAvailable(round->counters, (PerfCounterType)i)) {
+            g_string_append_printf(buffer, ",\"%s\":%"G_GUINT64_FORMAT,
+                    perfcountertype_toStr((PerfCounterType)i), values->values[i]);
+        }
+    }
+}
+
+/* writes the span the worker was running events and the span it spent
+ * waiting at the barriers until the next round started */
+static void _scheduler_traceRound(Scheduler* scheduler, SchedulerThreadRound* round, gint64 nowMicros) {
+    GString* runArgs = g_string_new(NULL);
+    GString* barrierArgs = g_string_new(NULL);
+    if(round->counters) {
+        _scheduler_appendPerfCounterArgs(runArgs, round, &(round->runValues));
+        _scheduler_appendPerfCounterArgs(barrierArgs, round, &(round->barrierValues));
+    }
+
+    g_mutex_lock(&(scheduler->trace.lock));
+
+    fprintf(scheduler->trace.file,
+            "%s{\"name\":\"run\",\"ph\":\"X\",\"pid\":0,\"tid\":%i,"
+            "\"ts\":%"G_GINT64_FORMAT",\"dur\":%"G_GINT64_FORMAT",\"args\":{"
+            "\"round\":%"G_GUINT64_FORMAT",\"window-start-ns\":%"G_GUINT64_FORMAT","
+            "\"window-ns\":%"G_GUINT64_FORMAT",\"events\":%"G_GUINT64_FORMAT","
+            "\"hosts\":%u,\"stolen-hosts\":%u%s}},\n"
+            "{\"name\":\"barrier\",\"ph\":\"X\",\"pid\":0,\"tid\":%i,"
+            "\"ts\":%"G_GINT64_FORMAT",\"dur\":%"G_GINT64_FORMAT",\"args\":{"
+            "\"round\":%"G_GUINT64_FORMAT"%s}}",
+            scheduler->trace.needsSeparator ? ",\n" : "",
+            round->threadID, round->startMicros, round->barrierMicros - round->startMicros,
+            round->number, round->windowStart, round->windowEnd - round->windowStart,
+            round->nEvents, round->nHostsProcessed, round->nHostsStolen, runArgs->str,
+            round->threadID, round->barrierMicros, nowMicros - round->barrierMicros,
+            round->number, barrierArgs->str);
+    scheduler->trace.needsSeparator = TRUE;
+
+    g_mutex_unlock(&(scheduler->trace.lock));
+
+    g_string_free(runArgs, TRUE);
+    g_string_free(barrierArgs, TRUE);
+}
+
+static void _scheduler_finishThreadRound(Scheduler* scheduler, SchedulerThreadRound* round) {
+    gint64 nowMicros = g_get_monotonic_time() - scheduler->trace.startMicros;
+
+    if(round->counters) {
+        perfcounters_sample(round->counters, &(round->barrierValues));
+
+        g_mutex_lock(&(scheduler->globalLock));
+        perfcountervalues_add(&(round->heartbeatValues), &(round->runValues));
+        perfcountervalues_add(&(round->heartbeatValues), &(round->barrierValues));
+        g_mutex_unlock(&(scheduler->globalLock));
+    }
+
+    if(scheduler->collectLiveStats) {
+        g_mutex_lock(&(scheduler->globalLock));
+        round->totalRunMicros += round->barrierMicros - round->startMicros;
+        round->totalBarrierMicros += nowMicros - round->barrierMicros;
+        g_mutex_unlock(&(scheduler->globalLock));
+    }
+
+    if(scheduler->trace.file) {
+        _scheduler_traceRound(scheduler, round, nowMicros);
+    }
+}
+
+static void _scheduler_logThreadPerfCounters(gpointer key, SchedulerThreadRound* round, gpointer userData) {
+    if(!round->counters) {
+        return;
+    }
+
+    GString* buffer = g_string_new(NULL);
+    PerfCounterValues* values = &(round->heartbeatValues);
+    for(gint i = 0; i < PERF_COUNTER_NUM_TYPES; i++) {
+        if(perfcounters_isAvailable(round->counters, (PerfCounterType)i)) {
+            g_string_append_printf(buffer, "%s%s=%"G_GUINT64_FORMAT, buffer->len > 0 ? ", " : "",
+                    perfcountertype_toStr((PerfCounterType)i), values->values[i]);
+        }
+    }
+    if(perfcounters_isAvailable(round->counters, PERF_COUNTER_CYCLES) &&
+            perfcounters_isAvailable(round->counters, PERF_COUNTER_INSTRUCTIONS) &&
+            values->values[PERF_COUNTER_CYCLES] > 0) {
+        g_string_append_printf(buffer, ", ipc=%.3f", ((gdouble)values->values[PERF_COUNTER_INSTRUCTIONS]) /
+                ((gdouble)values->values[PERF_COUNTER_CYCLES]));
+    }
+
+    message("worker %i performance counters since the last heartbeat: %s", round->threadID, buffer->str);
+
+    memset(values, 0, sizeof(PerfCounterValues));
+    g_string_free(buffer, TRUE);
+}
+
+void scheduler_logPerfCounters(Scheduler* scheduler) {
+    MAGIC_ASSERT(scheduler);
+    if(!scheduler->collectPerfCounters) {
+        return;
+    }
+
+    g_mutex_lock(&(scheduler->globalLock));
+    g_hash_table_foreach(scheduler->threadToRoundMap, (GHFunc)_scheduler_logThreadPerfCounters, NULL);
+    g_mutex_unlock(&(scheduler->globalLock));
+}
+
+void scheduler_enableLiveStats(Scheduler* scheduler) {
+    MAGIC_ASSERT(scheduler);
+
+    /* like the counters, the workers set up their round state after the start barrier */
+    utility_assert(!scheduler->isRunning);
+
+    /* with a single serial worker there are no barriers, so it is never idle */
+    if(scheduler->policyType != SP_SERIAL_GLOBAL) {
+        g_mutex_lock(&(scheduler->globalLock));
+        scheduler->collectLiveStats = TRUE;
+        g_mutex_unlock(&(scheduler->globalLock));
+    }
+}
+
+static gint _scheduler_compareThreadRounds(const SchedulerThreadRound* a, const SchedulerThreadRound* b) {
+    return (a->threadID > b->threadID) ? 1 : (a->threadID < b->threadID) ? -1 : 0;
+}
+
+void scheduler_appendLiveStats(Scheduler* scheduler, GString* buffer) {
+    MAGIC_ASSERT(scheduler);
+    utility_assert(buffer);
+
+    g_mutex_lock(&(scheduler->globalLock));
+
+    GList* rounds = NULL;
+    if(scheduler->collectLiveStats) {
+        rounds = g_list_sort(g_hash_table_get_values(scheduler->threadToRoundMap),
+                (GCompareFunc)_scheduler_compareThreadRounds);
+    }
+
+    g_string_append(buffer, "[");
+    for(GList* item = rounds; item != NULL; item = g_list_next(item)) {
+        SchedulerThreadRound* round = item->data;
+        g_string_append_printf(buffer, "%s{\"id\":%i,\"busy-seconds\":%.3f,\"idle-seconds\":%.3f}",
+                (item == rounds) ? "" : ",", round->threadID,
+                ((gdouble)round->totalRunMicros) / G_USEC_PER_SEC,
+                ((gdouble)round->totalBarrierMicros) / G_USEC_PER_SEC);
+    }
+    g_string_append(buffer, "]");
+
+    g_mutex_unlock(&(scheduler->globalLock));
+
+    if(rounds) {
+        g_list_free(rounds);
+    }
+}
+
 Event* scheduler_pop(Scheduler* scheduler) {
     MAGIC_ASSERT(scheduler);
 
@@ -352,6 +638,12 @@ Event* scheduler_pop(Scheduler* scheduler) {
 
         if(nextEvent != NULL) {
             /* we have an event, let the worker run it */
+            if(scheduler->trace.file) {
+                SchedulerThreadRound* round = g_hash_table_lookup(scheduler->threadToRoundMap, GUINT_TO_POINTER(pthread_self()));
+                if(round) {
+                    round->nEvents++;
+                }
+            }
             return nextEvent;
         } else if(scheduler->policyType == SP_SERIAL_GLOBAL) {
             /* the running thread has no more events to execute this round, but we only have a
@@ -363,6 +655,17 @@ Event* scheduler_pop(Scheduler* scheduler) {
              * track idle times, so let's start by making sure we have timer elements in place. */
             GTimer* executeEventsBarrierWaitTime = g_hash_table_lookup(scheduler->threadToWaitTimerMap, GUINT_TO_POINTER(pthread_self()));
 
+            SchedulerThreadRound* round = NULL;
+            if(_scheduler_isTrackingRounds(scheduler)) {
+                round = g_hash_table_lookup(scheduler->threadToRoundMap, GUINT_TO_POINTER(pthread_self()));
+                _scheduler_arriveAtBarrier(scheduler, round);
+            }
+
+            /* the live statistics should not wait until we run our next event */
+            if(scheduler->collectLiveStats) {
+                worker_flushLiveStats();
+            }
+
             /* wait for all other worker threads to finish their events too, and track wait time */
             if(executeEventsBarrierWaitTime) {
                 g_timer_continue(executeEventsBarrierWaitTime);
@@ -389,6 +692,11 @@ Event* scheduler_pop(Scheduler* scheduler) {
 
             /* now wait for main thread to process a barrier update for the next round */
             countdownlatch_countDownAwait(scheduler->prepareRoundBarrier);
+
+            if(round) {
+                _scheduler_finishThreadRound(scheduler, round);
+                _scheduler_startThreadRound(scheduler, round);
+            }
         }
     }
 
@@ -565,11 +873,37 @@ void scheduler_awaitStart(Scheduler* scheduler) {
     /* wait until all threads are waiting to start */
     countdownlatch_countDownAwait(scheduler->startBarrier);
 
+    /* the slave only enables the round tracking before scheduler_start lets us through
+     * the start barrier, so we must not check for it any earlier than here */
+    SchedulerThreadRound* round = NULL;
+    g_mutex_lock(&scheduler->globalLock);
+    if(_scheduler_isTrackingRounds(scheduler)) {
+        round = g_new0(SchedulerThreadRound, 1);
+        round->threadID = worker_getThreadID();
+        if(scheduler->collectPerfCounters) {
+            /* counters only count the thread that opens them */
+            round->counters = perfcounters_new();
+            if(!round->counters) {
+                warning("unable to open any performance counters for worker %i", round->threadID);
+            }
+        }
+        g_hash_table_insert(scheduler->threadToRoundMap, GUINT_TO_POINTER(pthread_self()), round);
+    }
+    g_mutex_unlock(&scheduler->globalLock);
+
     /* each thread will boot their own hosts */
     _scheduler_startHosts(scheduler);
 
     /* everyone is waiting for the next round to be ready */
     countdownlatch_countDownAwait(scheduler->prepareRoundBarrier);
+
+    if(round) {
+        /* dont count booting the hosts toward the first round */
+        if(round->counters) {
+            perfcounters_sample(round->counters, &(round->barrierValues));
+        }
+        _scheduler_startThreadRound(scheduler, round);
+    }
 }
 
 void scheduler_awaitFinish(Scheduler* scheduler) {
@@ -599,6 +933,8 @@ void scheduler_start(Scheduler* scheduler) {
 
 void scheduler_continueNextRound(Scheduler* scheduler, SimulationTime windowStart, SimulationTime windowEnd) {
     g_mutex_lock(&scheduler->globalLock);
+    scheduler->currentRound.number++;
+    scheduler->currentRound.startTime = windowStart;
     scheduler->currentRound.endTime = windowEnd;
     scheduler->currentRound.minNextEventTime = SIMTIME_MAX;
     g_mutex_unlock(&scheduler->globalLock);
@@ -16,6 +16,11 @@ Scheduler* scheduler_new(SchedulerPolicyType policyType, guint nWorkers, gpointe
 void scheduler_ref(Scheduler*);
 void scheduler_unref(Scheduler*);
 void scheduler_shutdown(Scheduler* scheduler);
+void scheduler_enableRoundTrace(Scheduler* scheduler, const gchar* tracePath);
+void scheduler_enablePerfCounters(Scheduler* scheduler);
+void scheduler_logPerfCounters(Scheduler* scheduler);
+void scheduler_enableLiveStats(Scheduler* scheduler);
+void scheduler_appendLiveStats(Scheduler* scheduler, GString* buffer);
 
 void scheduler_awaitStart(Scheduler*);
 void scheduler_awaitFinish(Scheduler*);
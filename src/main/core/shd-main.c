@@ -774,6 +774,17 @@ gint main_runShadow(gint argc, gchar* argv[]) {
     Logger* shadowLogger = logger_new(options_getLogLevel(options));
     logger_setDefault(shadowLogger);
 
+    /* this must happen before anything is flushed, so the whole log is compressed */
+    const gchar* compressionStr = options_getLogCompressionString(options);
+    LogCompression compression = options_getLogCompression(options);
+    if(compression == LOG_COMPRESSION_NONE && g_ascii_strcasecmp(compressionStr, "none")) {
+        g_printerr("** Did not recognize log compression '%s', writing plain log output\n", compressionStr);
+    } else if(compression != LOG_COMPRESSION_NONE &&
+            !logger_setOutputCompression(shadowLogger, compression, options_getLogCompressionLevel(options),
+                    options_getLogCompressionBlockSize(options), options_getLogFlushPolicy(options))) {
+        g_printerr("** Log compression '%s' is not available in this build, writing plain log output\n", compressionStr);
+    }
+
     /* disable buffering during startup so that we see every message immediately in the terminal */
     logger_setEnableBuffering(shadowLogger, FALSE);
 
@@ -249,7 +249,8 @@ static void _master_registerPluginCallback(ConfigurationPluginElement* pe, Maste
     MAGIC_ASSERT(master);
     utility_assert(pe->id.isSet && pe->id.string);
     slave_addNewProgram(master->slave, pe->id.string->str, pe->path.string->str,
-                        pe->startsymbol.isSet ? pe->startsymbol.string->str : NULL);
+                        pe->startsymbol.isSet ? pe->startsymbol.string->str : NULL,
+                        pe->stacksize.isSet ? (gsize)pe->stacksize.integer : 0);
 }
 
 static void _master_registerPlugins(Master* master) {
@@ -325,6 +326,8 @@ static void _master_registerHostCallback(ConfigurationHostElement* he, Master* m
                 options_toHeartbeatLogInfo(master->options, he->heartbeatloginfo.string->str) :
                 options_getHeartbeatLogInfo(master->options);
 
+        params->heartbeatFormat = options_getHeartbeatFormat(master->options);
+
         params->logPcap = (he->logpcap.isSet && !g_ascii_strcasecmp(he->logpcap.string->str, "true")) ? TRUE : FALSE;
         params->pcapDir = he->pcapdir.isSet ? he->pcapdir.string->str : NULL;
 
@@ -343,6 +346,9 @@ static void _master_registerHostCallback(ConfigurationHostElement* he, Master* m
                 options_getInterfaceBufferSize(master->options);
         params->qdisc = options_getQueuingDiscipline(master->options);
 
+        gint arenaSizeMiB = options_getHostArenaSize(master->options);
+        params->arenaSize = arenaSizeMiB > 0 ? ((guint64)arenaSizeMiB) * 1024 * 1024 : 0;
+
         /* requested attributes from shadow config */
         params->ipHint = he->ipHint.isSet ? he->ipHint.string->str : NULL;
         params->countrycodeHint = he->countrycodeHint.isSet ? he->countrycodeHint.string->str : NULL;
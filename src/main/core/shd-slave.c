@@ -7,6 +7,7 @@
 
 #include <sys/time.h>
 #include <sys/resource.h>
+#include <unistd.h>
 
 typedef struct {
 
@@ -18,6 +19,9 @@ typedef struct {
 
   /* the start symbol for the program */
   gchar* startSymbol;
+
+  /* the stack size for the program's threads, or 0 for the default */
+  gsize stackSize;
   
   MAGIC_DECLARE;
 } _ProgramMeta;
@@ -38,6 +42,23 @@ struct _Slave {
     /* global object counters, we collect counts from workers at end of sim */
     ObjectCounter* objectCounts;
 
+    /* global task profile, workers add theirs periodically and at end of sim */
+    Profiler* profiler;
+    GTimer* profileTimer;
+
+    /* answers queries for live statistics, if the stats socket is enabled */
+    StatsServer* statsServer;
+    GTimer* statsTimer;
+    /* what the workers reported so far, protected by the slave lock */
+    SimulationTime simClockLive;
+    guint64 nEventsLive;
+    /* the values at the previous query, so we can also report recent rates */
+    struct {
+        gdouble wallSeconds;
+        SimulationTime simClock;
+        guint64 nEvents;
+    } lastStatsQuery;
+
     /* the parallel event/host/thread scheduler */
     Scheduler* scheduler;
 
@@ -98,7 +119,7 @@ static SchedulerPolicyType _slave_getEventSchedulerPolicy(Slave* slave) {
     }
 }
 
-_ProgramMeta* _program_meta_new(const gchar* name, const gchar* path, const gchar* startSymbol) {
+_ProgramMeta* _program_meta_new(const gchar* name, const gchar* path, const gchar* startSymbol, gsize stackSize) {
     if((name == NULL) || (path == NULL)) {
         error("attempting to register a program with a null name and/or path");
     }
@@ -113,6 +134,8 @@ _ProgramMeta* _program_meta_new(const gchar* name, const gchar* path, const gcha
         meta->startSymbol = g_strdup(startSymbol);
     }
 
+    meta->stackSize = stackSize;
+
     return meta;
 }
 
@@ -144,6 +167,73 @@ static guint _slave_nextRandomUInt(Slave* slave) {
     return r;
 }
 
+static guint64 _slave_getResidentBytes() {
+    /* the second field is the number of resident pages */
+    gchar* contents = NULL;
+    guint64 residentPages = 0;
+    if(g_file_get_contents("/proc/self/statm", &contents, NULL, NULL)) {
+        gchar** fields = g_strsplit(contents, " ", 3);
+        if(fields[0] && fields[1]) {
+            residentPages = g_ascii_strtoull(fields[1], NULL, 10);
+        }
+        g_strfreev(fields);
+        g_free(contents);
+    }
+    return residentPages * (guint64)sysconf(_SC_PAGESIZE);
+}
+
+/* runs in the stats server thread */
+static GString* _slave_collectLiveStats(Slave* slave) {
+    MAGIC_ASSERT(slave);
+    GString* buffer = g_string_new(NULL);
+
+    _slave_lock(slave);
+
+    gdouble wallSeconds = g_timer_elapsed(slave->statsTimer, NULL);
+    gdouble simSeconds = ((gdouble)slave->simClockLive) / SIMTIME_ONE_SECOND;
+    guint64 nEvents = slave->nEventsLive;
+
+    gdouble recentWallSeconds = wallSeconds - slave->lastStatsQuery.wallSeconds;
+    gdouble recentSimSeconds = ((gdouble)(slave->simClockLive - slave->lastStatsQuery.simClock)) / SIMTIME_ONE_SECOND;
+    guint64 nRecentEvents = nEvents - slave->lastStatsQuery.nEvents;
+
+    slave->lastStatsQuery.wallSeconds = wallSeconds;
+    slave->lastStatsQuery.simClock = slave->simClockLive;
+    slave->lastStatsQuery.nEvents = nEvents;
+
+    g_string_append_printf(buffer, "{\"simulated-seconds\":%.9f,\"wall-seconds\":%.3f,"
+            "\"simulated-per-wall\":%f,\"simulated-per-wall-recent\":%f,"
+            "\"events\":%"G_GUINT64_FORMAT",\"events-per-second\":%.1f,\"events-per-second-recent\":%.1f,"
+            "\"live-objects\":",
+            simSeconds, wallSeconds,
+            (wallSeconds > 0) ? simSeconds / wallSeconds : 0.0f,
+            (recentWallSeconds > 0) ? recentSimSeconds / recentWallSeconds : 0.0f,
+            nEvents,
+            (wallSeconds > 0) ? nEvents / wallSeconds : 0.0f,
+            (recentWallSeconds > 0) ? nRecentEvents / recentWallSeconds : 0.0f);
+    objectcounter_appendLiveJSON(slave->objectCounts, buffer);
+
+    _slave_unlock(slave);
+
+    /* the scheduler has its own lock */
+    g_string_append(buffer, ",\"workers\":");
+    if(scheduler_getPolicy(slave->scheduler) == SP_SERIAL_GLOBAL) {
+        /* the only worker runs events all the time */
+        g_string_append_printf(buffer, "[{\"id\":0,\"busy-seconds\":%.3f,\"idle-seconds\":0.000}]", wallSeconds);
+    } else {
+        scheduler_appendLiveStats(slave->scheduler, buffer);
+    }
+
+    struct rusage resources;
+    memset(&resources, 0, sizeof(struct rusage));
+    getrusage(RUSAGE_SELF, &resources);
+
+    g_string_append_printf(buffer, ",\"rss-bytes\":%"G_GUINT64_FORMAT",\"max-rss-bytes\":%"G_GUINT64_FORMAT"}\n",
+            _slave_getResidentBytes(), ((guint64)resources.ru_maxrss) * 1024);
+
+    return buffer;
+}
+
 Slave* slave_new(Master* master, Options* options, SimulationTime endTime, guint randomSeed) {
     if(globalSlave != NULL) {
         return NULL;
@@ -160,6 +250,10 @@ Slave* slave_new(Master* master, Options* options, SimulationTime endTime, guint
     slave->options = options;
     slave->random = random_new(randomSeed);
     slave->objectCounts = objectcounter_new();
+    if(options_doRunTaskProfile(options)) {
+        slave->profiler = profiler_new();
+        slave->profileTimer = g_timer_new();
+    }
 
     slave->rawFrequencyKHz = utility_getRawCPUFrequency(CONFIG_CPU_MAX_FREQ_FILE);
     if(slave->rawFrequencyKHz == 0) {
@@ -195,6 +289,24 @@ Slave* slave_new(Master* master, Options* options, SimulationTime endTime, guint
     /* now make sure the hosts path exists, as it may not have been in the template */
     g_mkdir_with_parents(slave->hostsPath, 0775);
 
+    /* the data directory is ready, so the trace file will not be removed */
+    if(options_doRunSchedulerTrace(options)) {
+        gchar* tracePath = g_build_filename(slave->dataPath, "scheduler-trace.json", NULL);
+        scheduler_enableRoundTrace(slave->scheduler, tracePath);
+        g_free(tracePath);
+    }
+
+    if(options_doRunPerfCounters(options)) {
+        scheduler_enablePerfCounters(slave->scheduler);
+    }
+
+    const gchar* statsSocketPath = options_getStatsSocketPath(options);
+    if(statsSocketPath) {
+        slave->statsTimer = g_timer_new();
+        scheduler_enableLiveStats(slave->scheduler);
+        slave->statsServer = statsserver_new(statsSocketPath, (StatsServerCollectFunc)_slave_collectLiveStats, slave);
+    }
+
     return slave;
 }
 
@@ -205,6 +317,15 @@ gint slave_free(Slave* slave) {
     /* we will never execute inside the plugin again */
     slave->forceShadowContext = TRUE;
 
+    /* stop answering queries before the scheduler and counters go away */
+    if(slave->statsServer) {
+        statsserver_free(slave->statsServer);
+        slave->statsServer = NULL;
+    }
+    if(slave->statsTimer) {
+        g_timer_destroy(slave->statsTimer);
+    }
+
     if(slave->scheduler) {
         /* stop all of the threads and release host resources first */
         scheduler_shutdown(slave->scheduler);
@@ -218,6 +339,27 @@ gint slave_free(Slave* slave) {
         objectcounter_free(slave->objectCounts);
     }
 
+    if(slave->profiler != NULL) {
+        message("%s", profiler_summaryToString(slave->profiler, CONFIG_TASK_PROFILE_SUMMARY_ITEMS));
+
+        gchar* profilePath = g_build_filename(slave->dataPath, "task-profile.csv", NULL);
+        if(profiler_writeCSV(slave->profiler, profilePath)) {
+            message("wrote task profile to '%s'", profilePath);
+        }
+        g_free(profilePath);
+
+        if(options_doRunTaskProfileFolded(slave->options)) {
+            profilePath = g_build_filename(slave->dataPath, "task-profile.folded", NULL);
+            if(profiler_writeFolded(slave->profiler, profilePath)) {
+                message("wrote folded task profile stacks to '%s'", profilePath);
+            }
+            g_free(profilePath);
+        }
+
+        profiler_free(slave->profiler);
+        g_timer_destroy(slave->profileTimer);
+    }
+
     g_hash_table_destroy(slave->programMeta);
 
     g_mutex_clear(&(slave->lock));
@@ -256,7 +398,7 @@ guint slave_getRawCPUFrequency(Slave* slave) {
     return freq;
 }
 
-void slave_addNewProgram(Slave* slave, const gchar* name, const gchar* path, const gchar* startSymbol) {
+void slave_addNewProgram(Slave* slave, const gchar* name, const gchar* path, const gchar* startSymbol, gsize stackSize) {
     MAGIC_ASSERT(slave);
 
     /* store the path to the plugin and maybe the start symbol with the given
@@ -266,7 +408,7 @@ void slave_addNewProgram(Slave* slave, const gchar* name, const gchar* path, con
         error("attempting to regiser 2 plugins with the same path."
               "this should have been caught by the configuration parser.");
     } else {
-        _ProgramMeta* meta = _program_meta_new(name, path, startSymbol);
+        _ProgramMeta* meta = _program_meta_new(name, path, startSymbol, stackSize);
         g_hash_table_replace(slave->programMeta, g_strdup(name), meta);
     }
 }
@@ -308,7 +450,7 @@ void slave_addNewVirtualProcess(Slave* slave, gchar* hostName, gchar* pluginName
     Host* host = scheduler_getHost(slave->scheduler, hostID);
     host_continueExecutionTimer(host);
     host_addApplication(host, startTime, stopTime, pluginName, meta->path, 
-                        meta->startSymbol, preloadName, 
+                        meta->startSymbol, meta->stackSize, preloadName, 
                         preload ? preload->path : NULL, arguments);
     host_stopExecutionTimer(host);
 }
@@ -385,6 +527,8 @@ static void _slave_heartbeat(Slave* slave, SimulationTime simClockNow) {
         } else {
             warning("unable to print process resources usage: error %i in getrusage: %s", errno, g_strerror(errno));
         }
+
+        scheduler_logPerfCounters(slave->scheduler);
     }
 }
 
@@ -461,6 +605,35 @@ void slave_storeCounts(Slave* slave, ObjectCounter* objectCounter) {
     _slave_unlock(slave);
 }
 
+void slave_storeLiveStats(Slave* slave, ObjectCounter* objectCounter, guint64 nEvents, SimulationTime simClockNow) {
+    MAGIC_ASSERT(slave);
+    _slave_lock(slave);
+    if(slave->objectCounts) {
+        objectcounter_incrementAll(slave->objectCounts, objectCounter);
+    }
+    slave->nEventsLive += nEvents;
+    if(simClockNow != SIMTIME_INVALID) {
+        slave->simClockLive = MAX(slave->simClockLive, simClockNow);
+    }
+    _slave_unlock(slave);
+}
+
+void slave_storeProfile(Slave* slave, Profiler* profiler) {
+    MAGIC_ASSERT(slave);
+    _slave_lock(slave);
+    if(slave->profiler) {
+        profiler_takeAll(slave->profiler, profiler);
+
+        /* workers each store at their own interval, but we only log once per interval */
+        guint interval = options_getTaskProfileInterval(slave->options);
+        if(interval > 0 && g_timer_elapsed(slave->profileTimer, NULL) >= (gdouble)interval) {
+            message("%s", profiler_summaryToString(slave->profiler, CONFIG_TASK_PROFILE_SUMMARY_ITEMS));
+            g_timer_start(slave->profileTimer);
+        }
+    }
+    _slave_unlock(slave);
+}
+
 void slave_countObject(ObjectType otype, CounterType ctype) {
     if(globalSlave) {
         MAGIC_ASSERT(globalSlave);
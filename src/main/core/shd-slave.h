@@ -46,12 +46,15 @@ void slave_run(Slave*);
 gboolean slave_schedulerIsRunning(Slave* slave);
 
 /* info received from master to set up the simulation */
-void slave_addNewProgram(Slave* slave, const gchar* name, const gchar* path, const gchar* startSymbol);
+void slave_addNewProgram(Slave* slave, const gchar* name, const gchar* path, const gchar* startSymbol, gsize stackSize);
 void slave_addNewVirtualHost(Slave* slave, HostParameters* params);
 void slave_addNewVirtualProcess(Slave* slave, gchar* hostName, gchar* pluginName, gchar* preloadName,
         SimulationTime startTime, SimulationTime stopTime, gchar* arguments);
 
 void slave_storeCounts(Slave* slave, ObjectCounter* objectCounter);
+/* adds counts and progress since the worker's last report, for the live statistics */
+void slave_storeLiveStats(Slave* slave, ObjectCounter* objectCounter, guint64 nEvents, SimulationTime simClockNow);
+void slave_storeProfile(Slave* slave, Profiler* profiler);
 void slave_countObject(ObjectType otype, CounterType ctype);
 
 #endif /* SHD_SLAVE_H_ */
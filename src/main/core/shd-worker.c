@@ -33,6 +33,14 @@ struct _Worker {
 
     ObjectCounter* objectCounts;
 
+    /* where our real time goes, if task profiling is enabled */
+    Profiler* profiler;
+    guint profileInterval;
+
+    /* set if the stats socket is enabled, then we report our progress every now and then */
+    GTimer* statsTimer;
+    guint64 nEventsSinceStats;
+
     MAGIC_DECLARE;
 };
 
@@ -69,6 +77,15 @@ static Worker* _worker_new(Slave* slave, guint threadID) {
     worker->clock.barrier = SIMTIME_INVALID;
     worker->objectCounts = objectcounter_new();
 
+    Options* options = slave ? slave_getOptions(slave) : NULL;
+    if(options && options_doRunTaskProfile(options)) {
+        worker->profiler = profiler_new();
+        worker->profileInterval = options_getTaskProfileInterval(options);
+    }
+    if(options && options_getStatsSocketPath(options)) {
+        worker->statsTimer = g_timer_new();
+    }
+
     g_private_replace(&workerKey, worker);
 
     return worker;
@@ -81,6 +98,14 @@ static void _worker_free(Worker* worker) {
         objectcounter_free(worker->objectCounts);
     }
 
+    if(worker->profiler != NULL) {
+        profiler_free(worker->profiler);
+    }
+
+    if(worker->statsTimer != NULL) {
+        g_timer_destroy(worker->statsTimer);
+    }
+
     g_private_set(&workerKey, NULL);
 
     MAGIC_CLEAR(worker);
@@ -114,6 +139,24 @@ Options* worker_getOptions() {
     return slave_getOptions(worker->slave);
 }
 
+static void _worker_storeLiveStats(Worker* worker, SimulationTime simClockNow) {
+    /* the slave adds up what we send, so start counting from zero again */
+    slave_storeLiveStats(worker->slave, worker->objectCounts, worker->nEventsSinceStats, simClockNow);
+    objectcounter_free(worker->objectCounts);
+    worker->objectCounts = objectcounter_new();
+    worker->nEventsSinceStats = 0;
+    g_timer_start(worker->statsTimer);
+}
+
+/* called by the scheduler before we block at the round barrier, where we may wait
+ * much longer than the stats interval for the other workers */
+void worker_flushLiveStats() {
+    Worker* worker = _worker_getPrivate();
+    if(worker->statsTimer && worker->nEventsSinceStats > 0) {
+        _worker_storeLiveStats(worker, worker->clock.last);
+    }
+}
+
 /* this is the entry point for worker threads when running in parallel mode,
  * and otherwise is the main event loop when running in serial mode */
 gpointer worker_run(WorkerRunData* data) {
@@ -140,6 +183,19 @@ gpointer worker_run(WorkerRunData* data) {
         event_execute(event);
         event_unref(event);
 
+        /* let the slave see our profile every now and then */
+        if(worker->profiler && profiler_isDue(worker->profiler, worker->profileInterval)) {
+            slave_storeProfile(worker->slave, worker->profiler);
+        }
+
+        /* let the slave see our progress for the live statistics */
+        if(worker->statsTimer) {
+            worker->nEventsSinceStats++;
+            if(g_timer_elapsed(worker->statsTimer, NULL) >= (gdouble)CONFIG_STATS_INTERVAL) {
+                _worker_storeLiveStats(worker, worker->clock.now);
+            }
+        }
+
         /* update times */
         worker->clock.last = worker->clock.now;
         worker->clock.now = SIMTIME_INVALID;
@@ -162,6 +218,9 @@ gpointer worker_run(WorkerRunData* data) {
 
     /* cleanup is all done, send object counts to slave */
     slave_storeCounts(worker->slave, worker->objectCounts);
+    if(worker->profiler) {
+        slave_storeProfile(worker->slave, worker->profiler);
+    }
 
     /* synchronize thread join */
     CountDownLatch* notifyJoined = data->notifyJoined;
@@ -185,6 +244,17 @@ gpointer worker_run(WorkerRunData* data) {
     return NULL;
 }
 
+void worker_newStandalone(guint threadID) {
+    _worker_new(NULL, threadID);
+}
+
+void worker_freeStandalone() {
+    Worker* worker = _worker_getPrivate();
+    utility_assert(worker->slave == NULL);
+    worker_setActiveHost(NULL);
+    _worker_free(worker);
+}
+
 gboolean worker_scheduleTask(Task* task, SimulationTime nanoDelay) {
     utility_assert(task);
 
@@ -275,7 +345,9 @@ static void _worker_bootHost(Host* host, Worker* worker) {
     worker_setActiveHost(host);
     worker->clock.now = 0;
     host_continueExecutionTimer(host);
+    worker_startTaskProfile("host_boot");
     host_boot(host);
+    worker_stopTaskProfile();
     host_stopExecutionTimer(host);
     worker->clock.now = SIMTIME_INVALID;
     worker_setActiveHost(NULL);
@@ -289,7 +361,9 @@ void worker_bootHosts(GQueue* hosts) {
 static void _worker_freeHostProcesses(Host* host, Worker* worker) {
     worker_setActiveHost(host);
     host_continueExecutionTimer(host);
+    worker_startTaskProfile("host_freeAllApplications");
     host_freeAllApplications(host);
+    worker_stopTaskProfile();
     host_stopExecutionTimer(host);
     worker_setActiveHost(NULL);
 }
@@ -322,6 +396,10 @@ void worker_setActiveProcess(Process* proc) {
         process_ref(proc);
         worker->active.process = proc;
     }
+
+    /* let the preload library answer time queries from this process directly */
+    extern int interposer_setTimePage(ProcessTimePage*);
+    interposer_setTimePage(proc ? process_updateTimePage(proc) : NULL);
 }
 
 Host* worker_getActiveHost() {
@@ -345,6 +423,33 @@ void worker_setActiveHost(Host* host) {
     }
 }
 
+void worker_startTaskProfile(const gchar* taskName) {
+    Worker* worker = _worker_getPrivate();
+    if(worker->profiler) {
+        GQuark hostID = worker->active.host ? host_getID(worker->active.host) : 0;
+        profiler_startTask(worker->profiler, hostID, taskName);
+    }
+}
+
+void worker_stopTaskProfile() {
+    Worker* worker = _worker_getPrivate();
+    if(worker->profiler) {
+        profiler_stopTask(worker->profiler);
+    }
+}
+
+void worker_setPluginProfileContext(gboolean isInPlugin) {
+    /* this is called on every plugin context switch, so keep it cheap */
+    Worker* worker = g_private_get(&workerKey);
+    if(worker && worker->profiler) {
+        if(isInPlugin) {
+            profiler_enterPlugin(worker->profiler);
+        } else {
+            profiler_exitPlugin(worker->profiler);
+        }
+    }
+}
+
 SimulationTime worker_getCurrentTime() {
     Worker* worker = _worker_getPrivate();
     return worker->clock.now;
@@ -379,7 +484,10 @@ gint worker_getThreadID() {
 
 void worker_updateMinTimeJump(gdouble minPathLatency) {
     Worker* worker = _worker_getPrivate();
-    slave_updateMinTimeJump(worker->slave, minPathLatency);
+    /* standalone workers have no slave that could use the jump */
+    if(worker->slave) {
+        slave_updateMinTimeJump(worker->slave, minPathLatency);
+    }
 }
 
 void worker_setCurrentTime(SimulationTime time) {
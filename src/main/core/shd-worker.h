@@ -25,6 +25,12 @@ DNS* worker_getDNS();
 Topology* worker_getTopology();
 Options* worker_getOptions();
 gpointer worker_run(WorkerRunData*);
+void worker_flushLiveStats();
+/* creates a worker for the calling thread that does not belong to a slave, so
+ * that core objects can be used outside of a simulation, e.g., by benchmarks.
+ * anything that needs the slave, like scheduling tasks, must not be used. */
+void worker_newStandalone(guint threadID);
+void worker_freeStandalone();
 gboolean worker_scheduleTask(Task* task, SimulationTime nanoDelay);
 void worker_sendPacket(Packet* packet);
 gboolean worker_isAlive();
@@ -50,6 +56,10 @@ void worker_setActiveHost(Host* host);
 Process* worker_getActiveProcess();
 void worker_setActiveProcess(Process* proc);
 
+void worker_startTaskProfile(const gchar* taskName);
+void worker_stopTaskProfile();
+void worker_setPluginProfileContext(gboolean isInPlugin);
+
 void worker_incrementPluginError();
 
 Address* worker_resolveIPToAddress(in_addr_t ip);
@@ -356,6 +356,17 @@ static GError* _parser_handlePluginAttributes(Parser* parser, const gchar** attr
         } else if (!plugin->startsymbol.isSet && !g_ascii_strcasecmp(name, "startsymbol")) {
             plugin->startsymbol.string = g_string_new(value);
             plugin->startsymbol.isSet = TRUE;
+        } else if (!plugin->stacksize.isSet && !g_ascii_strcasecmp(name, "stacksize")) {
+            /* strtoull would silently accept signs, trailing junk, and overflow */
+            gchar* end = NULL;
+            guint64 stacksize = g_ascii_isdigit(value[0]) ? g_ascii_strtoull(value, &end, 10) : 0;
+            if(end == NULL || *end != '\0' || stacksize == 0 || stacksize > CONFIG_PLUGIN_MAX_STACK_SIZE) {
+                error = g_error_new(G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+                        "element 'plugin' attribute 'stacksize' must be a number of bytes between 1 and %u, not '%s'",
+                        (guint)CONFIG_PLUGIN_MAX_STACK_SIZE, value);
+            }
+            plugin->stacksize.integer = stacksize;
+            plugin->stacksize.isSet = TRUE;
         } else {
             error = g_error_new(G_MARKUP_ERROR, G_MARKUP_ERROR_UNKNOWN_ATTRIBUTE,
                             "unknown 'plugin' attribute '%s'", name);
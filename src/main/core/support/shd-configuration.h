@@ -40,6 +40,7 @@ struct _ConfigurationPluginElement {
     ConfigurationStringAttribute path;
     /* optional*/
     ConfigurationStringAttribute startsymbol;
+    ConfigurationIntegerAttribute stacksize;
 };
 
 typedef struct _ConfigurationTopologyElement ConfigurationTopologyElement;
@@ -162,6 +162,14 @@ typedef guint64 EmulatedTime;
 #define CONFIG_TCP_RTO_MIN 200
 #define CONFIG_TCP_RTO_MAX 1200000
 
+/**
+ * Delayed ACK parameters used when --tcp-delayed-ack is set. Like Linux, we
+ * acknowledge at least every second full segment, and otherwise send the ACK
+ * when the delayed ACK timer fires, TCP_DELACK_MIN=40ms from net/tcp.h
+ */
+#define CONFIG_TCP_DELACK_SEGMENTS 2
+#define CONFIG_TCP_DELACK_TIMEOUT (40 * SIMTIME_ONE_MILLISECOND)
+
 /**
  * Minimum size of the send buffer per socket when TCP-autotuning is used.
  * This value was computed from "man tcp"
@@ -224,11 +232,40 @@ typedef guint64 EmulatedTime;
  */
 #define CONFIG_DATAGRAM_MAX_SIZE 65507
 
+/**
+ * Maximum number of bytes we stage at a time when moving file data into or
+ * out of a shadow descriptor with sendfile or splice
+ */
+#define CONFIG_FILE_TRANSFER_CHUNK_SIZE 65536
+
+/**
+ * Largest stack in bytes that a plugin may request for its threads with the
+ * 'stacksize' attribute. pth stores stack sizes as unsigned int.
+ */
+#define CONFIG_PLUGIN_MAX_STACK_SIZE (256*1024*1024)
+
 /**
  * Delay in nanoseconds for a TCP close timer.
  */
 #define CONFIG_TCPCLOSETIMER_DELAY (60 * SIMTIME_ONE_SECOND)
 
+/**
+ * Default number of bytes of formatted log output handed to the log writer at
+ * once, which is also the size of its compressed output buffer
+ */
+#define CONFIG_LOG_COMPRESSION_BLOCK_SIZE 65536
+
+/**
+ * Number of tasks and of hosts listed in each logged task profile summary
+ */
+#define CONFIG_TASK_PROFILE_SUMMARY_ITEMS 10
+
+/**
+ * Real time in seconds between the live statistics reports each worker sends
+ * to the slave when the statistics socket is enabled
+ */
+#define CONFIG_STATS_INTERVAL 1
+
 /**
  * Filename to find the CPU speed.
  */
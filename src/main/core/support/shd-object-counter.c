@@ -239,3 +239,36 @@ const gchar* objectcounter_diffsToString(ObjectCounter* counter) {
 
     return (const gchar*) counter->stringBuffer->str;
 }
+
+void objectcounter_appendLiveJSON(ObjectCounter* counter, GString* buffer) {
+    MAGIC_ASSERT(counter);
+    utility_assert(buffer);
+
+    /* signed, because workers report at different times and one may have
+     * reported freeing objects that another has not yet reported creating */
+    g_string_append_printf(buffer, "{"
+            "\"task\":%"G_GINT64_FORMAT","
+            "\"event\":%"G_GINT64_FORMAT","
+            "\"packet\":%"G_GINT64_FORMAT","
+            "\"payload\":%"G_GINT64_FORMAT","
+            "\"host\":%"G_GINT64_FORMAT","
+            "\"process\":%"G_GINT64_FORMAT","
+            "\"descriptor\":%"G_GINT64_FORMAT","
+            "\"channel\":%"G_GINT64_FORMAT","
+            "\"tcp\":%"G_GINT64_FORMAT","
+            "\"udp\":%"G_GINT64_FORMAT","
+            "\"epoll\":%"G_GINT64_FORMAT","
+            "\"timer\":%"G_GINT64_FORMAT"}",
+            (gint64)(counter->counters.task.new - counter->counters.task.free),
+            (gint64)(counter->counters.event.new - counter->counters.event.free),
+            (gint64)(counter->counters.packet.new - counter->counters.packet.free),
+            (gint64)(counter->counters.payload.new - counter->counters.payload.free),
+            (gint64)(counter->counters.host.new - counter->counters.host.free),
+            (gint64)(counter->counters.process.new - counter->counters.process.free),
+            (gint64)(counter->counters.descriptor.new - counter->counters.descriptor.free),
+            (gint64)(counter->counters.channel.new - counter->counters.channel.free),
+            (gint64)(counter->counters.tcp.new - counter->counters.tcp.free),
+            (gint64)(counter->counters.udp.new - counter->counters.udp.free),
+            (gint64)(counter->counters.epoll.new - counter->counters.epoll.free),
+            (gint64)(counter->counters.timer.new - counter->counters.timer.free));
+}
@@ -49,4 +49,7 @@ const gchar* objectcounter_valuesToString(ObjectCounter* counter);
  * the string is owned by the object counter, and should not be freed by the caller. */
 const gchar* objectcounter_diffsToString(ObjectCounter* counter);
 
+/* appends the number of live objects of each type, i.e., new minus free, as a json object */
+void objectcounter_appendLiveJSON(ObjectCounter* counter, GString* buffer);
+
 #endif /* SRC_MAIN_CORE_SUPPORT_SHD_OBJECT_COUNTER_H_ */
@@ -13,12 +13,23 @@ struct _Options {
 
     GOptionGroup* mainOptionGroup;
     gchar* logLevelInput;
+    gchar* logCompressionInput;
+    gint logCompressionLevel;
+    gint logCompressionBlockSize;
+    gchar* logFlushPolicyInput;
     gint nWorkerThreads;
     guint randomSeed;
     gboolean printSoftwareVersion;
+    gboolean schedulerTrace;
+    gchar* statsSocketPath;
+    gboolean perfCounters;
+    gboolean taskProfile;
+    gboolean taskProfileFolded;
+    gint taskProfileInterval;
     guint heartbeatInterval;
     gchar* heartbeatLogLevelInput;
     gchar* heartbeatLogInfo;
+    gchar* heartbeatFormatInput;
     gchar* preloads;
     gboolean runValgrind;
     gboolean debug;
@@ -31,6 +42,7 @@ struct _Options {
     gint minRunAhead;
     gint initialTCPWindow;
     gint interfaceBufferSize;
+    gint hostArenaSize;
     gint initialSocketReceiveBufferSize;
     gint initialSocketSendBufferSize;
     gboolean autotuneSocketReceiveBuffer;
@@ -40,6 +52,7 @@ struct _Options {
     SimulationTime interfaceBatchTime;
     gchar* tcpCongestionControl;
     gint tcpSlowStartThreshold;
+    gboolean tcpDelayedAck;
 
     GOptionGroup* pluginsOptionGroup;
     gboolean runTGenExample;
@@ -76,6 +89,7 @@ Options* options_new(gint argc, gchar* argv[]) {
     options->cpuThreshold = -1;
     options->cpuPrecision = 200;
     options->heartbeatInterval = 1;
+    options->taskProfileInterval = 60;
 
     /* set options to change defaults for the main group */
     options->mainOptionGroup = g_option_group_new("main", "Main Options", "Primary simulator options", NULL, NULL);
@@ -83,15 +97,26 @@ Options* options_new(gint argc, gchar* argv[]) {
       { "data-directory", 'd', 0, G_OPTION_ARG_STRING, &(options->dataDirPath), "PATH to store simulation output ['shadow.data']", "PATH" },
       { "data-template", 'e', 0, G_OPTION_ARG_STRING, &(options->dataTemplatePath), "PATH to recursively copy during startup and use as the data-directory ['shadow.data.template']", "PATH" },
       { "gdb", 'g', 0, G_OPTION_ARG_NONE, &(options->debug), "Pause at startup for debugger attachment", NULL },
+      { "heartbeat-format", 0, 0, G_OPTION_ARG_STRING, &(options->heartbeatFormatInput), "Write node statistics as 'log' messages, or as 'csv' time series files in each host's data directory ['log']", "FORMAT" },
       { "heartbeat-frequency", 'h', 0, G_OPTION_ARG_INT, &(options->heartbeatInterval), "Log node statistics every N seconds [1]", "N" },
       { "heartbeat-log-info", 'i', 0, G_OPTION_ARG_STRING, &(options->heartbeatLogInfo), "Comma separated list of information contained in heartbeat ('node','socket','ram') ['node']", "LIST"},
       { "heartbeat-log-level", 'j', 0, G_OPTION_ARG_STRING, &(options->heartbeatLogLevelInput), "Log LEVEL at which to print node statistics ['message']", "LEVEL" },
+      { "log-compression", 0, 0, G_OPTION_ARG_STRING, &(options->logCompressionInput), "Compress log and heartbeat output written to stdout with ALGO, if available in this build ('none', 'zlib', 'zstd') ['none']", "ALGO" },
+      { "log-compression-block", 0, 0, G_OPTION_ARG_INT, &(options->logCompressionBlockSize), "Hand log output to the compressor in blocks of N bytes [65536]", "N" },
+      { "log-compression-flush", 0, 0, G_OPTION_ARG_STRING, &(options->logFlushPolicyInput), "When to flush compressed log output, on every log sync or only when a block fills ('sync', 'block') ['sync']", "POLICY" },
+      { "log-compression-level", 0, 0, G_OPTION_ARG_INT, &(options->logCompressionLevel), "Compression LEVEL for log output, 0 for the compressor's default [0]", "LEVEL" },
       { "log-level", 'l', 0, G_OPTION_ARG_STRING, &(options->logLevelInput), "Log LEVEL above which to filter messages ('error' < 'critical' < 'warning' < 'message' < 'info' < 'debug') ['message']", "LEVEL" },
+      { "perf-counters", 0, 0, G_OPTION_ARG_NONE, &(options->perfCounters), "Sample cycles, instructions, cache misses, and context switches of each worker at every round barrier, and report them in the heartbeat and the scheduler trace (needs perf_event_open)", NULL },
       { "preload", 'p', 0, G_OPTION_ARG_STRING, &(options->preloads), "LD_PRELOAD environment VALUE to use for function interposition (/path/to/lib:...) [None]", "VALUE" },
       { "runahead", 'r', 0, G_OPTION_ARG_INT, &(options->minRunAhead), "If set, overrides the automatically calculated minimum TIME workers may run ahead when sending events between nodes, in milliseconds [0]", "TIME" },
       { "seed", 's', 0, G_OPTION_ARG_INT, &(options->randomSeed), "Initialize randomness for each thread using seed N [1]", "N" },
       { "scheduler-policy", 't', 0, G_OPTION_ARG_STRING, &(options->eventSchedulingPolicy), "The event scheduler's policy for thread synchronization ('thread', 'host', 'steal', 'threadXthread', 'threadXhost') ['steal']", "SPOL" },
+      { "scheduler-trace", 0, 0, G_OPTION_ARG_NONE, &(options->schedulerTrace), "Write each worker's event processing and barrier wait times per round to 'scheduler-trace.json' in the data directory, in chrome trace format", NULL },
+      { "stats-socket", 0, 0, G_OPTION_ARG_FILENAME, &(options->statsSocketPath), "Answer each connection to the UNIX socket at PATH with live simulation statistics in json, e.g., simulated time, events per second, worker idle time, object counts, and memory use [None]", "PATH" },
       { "workers", 'w', 0, G_OPTION_ARG_INT, &(options->nWorkerThreads), "Run concurrently with N worker threads [0]", "N" },
+      { "task-profile", 0, 0, G_OPTION_ARG_NONE, &(options->taskProfile), "Measure the real time each host spends in each kind of task, split into plugin and shadow code, and write it to 'task-profile.csv' in the data directory", NULL },
+      { "task-profile-folded", 0, 0, G_OPTION_ARG_NONE, &(options->taskProfileFolded), "Also write the task profile as folded stacks to 'task-profile.folded' for flame graphs", NULL },
+      { "task-profile-interval", 0, 0, G_OPTION_ARG_INT, &(options->taskProfileInterval), "Log a summary of the task profile every N real seconds, 0 to log only at the end [60]", "N" },
       { "valgrind", 'x', 0, G_OPTION_ARG_NONE, &(options->runValgrind), "Run through valgrind for debugging", NULL },
       { "version", 'v', 0, G_OPTION_ARG_NONE, &(options->printSoftwareVersion), "Print software version and exit", NULL },
       { NULL },
@@ -123,12 +148,14 @@ Options* options_new(gint argc, gchar* argv[]) {
     {
       { "cpu-precision", 0, 0, G_OPTION_ARG_INT, &(options->cpuPrecision), "round measured CPU delays to the nearest TIME, in microseconds (negative value to disable fuzzy CPU delays) [200]", "TIME" },
       { "cpu-threshold", 0, 0, G_OPTION_ARG_INT, &(options->cpuThreshold), "TIME delay threshold after which the CPU becomes blocked, in microseconds (negative value to disable CPU delays) (experimental!) [-1]", "TIME" },
+      { "host-arena-size", 0, 0, G_OPTION_ARG_INT, &(options->hostArenaSize), "Serve each host's plug-in memory allocations from a private arena reserving N MiB of address space, released when the host shuts down (0 to use the shared heap) (experimental!) [0]", "N" },
       { "interface-batch", 0, 0, G_OPTION_ARG_INT, &(options->interfaceBatchTime), "Batch TIME for network interface sends and receives, in milliseconds [10]", "TIME" },
       { "interface-buffer", 0, 0, G_OPTION_ARG_INT, &(options->interfaceBufferSize), "Size of the network interface receive buffer, in bytes [1024000]", "N" },
       { "interface-qdisc", 0, 0, G_OPTION_ARG_STRING, &(options->interfaceQueuingDiscipline), "The interface queuing discipline QDISC used to select the next sendable socket ('fifo' or 'rr') ['fifo']", "QDISC" },
       { "socket-recv-buffer", 0, 0, G_OPTION_ARG_INT, &(options->initialSocketReceiveBufferSize), sockrecv->str, "N" },
       { "socket-send-buffer", 0, 0, G_OPTION_ARG_INT, &(options->initialSocketSendBufferSize), socksend->str, "N" },
       { "tcp-congestion-control", 0, 0, G_OPTION_ARG_STRING, &(options->tcpCongestionControl), "Congestion control algorithm to use for TCP ('aimd', 'reno', 'cubic') ['reno']", "TCPCC" },
+      { "tcp-delayed-ack", 0, 0, G_OPTION_ARG_NONE, &(options->tcpDelayedAck), "Delay TCP ACKs for in-order data until every second segment or a short timer, like Linux", NULL },
       { "tcp-ssthresh", 0, 0, G_OPTION_ARG_INT, &(options->tcpSlowStartThreshold), "Set TCP ssthresh value instead of discovering it via packet loss or hystart [0]", "N" },
       { "tcp-windows", 0, 0, G_OPTION_ARG_INT, &(options->initialTCPWindow), "Initialize the TCP send, receive, and congestion windows to N packets [10]", "N" },
       { NULL },
@@ -170,9 +197,21 @@ Options* options_new(gint argc, gchar* argv[]) {
     if(options->heartbeatLogLevelInput == NULL) {
         options->heartbeatLogLevelInput = g_strdup("message");
     }
+    if(options->logCompressionInput == NULL) {
+        options->logCompressionInput = g_strdup("none");
+    }
+    if(options->logFlushPolicyInput == NULL) {
+        options->logFlushPolicyInput = g_strdup("sync");
+    }
+    if(options->logCompressionBlockSize < 0) {
+        options->logCompressionBlockSize = 0;
+    }
     if(options->heartbeatLogInfo == NULL) {
         options->heartbeatLogInfo = g_strdup("node");
     }
+    if(options->heartbeatFormatInput == NULL) {
+        options->heartbeatFormatInput = g_strdup("log");
+    }
     if(options->heartbeatInterval < 1) {
         options->heartbeatInterval = 1;
     }
@@ -230,11 +269,15 @@ void options_free(Options* options) {
         g_string_free(options->inputXMLFilename, TRUE);
     }
     g_free(options->logLevelInput);
+    g_free(options->logCompressionInput);
+    g_free(options->logFlushPolicyInput);
     g_free(options->heartbeatLogLevelInput);
     g_free(options->heartbeatLogInfo);
+    g_free(options->heartbeatFormatInput);
     g_free(options->interfaceQueuingDiscipline);
     g_free(options->eventSchedulingPolicy);
     g_free(options->tcpCongestionControl);
+    g_free(options->statsSocketPath);
     if(options->argstr) {
         g_free(options->argstr);
     }
@@ -260,6 +303,34 @@ LogLevel options_getLogLevel(Options* options) {
     return loglevel_fromStr(options->logLevelInput);
 }
 
+LogCompression options_getLogCompression(Options* options) {
+    MAGIC_ASSERT(options);
+    return logcompression_fromStr(options->logCompressionInput);
+}
+
+const gchar* options_getLogCompressionString(Options* options) {
+    MAGIC_ASSERT(options);
+    return options->logCompressionInput;
+}
+
+gint options_getLogCompressionLevel(Options* options) {
+    MAGIC_ASSERT(options);
+    return options->logCompressionLevel;
+}
+
+gsize options_getLogCompressionBlockSize(Options* options) {
+    MAGIC_ASSERT(options);
+    return (gsize)options->logCompressionBlockSize;
+}
+
+LogFlushPolicy options_getLogFlushPolicy(Options* options) {
+    MAGIC_ASSERT(options);
+    if(options->logFlushPolicyInput && !g_ascii_strcasecmp(options->logFlushPolicyInput, "block")) {
+        return LOG_FLUSH_BLOCK;
+    }
+    return LOG_FLUSH_SYNC;
+}
+
 LogLevel options_getHeartbeatLogLevel(Options* options) {
     MAGIC_ASSERT(options);
     const gchar* l = (const gchar*) options->heartbeatLogLevelInput;
@@ -297,6 +368,22 @@ LogInfoFlags options_getHeartbeatLogInfo(Options* options) {
     return options_toHeartbeatLogInfo(options, options->heartbeatLogInfo);
 }
 
+HeartbeatFormat options_toHeartbeatFormat(Options* options, const gchar* input) {
+    if(input) {
+        if(!g_ascii_strcasecmp(input, "csv")) {
+            return HEARTBEAT_FORMAT_CSV;
+        } else if(g_ascii_strcasecmp(input, "log")) {
+            warning("Did not recognize heartbeat format '%s', possible choices are 'log','csv'.", input);
+        }
+    }
+    return HEARTBEAT_FORMAT_LOG;
+}
+
+HeartbeatFormat options_getHeartbeatFormat(Options* options) {
+    MAGIC_ASSERT(options);
+    return options_toHeartbeatFormat(options, options->heartbeatFormatInput);
+}
+
 QDiscMode options_getQueuingDiscipline(Options* options) {
     MAGIC_ASSERT(options);
 
@@ -336,6 +423,36 @@ gboolean options_doRunPrintVersion(Options* options) {
     return options->printSoftwareVersion;
 }
 
+gboolean options_doRunPerfCounters(Options* options) {
+    MAGIC_ASSERT(options);
+    return options->perfCounters;
+}
+
+gboolean options_doRunSchedulerTrace(Options* options) {
+    MAGIC_ASSERT(options);
+    return options->schedulerTrace;
+}
+
+const gchar* options_getStatsSocketPath(Options* options) {
+    MAGIC_ASSERT(options);
+    return options->statsSocketPath;
+}
+
+gboolean options_doRunTaskProfile(Options* options) {
+    MAGIC_ASSERT(options);
+    return options->taskProfile;
+}
+
+gboolean options_doRunTaskProfileFolded(Options* options) {
+    MAGIC_ASSERT(options);
+    return options->taskProfileFolded;
+}
+
+guint options_getTaskProfileInterval(Options* options) {
+    MAGIC_ASSERT(options);
+    return (guint)MAX(options->taskProfileInterval, 0);
+}
+
 gboolean options_doRunValgrind(Options* options) {
     MAGIC_ASSERT(options);
     return options->runValgrind;
@@ -391,6 +508,11 @@ gint options_getTCPSlowStartThreshold(Options* options) {
     return options->tcpSlowStartThreshold;
 }
 
+gboolean options_doTCPDelayedAck(Options* options) {
+    MAGIC_ASSERT(options);
+    return options->tcpDelayedAck;
+}
+
 SimulationTime options_getInterfaceBatchTime(Options* options) {
     MAGIC_ASSERT(options);
     return options->interfaceBatchTime;
@@ -401,6 +523,11 @@ gint options_getInterfaceBufferSize(Options* options) {
     return options->interfaceBufferSize;
 }
 
+gint options_getHostArenaSize(Options* options) {
+    MAGIC_ASSERT(options);
+    return options->hostArenaSize;
+}
+
 gint options_getSocketReceiveBufferSize(Options* options) {
     MAGIC_ASSERT(options);
     return options->initialSocketReceiveBufferSize;
@@ -26,6 +26,11 @@ enum _LogInfoFlags {
     LOG_INFO_FLAGS_RAM = 1<<2,
 };
 
+typedef enum _HeartbeatFormat HeartbeatFormat;
+enum _HeartbeatFormat {
+    HEARTBEAT_FORMAT_LOG, HEARTBEAT_FORMAT_CSV,
+};
+
 typedef enum _QDiscMode QDiscMode;
 enum _QDiscMode {
     QDISC_MODE_NONE=0, QDISC_MODE_FIFO=1, QDISC_MODE_RR=2,
@@ -61,6 +66,16 @@ void options_free(Options* options);
 LogLevel options_getLogLevel(Options* options);
 LogLevel options_getHeartbeatLogLevel(Options* options);
 
+/**
+ * Get how the logger should compress its output, as parsed from command line
+ * input. A block size of 0 means to use the default.
+ */
+LogCompression options_getLogCompression(Options* options);
+const gchar* options_getLogCompressionString(Options* options);
+gint options_getLogCompressionLevel(Options* options);
+gsize options_getLogCompressionBlockSize(Options* options);
+LogFlushPolicy options_getLogFlushPolicy(Options* options);
+
 /**
  * Get the configured log level at which heartbeat messages are printed,
  * based on command line input.
@@ -72,6 +87,12 @@ LogLevel options_getHeartbeatLogLevel(Options* options);
 LogInfoFlags options_toHeartbeatLogInfo(Options* options, const gchar* input);
 LogInfoFlags options_getHeartbeatLogInfo(Options* options);
 
+/**
+ * Get whether heartbeats are logged or written as csv files per host.
+ */
+HeartbeatFormat options_toHeartbeatFormat(Options* options, const gchar* input);
+HeartbeatFormat options_getHeartbeatFormat(Options* options);
+
 /**
  * Get the configured heartbeat printing interval.
  * @param config a #Configuration object created with configuration_new()
@@ -97,6 +118,12 @@ const gchar* options_getPreloadString(Options* options);
 guint options_getRandomSeed(Options* options);
 
 gboolean options_doRunPrintVersion(Options* options);
+gboolean options_doRunPerfCounters(Options* options);
+gboolean options_doRunSchedulerTrace(Options* options);
+const gchar* options_getStatsSocketPath(Options* options);
+gboolean options_doRunTaskProfile(Options* options);
+gboolean options_doRunTaskProfileFolded(Options* options);
+guint options_getTaskProfileInterval(Options* options);
 gboolean options_doRunValgrind(Options* options);
 gboolean options_doRunDebug(Options* options);
 gboolean options_doRunTGenExample(Options* options);
@@ -109,8 +136,10 @@ gint options_getMinRunAhead(Options* options);
 gint options_getTCPWindow(Options* options);
 const gchar* options_getTCPCongestionControl(Options* options);
 gint options_getTCPSlowStartThreshold(Options* options);
+gboolean options_doTCPDelayedAck(Options* options);
 SimulationTime options_getInterfaceBatchTime(Options* options);
 gint options_getInterfaceBufferSize(Options* options);
+gint options_getHostArenaSize(Options* options);
 gint options_getSocketReceiveBufferSize(Options* options);
 gint options_getSocketSendBufferSize(Options* options);
 gboolean options_doAutotuneReceiveBuffer(Options* options);
@@ -0,0 +1,149 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "shadow.h"
+
+struct _PerfCounters {
+    /* one file descriptor per counter, or -1 if it could not be opened */
+    gint fds[PERF_COUNTER_NUM_TYPES];
+    PerfCounterValues last;
+    MAGIC_DECLARE;
+};
+
+static gint _perfcounters_open(PerfCounterType type) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(struct perf_event_attr));
+    attr.size = sizeof(struct perf_event_attr);
+
+    switch(type) {
+        case PERF_COUNTER_CYCLES: {
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        }
+        case PERF_COUNTER_INSTRUCTIONS: {
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        }
+        case PERF_COUNTER_CACHE_MISSES: {
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        }
+        case PERF_COUNTER_CONTEXT_SWITCHES: {
+            attr.type = PERF_TYPE_SOFTWARE;
+            attr.config = PERF_COUNT_SW_CONTEXT_SWITCHES;
+            break;
+        }
+        default: {
+            return -1;
+        }
+    }
+
+    /* user space only for the hardware counters, so that unprivileged users can
+     * open them. context switches happen in the kernel, so try to include it. */
+    attr.exclude_kernel = (attr.type == PERF_TYPE_HARDWARE) ? 1 : 0;
+    attr.exclude_hv = 1;
+
+    /* count the calling thread on whatever cpu it runs */
+    gint fd = (gint)syscall(__NR_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    if(fd < 0 && !attr.exclude_kernel) {
+        attr.exclude_kernel = 1;
+        fd = (gint)syscall(__NR_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    }
+    if(fd < 0) {
+        info("unable to open the '%s' performance counter: %s", perfcountertype_toStr(type), g_strerror(errno));
+    }
+    return fd;
+}
+
+static guint64 _perfcounters_read(PerfCounters* counters, PerfCounterType type) {
+    guint64 value = 0;
+    if(counters->fds[type] >= 0) {
+        if(read(counters->fds[type], &value, sizeof(guint64)) != sizeof(guint64)) {
+            value = counters->last.values[type];
+        }
+    }
+    return value;
+}
+
+PerfCounters* perfcounters_new() {
+    PerfCounters* counters = g_new0(PerfCounters, 1);
+    MAGIC_INIT(counters);
+
+    gboolean isAnyOpen = FALSE;
+    for(gint i = 0; i < PERF_COUNTER_NUM_TYPES; i++) {
+        counters->fds[i] = _perfcounters_open((PerfCounterType)i);
+        if(counters->fds[i] >= 0) {
+            isAnyOpen = TRUE;
+        }
+    }
+
+    if(!isAnyOpen) {
+        perfcounters_free(counters);
+        return NULL;
+    }
+
+    for(gint i = 0; i < PERF_COUNTER_NUM_TYPES; i++) {
+        counters->last.values[i] = _perfcounters_read(counters, (PerfCounterType)i);
+    }
+
+    return counters;
+}
+
+void perfcounters_free(PerfCounters* counters) {
+    MAGIC_ASSERT(counters);
+
+    for(gint i = 0; i < PERF_COUNTER_NUM_TYPES; i++) {
+        if(counters->fds[i] >= 0) {
+            close(counters->fds[i]);
+        }
+    }
+
+    MAGIC_CLEAR(counters);
+    g_free(counters);
+}
+
+void perfcounters_sample(PerfCounters* counters, PerfCounterValues* delta) {
+    MAGIC_ASSERT(counters);
+    utility_assert(delta);
+
+    for(gint i = 0; i < PERF_COUNTER_NUM_TYPES; i++) {
+        guint64 value = _perfcounters_read(counters, (PerfCounterType)i);
+        delta->values[i] = (value >= counters->last.values[i]) ? value - counters->last.values[i] : 0;
+        counters->last.values[i] = value;
+    }
+}
+
+gboolean perfcounters_isAvailable(PerfCounters* counters, PerfCounterType type) {
+    MAGIC_ASSERT(counters);
+    return (type < PERF_COUNTER_NUM_TYPES && counters->fds[type] >= 0) ? TRUE : FALSE;
+}
+
+const gchar* perfcountertype_toStr(PerfCounterType type) {
+    switch(type) {
+        case PERF_COUNTER_CYCLES:
+            return "cycles";
+        case PERF_COUNTER_INSTRUCTIONS:
+            return "instructions";
+        case PERF_COUNTER_CACHE_MISSES:
+            return "cache-misses";
+        case PERF_COUNTER_CONTEXT_SWITCHES:
+            return "context-switches";
+        default:
+            return "unknown";
+    }
+}
+
+void perfcountervalues_add(PerfCounterValues* values, const PerfCounterValues* increment) {
+    utility_assert(values && increment);
+    for(gint i = 0; i < PERF_COUNTER_NUM_TYPES; i++) {
+        values->values[i] += increment->values[i];
+    }
+}
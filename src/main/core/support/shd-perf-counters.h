@@ -0,0 +1,39 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#ifndef SRC_MAIN_CORE_SUPPORT_SHD_PERF_COUNTERS_H_
+#define SRC_MAIN_CORE_SUPPORT_SHD_PERF_COUNTERS_H_
+
+typedef enum _PerfCounterType PerfCounterType;
+enum _PerfCounterType {
+    PERF_COUNTER_CYCLES,
+    PERF_COUNTER_INSTRUCTIONS,
+    PERF_COUNTER_CACHE_MISSES,
+    PERF_COUNTER_CONTEXT_SWITCHES,
+    PERF_COUNTER_NUM_TYPES,
+};
+
+/* counter values, or the difference between two readings */
+typedef struct _PerfCounterValues PerfCounterValues;
+struct _PerfCounterValues {
+    guint64 values[PERF_COUNTER_NUM_TYPES];
+};
+
+/* hardware and kernel counters for the thread that created them */
+typedef struct _PerfCounters PerfCounters;
+
+/* opens the counters for the calling thread. returns NULL if none of them
+ * could be opened, e.g., because of the kernel's perf_event_paranoid setting */
+PerfCounters* perfcounters_new();
+void perfcounters_free(PerfCounters* counters);
+
+/* stores in 'delta' how much each counter advanced since the last sample */
+void perfcounters_sample(PerfCounters* counters, PerfCounterValues* delta);
+gboolean perfcounters_isAvailable(PerfCounters* counters, PerfCounterType type);
+
+const gchar* perfcountertype_toStr(PerfCounterType type);
+void perfcountervalues_add(PerfCounterValues* values, const PerfCounterValues* increment);
+
+#endif /* SRC_MAIN_CORE_SUPPORT_SHD_PERF_COUNTERS_H_ */
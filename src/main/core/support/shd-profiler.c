@@ -0,0 +1,306 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include "shadow.h"
+
+typedef struct _ProfilerEntry ProfilerEntry;
+struct _ProfilerEntry {
+    /* the key, the task names are string literals and never freed */
+    GQuark hostID;
+    const gchar* taskName;
+
+    guint64 count;
+    guint64 totalNanos;
+    guint64 pluginNanos;
+};
+
+struct _Profiler {
+    /* ProfilerEntry* keyed by itself */
+    GHashTable* entries;
+
+    /* the task being timed, if any */
+    ProfilerEntry* current;
+    guint64 taskStartNanos;
+    /* nonzero while the current task is executing plugin code */
+    guint64 pluginStartNanos;
+
+    guint64 lastStopNanos;
+    guint64 lastDueNanos;
+
+    GString* stringBuffer;
+
+    MAGIC_DECLARE;
+};
+
+static guint64 _profiler_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((guint64)ts.tv_sec * SIMTIME_ONE_SECOND) + (guint64)ts.tv_nsec;
+}
+
+static guint _profilerentry_hash(const ProfilerEntry* entry) {
+    return (entry->hostID * 31) ^ g_str_hash(entry->taskName);
+}
+
+static gboolean _profilerentry_equal(const ProfilerEntry* a, const ProfilerEntry* b) {
+    return a->hostID == b->hostID &&
+            (a->taskName == b->taskName || g_str_equal(a->taskName, b->taskName));
+}
+
+Profiler* profiler_new() {
+    Profiler* profiler = g_new0(Profiler, 1);
+    MAGIC_INIT(profiler);
+
+    profiler->entries = g_hash_table_new_full((GHashFunc)_profilerentry_hash,
+            (GEqualFunc)_profilerentry_equal, g_free, NULL);
+    profiler->lastDueNanos = _profiler_now();
+
+    return profiler;
+}
+
+void profiler_free(Profiler* profiler) {
+    MAGIC_ASSERT(profiler);
+
+    g_hash_table_destroy(profiler->entries);
+    if(profiler->stringBuffer) {
+        g_string_free(profiler->stringBuffer, TRUE);
+    }
+
+    MAGIC_CLEAR(profiler);
+    g_free(profiler);
+}
+
+static ProfilerEntry* _profiler_getEntry(Profiler* profiler, GQuark hostID, const gchar* taskName) {
+    ProfilerEntry lookup = {hostID, taskName, 0, 0, 0};
+    ProfilerEntry* entry = g_hash_table_lookup(profiler->entries, &lookup);
+    if(!entry) {
+        entry = g_new0(ProfilerEntry, 1);
+        entry->hostID = hostID;
+        entry->taskName = taskName;
+        g_hash_table_add(profiler->entries, entry);
+    }
+    return entry;
+}
+
+void profiler_startTask(Profiler* profiler, GQuark hostID, const gchar* taskName) {
+    MAGIC_ASSERT(profiler);
+    utility_assert(profiler->current == NULL);
+
+    profiler->current = _profiler_getEntry(profiler, hostID, taskName ? taskName : "unknown");
+    profiler->pluginStartNanos = 0;
+    profiler->taskStartNanos = _profiler_now();
+}
+
+void profiler_stopTask(Profiler* profiler) {
+    MAGIC_ASSERT(profiler);
+    if(!profiler->current) {
+        return;
+    }
+
+    guint64 now = _profiler_now();
+
+    /* a task may finish while a plugin thread is still marked as running */
+    if(profiler->pluginStartNanos > 0) {
+        profiler->current->pluginNanos += now - profiler->pluginStartNanos;
+        profiler->pluginStartNanos = 0;
+    }
+
+    profiler->current->count++;
+    profiler->current->totalNanos += now - profiler->taskStartNanos;
+    profiler->current = NULL;
+    profiler->lastStopNanos = now;
+}
+
+void profiler_enterPlugin(Profiler* profiler) {
+    MAGIC_ASSERT(profiler);
+    if(profiler->current && profiler->pluginStartNanos == 0) {
+        profiler->pluginStartNanos = _profiler_now();
+    }
+}
+
+void profiler_exitPlugin(Profiler* profiler) {
+    MAGIC_ASSERT(profiler);
+    if(profiler->current && profiler->pluginStartNanos > 0) {
+        profiler->current->pluginNanos += _profiler_now() - profiler->pluginStartNanos;
+        profiler->pluginStartNanos = 0;
+    }
+}
+
+gboolean profiler_isDue(Profiler* profiler, guint intervalSeconds) {
+    MAGIC_ASSERT(profiler);
+    if(intervalSeconds == 0) {
+        return FALSE;
+    }
+    /* reuse the time taken when the last task stopped instead of asking the clock again */
+    if(profiler->lastStopNanos >= profiler->lastDueNanos + ((guint64)intervalSeconds * SIMTIME_ONE_SECOND)) {
+        profiler->lastDueNanos = profiler->lastStopNanos;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+void profiler_takeAll(Profiler* profiler, Profiler* increment) {
+    MAGIC_ASSERT(profiler);
+    MAGIC_ASSERT(increment);
+
+    GHashTableIter iter;
+    gpointer key = NULL;
+    g_hash_table_iter_init(&iter, increment->entries);
+    while(g_hash_table_iter_next(&iter, &key, NULL)) {
+        ProfilerEntry* source = key;
+        if(source->count == 0) {
+            continue;
+        }
+
+        ProfilerEntry* entry = _profiler_getEntry(profiler, source->hostID, source->taskName);
+        entry->count += source->count;
+        entry->totalNanos += source->totalNanos;
+        entry->pluginNanos += source->pluginNanos;
+
+        /* keep the entry so the running task, if any, stays valid */
+        source->count = 0;
+        source->totalNanos = 0;
+        source->pluginNanos = 0;
+    }
+}
+
+static gint _profilerentry_compareTotal(const ProfilerEntry* a, const ProfilerEntry* b) {
+    return (a->totalNanos < b->totalNanos) ? 1 : (a->totalNanos > b->totalNanos) ? -1 : 0;
+}
+
+/* sums entries into a new table keyed by host or task, and returns them busiest first */
+static GList* _profiler_groupBy(Profiler* profiler, gboolean byHost, GHashTable** groupsOut) {
+    GHashTable* groups = g_hash_table_new_full((GHashFunc)_profilerentry_hash,
+            (GEqualFunc)_profilerentry_equal, g_free, NULL);
+
+    GHashTableIter iter;
+    gpointer key = NULL;
+    g_hash_table_iter_init(&iter, profiler->entries);
+    while(g_hash_table_iter_next(&iter, &key, NULL)) {
+        ProfilerEntry* source = key;
+        ProfilerEntry lookup = {byHost ? source->hostID : 0, byHost ? "" : source->taskName, 0, 0, 0};
+        ProfilerEntry* group = g_hash_table_lookup(groups, &lookup);
+        if(!group) {
+            group = g_memdup(&lookup, sizeof(ProfilerEntry));
+            g_hash_table_add(groups, group);
+        }
+        group->count += source->count;
+        group->totalNanos += source->totalNanos;
+        group->pluginNanos += source->pluginNanos;
+    }
+
+    *groupsOut = groups;
+    return g_list_sort(g_hash_table_get_keys(groups), (GCompareFunc)_profilerentry_compareTotal);
+}
+
+static void _profiler_appendGroups(GString* buffer, GList* groups, gboolean byHost, guint maxItems) {
+    guint i = 0;
+    for(GList* item = groups; item != NULL && i < maxItems; item = item->next, i++) {
+        ProfilerEntry* group = item->data;
+        g_string_append_printf(buffer, "%s%s=%.3fs/%"G_GUINT64_FORMAT"/%.1f%%",
+                (i > 0) ? "," : "",
+                byHost ? (group->hostID ? g_quark_to_string(group->hostID) : "none") : group->taskName,
+                ((gdouble)group->totalNanos) / SIMTIME_ONE_SECOND, group->count,
+                group->totalNanos ? (100.0f * group->pluginNanos) / group->totalNanos : 0.0f);
+    }
+}
+
+const gchar* profiler_summaryToString(Profiler* profiler, guint maxItems) {
+    MAGIC_ASSERT(profiler);
+
+    if(!profiler->stringBuffer) {
+        profiler->stringBuffer = g_string_new(NULL);
+    }
+
+    guint64 count = 0, totalNanos = 0, pluginNanos = 0;
+    GHashTableIter iter;
+    gpointer key = NULL;
+    g_hash_table_iter_init(&iter, profiler->entries);
+    while(g_hash_table_iter_next(&iter, &key, NULL)) {
+        ProfilerEntry* entry = key;
+        count += entry->count;
+        totalNanos += entry->totalNanos;
+        pluginNanos += entry->pluginNanos;
+    }
+
+    g_string_printf(profiler->stringBuffer,
+            "task profile: %"G_GUINT64_FORMAT" tasks in %.3f seconds, %.1f%% in plugins; "
+            "busiest tasks (seconds/count/plugin): ",
+            count, ((gdouble)totalNanos) / SIMTIME_ONE_SECOND,
+            totalNanos ? (100.0f * pluginNanos) / totalNanos : 0.0f);
+
+    GHashTable* groups = NULL;
+    GList* sorted = _profiler_groupBy(profiler, FALSE, &groups);
+    _profiler_appendGroups(profiler->stringBuffer, sorted, FALSE, maxItems);
+    g_list_free(sorted);
+    g_hash_table_destroy(groups);
+
+    g_string_append(profiler->stringBuffer, "; busiest hosts: ");
+
+    sorted = _profiler_groupBy(profiler, TRUE, &groups);
+    _profiler_appendGroups(profiler->stringBuffer, sorted, TRUE, maxItems);
+    g_list_free(sorted);
+    g_hash_table_destroy(groups);
+
+    return profiler->stringBuffer->str;
+}
+
+gboolean profiler_writeCSV(Profiler* profiler, const gchar* path) {
+    MAGIC_ASSERT(profiler);
+
+    FILE* file = fopen(path, "w");
+    if(!file) {
+        warning("unable to open task profile file '%s': %s", path, g_strerror(errno));
+        return FALSE;
+    }
+
+    fprintf(file, "host,task,count,total-ns,plugin-ns,shadow-ns\n");
+
+    GList* entries = g_list_sort(g_hash_table_get_keys(profiler->entries),
+            (GCompareFunc)_profilerentry_compareTotal);
+    for(GList* item = entries; item != NULL; item = item->next) {
+        ProfilerEntry* entry = item->data;
+        fprintf(file, "%s,%s,%"G_GUINT64_FORMAT",%"G_GUINT64_FORMAT",%"G_GUINT64_FORMAT",%"G_GUINT64_FORMAT"\n",
+                entry->hostID ? g_quark_to_string(entry->hostID) : "none", entry->taskName,
+                entry->count, entry->totalNanos, entry->pluginNanos,
+                entry->totalNanos - MIN(entry->pluginNanos, entry->totalNanos));
+    }
+    g_list_free(entries);
+
+    fclose(file);
+    return TRUE;
+}
+
+gboolean profiler_writeFolded(Profiler* profiler, const gchar* path) {
+    MAGIC_ASSERT(profiler);
+
+    FILE* file = fopen(path, "w");
+    if(!file) {
+        warning("unable to open folded task profile file '%s': %s", path, g_strerror(errno));
+        return FALSE;
+    }
+
+    GHashTableIter iter;
+    gpointer key = NULL;
+    g_hash_table_iter_init(&iter, profiler->entries);
+    while(g_hash_table_iter_next(&iter, &key, NULL)) {
+        ProfilerEntry* entry = key;
+        const gchar* hostName = entry->hostID ? g_quark_to_string(entry->hostID) : "none";
+        guint64 pluginMicros = entry->pluginNanos / 1000;
+        guint64 shadowMicros = (entry->totalNanos - MIN(entry->pluginNanos, entry->totalNanos)) / 1000;
+
+        if(shadowMicros > 0) {
+            fprintf(file, "%s;%s;shadow %"G_GUINT64_FORMAT"\n", hostName, entry->taskName, shadowMicros);
+        }
+        if(pluginMicros > 0) {
+            fprintf(file, "%s;%s;plugin %"G_GUINT64_FORMAT"\n", hostName, entry->taskName, pluginMicros);
+        }
+    }
+
+    fclose(file);
+    return TRUE;
+}
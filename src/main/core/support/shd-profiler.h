@@ -0,0 +1,42 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#ifndef SRC_MAIN_CORE_SUPPORT_SHD_PROFILER_H_
+#define SRC_MAIN_CORE_SUPPORT_SHD_PROFILER_H_
+
+/* attributes the real time spent executing tasks to the host and the task
+ * callback that ran, and splits it into time in plugin and in shadow code.
+ * each worker owns one profiler, so none of these functions lock. */
+typedef struct _Profiler Profiler;
+
+Profiler* profiler_new();
+void profiler_free(Profiler* profiler);
+
+/* starts and stops timing a task for the given host. tasks do not nest. */
+void profiler_startTask(Profiler* profiler, GQuark hostID, const gchar* taskName);
+void profiler_stopTask(Profiler* profiler);
+
+/* marks the boundaries of plugin code within the currently timed task */
+void profiler_enterPlugin(Profiler* profiler);
+void profiler_exitPlugin(Profiler* profiler);
+
+/* returns TRUE if the last stopped task ended at least 'intervalSeconds'
+ * after the previous time this returned TRUE */
+gboolean profiler_isDue(Profiler* profiler, guint intervalSeconds);
+
+/* add all entries from 'increment' into 'profiler', and reset 'increment' */
+void profiler_takeAll(Profiler* profiler, Profiler* increment);
+
+/* returns a summary of the busiest tasks and hosts that can be logged.
+ * the string is owned by the profiler, and should not be freed by the caller. */
+const gchar* profiler_summaryToString(Profiler* profiler, guint maxItems);
+
+/* writes one 'host,task,count,total-ns,plugin-ns,shadow-ns' line per entry */
+gboolean profiler_writeCSV(Profiler* profiler, const gchar* path);
+/* writes stacks as 'host;task;plugin|shadow microseconds', the folded
+ * format read by flamegraph.pl and similar tools */
+gboolean profiler_writeFolded(Profiler* profiler, const gchar* path);
+
+#endif /* SRC_MAIN_CORE_SUPPORT_SHD_PROFILER_H_ */
@@ -0,0 +1,175 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#include "shadow.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+struct _StatsServer {
+    gchar* socketPath;
+    gint listenFD;
+    /* written to when the server thread should stop */
+    gint stopPipe[2];
+
+    StatsServerCollectFunc collect;
+    gpointer userData;
+
+    pthread_t thread;
+    gboolean isThreadRunning;
+    MAGIC_DECLARE;
+};
+
+static void _statsserver_answer(StatsServer* server, gint clientFD) {
+    /* a client that stops reading must not hold up the next one forever */
+    struct timeval timeout = {.tv_sec = 1, .tv_usec = 0};
+    setsockopt(clientFD, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    GString* stats = server->collect(server->userData);
+
+    gsize offset = 0;
+    while(offset < stats->len) {
+        ssize_t n = send(clientFD, stats->str + offset, stats->len - offset, MSG_NOSIGNAL);
+        if(n < 0 && errno == EINTR) {
+            continue;
+        } else if(n <= 0) {
+            break;
+        }
+        offset += (gsize)n;
+    }
+
+    g_string_free(stats, TRUE);
+}
+
+/* this thread is not registered with the logger, so it must not use the log macros */
+static gpointer _statsserver_run(StatsServer* server) {
+    MAGIC_ASSERT(server);
+
+    struct pollfd fds[2];
+    fds[0].fd = server->listenFD;
+    fds[0].events = POLLIN;
+    fds[1].fd = server->stopPipe[0];
+    fds[1].events = POLLIN;
+
+    while(TRUE) {
+        fds[0].revents = 0;
+        fds[1].revents = 0;
+
+        if(poll(fds, 2, -1) < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            g_printerr("** Stats server stopped, poll() failed: %s\n", g_strerror(errno));
+            break;
+        }
+
+        if(fds[1].revents) {
+            break;
+        }
+
+        if(fds[0].revents & POLLIN) {
+            gint clientFD = accept4(server->listenFD, NULL, NULL, SOCK_CLOEXEC);
+            if(clientFD >= 0) {
+                _statsserver_answer(server, clientFD);
+                close(clientFD);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+StatsServer* statsserver_new(const gchar* socketPath, StatsServerCollectFunc collect, gpointer userData) {
+    utility_assert(socketPath && collect);
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(struct sockaddr_un));
+    address.sun_family = AF_UNIX;
+    if(strlen(socketPath) >= sizeof(address.sun_path)) {
+        warning("stats socket path '%s' is longer than the %u characters a UNIX socket allows",
+                socketPath, (guint)(sizeof(address.sun_path) - 1));
+        return NULL;
+    }
+    g_strlcpy(address.sun_path, socketPath, sizeof(address.sun_path));
+
+    gint listenFD = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(listenFD < 0) {
+        warning("unable to create the stats socket: %s", g_strerror(errno));
+        return NULL;
+    }
+
+    /* a socket left behind by an earlier run would make bind fail, but we
+     * never remove anything that is not a socket */
+    struct stat pathStat;
+    if(lstat(socketPath, &pathStat) == 0) {
+        if(!S_ISSOCK(pathStat.st_mode)) {
+            warning("refusing to replace '%s' with the stats socket, it exists and is not a socket", socketPath);
+            close(listenFD);
+            return NULL;
+        }
+        unlink(socketPath);
+    }
+
+    if(bind(listenFD, (struct sockaddr*)&address, sizeof(struct sockaddr_un)) < 0 ||
+            listen(listenFD, SOMAXCONN) < 0) {
+        warning("unable to listen on the stats socket '%s': %s", socketPath, g_strerror(errno));
+        close(listenFD);
+        return NULL;
+    }
+
+    StatsServer* server = g_new0(StatsServer, 1);
+    MAGIC_INIT(server);
+
+    server->socketPath = g_strdup(socketPath);
+    server->listenFD = listenFD;
+    server->collect = collect;
+    server->userData = userData;
+
+    if(pipe2(server->stopPipe, O_CLOEXEC) < 0) {
+        warning("unable to create the stats server's pipe: %s", g_strerror(errno));
+        server->stopPipe[0] = server->stopPipe[1] = -1;
+        statsserver_free(server);
+        return NULL;
+    }
+
+    gint returnVal = pthread_create(&(server->thread), NULL, (void*(*)(void*))_statsserver_run, server);
+    if(returnVal != 0) {
+        warning("unable to start the stats server thread: error %i", returnVal);
+        statsserver_free(server);
+        return NULL;
+    }
+    server->isThreadRunning = TRUE;
+
+    pthread_setname_np(server->thread, "stats-server");
+
+    message("answering with live statistics on UNIX socket '%s'", socketPath);
+
+    return server;
+}
+
+void statsserver_free(StatsServer* server) {
+    MAGIC_ASSERT(server);
+
+    if(server->isThreadRunning) {
+        gchar stop = 1;
+        while(write(server->stopPipe[1], &stop, 1) < 0 && errno == EINTR);
+        pthread_join(server->thread, NULL);
+    }
+
+    if(server->stopPipe[0] >= 0) {
+        close(server->stopPipe[0]);
+    }
+    if(server->stopPipe[1] >= 0) {
+        close(server->stopPipe[1]);
+    }
+
+    close(server->listenFD);
+    unlink(server->socketPath);
+    g_free(server->socketPath);
+
+    MAGIC_CLEAR(server);
+    g_free(server);
+}
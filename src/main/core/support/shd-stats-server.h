@@ -0,0 +1,22 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#ifndef SRC_MAIN_CORE_SUPPORT_SHD_STATS_SERVER_H_
+#define SRC_MAIN_CORE_SUPPORT_SHD_STATS_SERVER_H_
+
+/* returns a newly allocated string that the server sends and then frees.
+ * this is called from the server's own thread. */
+typedef GString* (*StatsServerCollectFunc)(gpointer userData);
+
+/* answers every connection to a local UNIX socket with the current statistics
+ * and then closes it, so they can be read with, e.g., 'socat - UNIX-CONNECT:PATH' */
+typedef struct _StatsServer StatsServer;
+
+/* returns NULL if the socket could not be created at 'socketPath' */
+StatsServer* statsserver_new(const gchar* socketPath, StatsServerCollectFunc collect, gpointer userData);
+/* stops the server thread and removes the socket */
+void statsserver_free(StatsServer* server);
+
+#endif /* SRC_MAIN_CORE_SUPPORT_SHD_STATS_SERVER_H_ */
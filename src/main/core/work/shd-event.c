@@ -74,7 +74,9 @@ void event_execute(Event* event) {
     } else {
         /* cpu is not blocked, its ok to execute the event */
         host_continueExecutionTimer(event->dstHost);
+        worker_startTaskProfile(task_getName(event->task));
         task_execute(event->task);
+        worker_stopTaskProfile();
         host_stopExecutionTimer(event->dstHost);
     }
 
@@ -7,6 +7,7 @@
 
 struct _Task {
     TaskCallbackFunc execute;
+    const gchar* name;
     gpointer callbackObject;
     gpointer callbackArgument;
     TaskObjectFreeFunc objectFree;
@@ -16,13 +17,19 @@ struct _Task {
 };
 
 
-Task* task_new(TaskCallbackFunc callback, gpointer callbackObject, gpointer callbackArgument,
-        TaskObjectFreeFunc objectFree, TaskArgumentFreeFunc argumentFree) {
+Task* task_new_(TaskCallbackFunc callback, const gchar* callbackName, gpointer callbackObject,
+        gpointer callbackArgument, TaskObjectFreeFunc objectFree, TaskArgumentFreeFunc argumentFree) {
     utility_assert(callback != NULL);
 
     Task* task = g_new0(Task, 1);
 
     task->execute = callback;
+    /* drop the cast, if any, that the caller put in front of the function name */
+    const gchar* castEnd = callbackName ? strrchr(callbackName, ')') : NULL;
+    task->name = castEnd ? castEnd + 1 : callbackName;
+    while(task->name && g_ascii_isspace(*task->name)) {
+        task->name++;
+    }
     task->callbackObject = callbackObject;
     task->callbackArgument = callbackArgument;
     task->objectFree = objectFree;
@@ -64,3 +71,8 @@ void task_execute(Task* task) {
     MAGIC_ASSERT(task);
     task->execute(task->callbackObject, task->callbackArgument);
 }
+
+const gchar* task_getName(Task* task) {
+    MAGIC_ASSERT(task);
+    return task->name;
+}
@@ -15,10 +15,16 @@ typedef void (*TaskArgumentFreeFunc)(gpointer data);
  * (These are non-packet events for localhost.) */
 typedef struct _Task Task;
 
-Task* task_new(TaskCallbackFunc callback, gpointer callbackObject, gpointer callbackArgument,
-        TaskObjectFreeFunc objectFree, TaskArgumentFreeFunc argumentFree);
+/* the callback expression is kept as the task name so the profiler can
+ * attribute time to the kind of work that a task does */
+#define task_new(callback, callbackObject, callbackArgument, objectFree, argumentFree) \
+    task_new_((callback), #callback, (callbackObject), (callbackArgument), (objectFree), (argumentFree))
+
+Task* task_new_(TaskCallbackFunc callback, const gchar* callbackName, gpointer callbackObject,
+        gpointer callbackArgument, TaskObjectFreeFunc objectFree, TaskArgumentFreeFunc argumentFree);
 void task_ref(Task* task);
 void task_unref(Task* task);
 void task_execute(Task* task);
+const gchar* task_getName(Task* task);
 
 #endif /* SHD_TASK_H_ */
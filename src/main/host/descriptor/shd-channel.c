@@ -48,7 +48,7 @@ static void channel_free(Channel* channel) {
     worker_countObject(OBJECT_TYPE_CHANNEL, COUNTER_TYPE_FREE);
 }
 
-static gssize channel_linkedWrite(Channel* channel, gconstpointer buffer, gsize nBytes) {
+static gssize channel_linkedWrite(Channel* channel, const struct iovec* iov, gint iovcnt, gsize nBytes) {
     MAGIC_ASSERT(channel);
     /* our linked channel is trying to send us data, make sure we can read it */
     utility_assert(!(channel->type & CT_WRITEONLY));
@@ -59,9 +59,17 @@ static gssize channel_linkedWrite(Channel* channel, gconstpointer buffer, gsize
         return (gssize)-1;
     }
 
-    /* accept some data from the other end of the pipe */
-    gsize copyLength = MIN(nBytes, available);
-    gsize numCopied = bytequeue_push(channel->buffer, buffer, copyLength);
+    /* accept some data from the other end of the pipe, straight out of each user buffer */
+    gsize remaining = MIN(nBytes, available);
+    gsize numCopied = 0;
+    for(gint i = 0; i < iovcnt && remaining > 0; i++) {
+        gsize copyLength = MIN(iov[i].iov_len, remaining);
+        if(copyLength > 0) {
+            gsize pushed = bytequeue_push(channel->buffer, iov[i].iov_base, copyLength);
+            numCopied += pushed;
+            remaining -= pushed;
+        }
+    }
     channel->bufferLength += numCopied;
 
     /* we just got some data in our buffer */
@@ -70,7 +78,8 @@ static gssize channel_linkedWrite(Channel* channel, gconstpointer buffer, gsize
     return (gssize)numCopied;
 }
 
-static gssize channel_sendUserData(Channel* channel, gconstpointer buffer, gsize nBytes, in_addr_t ip, in_port_t port) {
+static gssize channel_sendUserData(Channel* channel, const struct iovec* iov, gint iovcnt,
+        gsize nBytes, in_addr_t ip, in_port_t port) {
     MAGIC_ASSERT(channel);
     /* the read end of a unidirectional pipe can not write! */
     utility_assert(channel->type != CT_READONLY);
@@ -78,7 +87,7 @@ static gssize channel_sendUserData(Channel* channel, gconstpointer buffer, gsize
     gssize result = 0;
 
     if(channel->linkedChannel) {
-        result = channel_linkedWrite(channel->linkedChannel, buffer, nBytes);
+        result = channel_linkedWrite(channel->linkedChannel, iov, iovcnt, nBytes);
     } else {
         /* the other end closed or doesn't exist */
         result = -1;
@@ -93,7 +102,8 @@ static gssize channel_sendUserData(Channel* channel, gconstpointer buffer, gsize
     return result;
 }
 
-static gssize channel_receiveUserData(Channel* channel, gpointer buffer, gsize nBytes, in_addr_t* ip, in_port_t* port) {
+static gssize channel_receiveUserData(Channel* channel, const struct iovec* iov, gint iovcnt,
+        gsize nBytes, in_addr_t* ip, in_port_t* port) {
     MAGIC_ASSERT(channel);
     /* the write end of a unidirectional pipe can not read! */
     utility_assert(channel->type != CT_WRITEONLY);
@@ -110,9 +120,17 @@ static gssize channel_receiveUserData(Channel* channel, gpointer buffer, gsize n
         }
     }
 
-    /* accept some data from the other end of the pipe */
-    gsize copyLength = MIN(nBytes, available);
-    gsize numCopied = bytequeue_pop(channel->buffer, buffer, copyLength);
+    /* accept some data from the other end of the pipe, straight into each user buffer */
+    gsize remaining = MIN(nBytes, available);
+    gsize numCopied = 0;
+    for(gint i = 0; i < iovcnt && remaining > 0; i++) {
+        gsize copyLength = MIN(iov[i].iov_len, remaining);
+        if(copyLength > 0) {
+            gsize popped = bytequeue_pop(channel->buffer, iov[i].iov_base, copyLength);
+            numCopied += popped;
+            remaining -= popped;
+        }
+    }
     channel->bufferLength -= numCopied;
 
     /* we are no longer readable if we have nothing left */
@@ -170,3 +188,19 @@ Channel* channel_getLinkedChannel(Channel* channel) {
     MAGIC_ASSERT(channel);
     return channel->linkedChannel;
 }
+
+gsize channel_getInputBufferLength(Channel* channel) {
+    MAGIC_ASSERT(channel);
+    return channel->bufferLength;
+}
+
+gsize channel_getOutputBufferSpace(Channel* channel) {
+    MAGIC_ASSERT(channel);
+    /* we write straight into the buffer of our link */
+    if(channel->linkedChannel == NULL || (channel->type & CT_READONLY)) {
+        return 0;
+    }
+    Channel* linkedChannel = channel->linkedChannel;
+    utility_assert(linkedChannel->bufferSize >= linkedChannel->bufferLength);
+    return linkedChannel->bufferSize - linkedChannel->bufferLength;
+}
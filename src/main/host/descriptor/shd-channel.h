@@ -19,5 +19,7 @@ typedef struct _Channel Channel;
 Channel* channel_new(gint handle, ChannelType type);
 void channel_setLinkedChannel(Channel* channel, Channel* linkedChannel);
 Channel* channel_getLinkedChannel(Channel* channel);
+gsize channel_getInputBufferLength(Channel* channel);
+gsize channel_getOutputBufferSpace(Channel* channel);
 
 #endif /* SHD_CHANNEL_H_ */
@@ -38,6 +38,8 @@ enum _EpollWatchFlags {
     /* used to track that ONESHOT mode is used, an event was already reported, and the
      * socket has not been modified since. This prevents duplicate reporting in ONESHOT mode. */
     EWF_ONESHOT_REPORTED = 1 << 12,
+    /* set while the watch is linked into the epoll's ready list */
+    EWF_READYLISTED = 1 << 13,
 };
 
 typedef struct _EpollWatch EpollWatch;
@@ -48,6 +50,8 @@ struct _EpollWatch {
     struct epoll_event event;
     /* current status of the underlying shadow descriptor */
     EpollWatchFlags flags;
+    /* our node in the epoll's ready list, valid while EWF_READYLISTED is set */
+    GList readyLink;
     gint referenceCount;
     MAGIC_DECLARE;
 };
@@ -74,9 +78,14 @@ struct _Epoll {
 
     /* holds the wrappers for the descriptors we are watching for events */
     GHashTable* watching;
+    /* the watches that currently have events to report. it is updated whenever
+     * a watched descriptor's status changes, so we never scan all watches */
+    GQueue* ready;
 
     Process* ownerProcess;
+    /* the OS epoll is created on first use, and only queried if it has registrations */
     gint osEpollDescriptor;
+    gint osRegistrationCount;
 
     MAGIC_DECLARE;
 };
@@ -95,6 +104,7 @@ static EpollWatch* _epollwatch_new(Epoll* epoll, Descriptor* descriptor, struct
 
     watch->descriptor = descriptor;
     watch->event = *event;
+    watch->readyLink.data = watch;
     watch->referenceCount = 1;
 
     return watch;
@@ -102,6 +112,7 @@ static EpollWatch* _epollwatch_new(Epoll* epoll, Descriptor* descriptor, struct
 
 static void _epollwatch_free(EpollWatch* watch) {
     MAGIC_ASSERT(watch);
+    utility_assert(!(watch->flags & EWF_READYLISTED));
 
     descriptor_unref(watch->descriptor);
 
@@ -126,10 +137,20 @@ static void _epollwatch_unref(EpollWatch* watch) {
 static void _epoll_free(Epoll* epoll) {
     MAGIC_ASSERT(epoll);
 
+    /* the ready list links live inside the watches, so unlink them without freeing */
+    while(!g_queue_is_empty(epoll->ready)) {
+        GList* link = g_queue_pop_head_link(epoll->ready);
+        EpollWatch* watch = link->data;
+        watch->flags &= ~EWF_READYLISTED;
+    }
+    g_queue_free(epoll->ready);
+
     /* this unrefs all of the remaining watches */
     g_hash_table_destroy(epoll->watching);
 
-    close(epoll->osEpollDescriptor);
+    if(epoll->osEpollDescriptor >= 0) {
+        close(epoll->osEpollDescriptor);
+    }
 
     utility_assert(epoll->ownerProcess);
     process_unref(epoll->ownerProcess);
@@ -191,14 +212,11 @@ Epoll* epoll_new(gint handle) {
 
     /* allocate backend needed for managing events for this descriptor */
     epoll->watching = g_hash_table_new_full(g_int_hash, g_int_equal, NULL, (GDestroyNotify)_epollwatch_unref);
+    epoll->ready = g_queue_new();
 
-    /* the application may want us to watch some system files, so we need a
-     * real OS epoll fd so we can offload that task.
-     */
-    epoll->osEpollDescriptor = epoll_create(1000);
-    if(epoll->osEpollDescriptor == -1) {
-        warning("error in epoll_create for OS events, errno=%i msg:%s", errno, g_strerror(errno));
-    }
+    /* the application may want us to watch some system files, in which case
+     * we create a real OS epoll fd to offload that task in epoll_controlOS */
+    epoll->osEpollDescriptor = -1;
 
     /* keep track of which virtual application we need to notify of events
     epoll_new should be called as a result of an application syscall */
@@ -224,6 +242,8 @@ static void _epollwatch_updateStatus(EpollWatch* watch) {
     lazyFlags |= (watch->flags & EWF_WATCHING) ? EWF_WATCHING : EWF_NONE;
     lazyFlags |= (watch->flags & EWF_EDGETRIGGER_REPORTED) ? EWF_EDGETRIGGER_REPORTED : EWF_NONE;
     lazyFlags |= (watch->flags & EWF_ONESHOT_REPORTED) ? EWF_ONESHOT_REPORTED : EWF_NONE;
+    /* the ready list membership is owned by _epoll_updateReadyList */
+    lazyFlags |= (watch->flags & EWF_READYLISTED);
 
     /* reset our flags */
     EpollWatchFlags oldFlags = watch->flags;
@@ -293,11 +313,30 @@ static gboolean _epollwatch_isReady(EpollWatch* watch) {
     return isReady;
 }
 
+/* links or unlinks the watch from the ready list to match its current readiness */
+static gboolean _epoll_updateReadyList(Epoll* epoll, EpollWatch* watch) {
+    MAGIC_ASSERT(epoll);
+    MAGIC_ASSERT(watch);
+
+    gboolean isReady = _epollwatch_isReady(watch);
+
+    if(isReady && !(watch->flags & EWF_READYLISTED)) {
+        g_queue_push_tail_link(epoll->ready, &(watch->readyLink));
+        watch->flags |= EWF_READYLISTED;
+    } else if(!isReady && (watch->flags & EWF_READYLISTED)) {
+        g_queue_unlink(epoll->ready, &(watch->readyLink));
+        watch->flags &= ~EWF_READYLISTED;
+    }
+
+    return isReady;
+}
+
 static gboolean _epoll_isReadyOS(Epoll* epoll) {
     MAGIC_ASSERT(epoll);
     gboolean isReady = FALSE;
 
-    if(epoll->osEpollDescriptor >= 3) {
+    /* avoid the syscalls when nothing is registered with the OS epoll */
+    if(epoll->osEpollDescriptor >= 3 && epoll->osRegistrationCount > 0) {
         /* the os epoll will be readable when ready */
         struct epoll_event epoll_ev;
         memset(&epoll_ev, 0, sizeof(struct epoll_event));
@@ -333,23 +372,8 @@ static void _epoll_check(Epoll* epoll) {
         return;
     }
 
-    /* check status to see if we need to schedule a notification */
-    gboolean isReady = FALSE;
-
-    /* check all of our children */
-    GHashTableIter iter;
-    gpointer key, value;
-    g_hash_table_iter_init(&iter, epoll->watching);
-    while(g_hash_table_iter_next(&iter, &key, &value)) {
-        EpollWatch* watch = value;
-        MAGIC_ASSERT(watch);
-
-        if(_epollwatch_isReady(watch)) {
-            isReady = TRUE;
-            /* at least one child is ready, stop looping */
-            break;
-        }
-    }
+    /* we are ready if any of our children are on the ready list */
+    gboolean isReady = g_queue_is_empty(epoll->ready) ? FALSE : TRUE;
 
     /* check for events on the OS epoll instance, but only if we are otherwise not ready */
     if(!isReady && _epoll_isReadyOS(epoll)) {
@@ -413,6 +437,8 @@ gint epoll_control(Epoll* epoll, gint operation, Descriptor* descriptor, struct
             /* its added, so we need to listen for changes */
             descriptor_addEpollListener(watch->descriptor, (Descriptor*)epoll);
 
+            _epoll_updateReadyList(epoll, watch);
+
             /* initiate a callback if the new watched descriptor is ready */
             _epoll_check(epoll);
 
@@ -434,6 +460,8 @@ gint epoll_control(Epoll* epoll, gint operation, Descriptor* descriptor, struct
             watch->flags &= ~EWF_EDGETRIGGER_REPORTED;
             watch->flags &= ~EWF_ONESHOT_REPORTED;
 
+            _epoll_updateReadyList(epoll, watch);
+
             /* initiate a callback if the new event type on the watched descriptor is ready */
             _epoll_check(epoll);
 
@@ -449,12 +477,20 @@ gint epoll_control(Epoll* epoll, gint operation, Descriptor* descriptor, struct
             MAGIC_ASSERT(watch);
             watch->flags &= ~EWF_WATCHING;
 
+            if(watch->flags & EWF_READYLISTED) {
+                g_queue_unlink(epoll->ready, &(watch->readyLink));
+                watch->flags &= ~EWF_READYLISTED;
+            }
+
             /* its deleted, so stop listening for updates */
             descriptor_removeEpollListener(watch->descriptor, (Descriptor*)epoll);
 
             /* unref gets called on the watch when it is removed from this table */
             g_hash_table_remove(epoll->watching, descriptor_getHandleReference(watch->descriptor));
 
+            /* we may no longer be ready */
+            _epoll_check(epoll);
+
             break;
         }
 
@@ -470,10 +506,23 @@ gint epoll_control(Epoll* epoll, gint operation, Descriptor* descriptor, struct
 gint epoll_controlOS(Epoll* epoll, gint operation, gint fileDescriptor,
         struct epoll_event* event) {
     MAGIC_ASSERT(epoll);
+
+    if(epoll->osEpollDescriptor < 0) {
+        epoll->osEpollDescriptor = epoll_create(1000);
+        if(epoll->osEpollDescriptor == -1) {
+            warning("error in epoll_create for OS events, errno=%i msg:%s", errno, g_strerror(errno));
+            return errno;
+        }
+    }
+
     /* ask the OS about any events on our kernel epoll descriptor */
     gint ret = epoll_ctl(epoll->osEpollDescriptor, operation, fileDescriptor, event);
     if(ret < 0) {
         ret = errno;
+    } else if(operation == EPOLL_CTL_ADD) {
+        epoll->osRegistrationCount++;
+    } else if(operation == EPOLL_CTL_DEL) {
+        epoll->osRegistrationCount = MAX(0, epoll->osRegistrationCount - 1);
     }
     return ret;
 }
@@ -486,12 +535,14 @@ gint epoll_getEvents(Epoll* epoll, struct epoll_event* eventArray, gint eventArr
      * overflow. the number of actual events is returned in nEvents. */
     gint eventIndex = 0;
 
-    GHashTableIter iter;
-    gpointer key, value;
-    g_hash_table_iter_init(&iter, epoll->watching);
-    while(g_hash_table_iter_next(&iter, &key, &value) && (eventIndex < eventArrayLength)) {
-        EpollWatch* watch = value;
+    /* visit each ready watch at most once. level-triggered watches that are still
+     * ready get requeued at the tail, so a small eventArray can't starve the others */
+    guint nReady = g_queue_get_length(epoll->ready);
+    for(guint i = 0; i < nReady && eventIndex < eventArrayLength; i++) {
+        GList* link = g_queue_pop_head_link(epoll->ready);
+        EpollWatch* watch = link->data;
         MAGIC_ASSERT(watch);
+        watch->flags &= ~EWF_READYLISTED;
 
         if(_epollwatch_isReady(watch)) {
             /* report the event */
@@ -524,10 +575,13 @@ gint epoll_getEvents(Epoll* epoll, struct epoll_event* eventArray, gint eventArr
                 watch->flags |= EWF_ONESHOT_REPORTED;
             }
         }
+
+        /* requeue if there is still something to report */
+        _epoll_updateReadyList(epoll, watch);
     }
 
     gint space = eventArrayLength - eventIndex;
-    if(space) {
+    if(space && epoll->osRegistrationCount > 0) {
         /* now we have to get events from the OS descriptors */
         struct epoll_event osEvents[space];
         memset(&osEvents, 0, space*sizeof(struct epoll_event));
@@ -569,6 +623,9 @@ void epoll_descriptorStatusChanged(Epoll* epoll, Descriptor* descriptor) {
 
     debug("status changed in epoll %i for descriptor %i", epoll->super.handle, descriptor->handle);
 
+    /* only the changed watch needs to be reevaluated */
+    _epoll_updateReadyList(epoll, watch);
+
     /* check the status and take the appropriate action */
     _epoll_check(epoll);
 }
@@ -610,18 +667,7 @@ static void _epoll_tryNotify(Epoll* epoll, gpointer userData) {
     }
 
     /* we should notify the plugin only if we still have some events to report */
-    gboolean isReady = FALSE;
-    GHashTableIter iter;
-    gpointer key, value;
-    g_hash_table_iter_init(&iter, epoll->watching);
-    while(g_hash_table_iter_next(&iter, &key, &value)) {
-        EpollWatch* watch = value;
-        MAGIC_ASSERT(watch);
-
-        if(_epollwatch_isReady(watch)) {
-            isReady = TRUE;
-        }
-    }
+    gboolean isReady = g_queue_is_empty(epoll->ready) ? FALSE : TRUE;
 
     /* check if there is events on the OS epoll instance, but only if we would otherwise
      * not call the process. this ensures the process can collect events for which we are
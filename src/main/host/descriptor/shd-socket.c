@@ -47,18 +47,18 @@ void socket_close(Socket* socket) {
     socket->vtable->close((Descriptor*)socket);
 }
 
-gssize socket_sendUserData(Socket* socket, gconstpointer buffer, gsize nBytes,
-        in_addr_t ip, in_port_t port) {
+gssize socket_sendUserData(Socket* socket, const struct iovec* iov, gint iovcnt,
+        gsize nBytes, in_addr_t ip, in_port_t port) {
     MAGIC_ASSERT(socket);
     MAGIC_ASSERT(socket->vtable);
-    return socket->vtable->send((Transport*)socket, buffer, nBytes, ip, port);
+    return socket->vtable->send((Transport*)socket, iov, iovcnt, nBytes, ip, port);
 }
 
-gssize socket_receiveUserData(Socket* socket, gpointer buffer, gsize nBytes,
-        in_addr_t* ip, in_port_t* port) {
+gssize socket_receiveUserData(Socket* socket, const struct iovec* iov, gint iovcnt,
+        gsize nBytes, in_addr_t* ip, in_port_t* port) {
     MAGIC_ASSERT(socket);
     MAGIC_ASSERT(socket->vtable);
-    return socket->vtable->receive((Transport*)socket, buffer, nBytes, ip, port);
+    return socket->vtable->receive((Transport*)socket, iov, iovcnt, nBytes, ip, port);
 }
 
 TransportFunctionTable socket_functions = {
@@ -324,10 +324,8 @@ gboolean socket_addToInputBuffer(Socket* socket, Packet* packet) {
     Descriptor* descriptor = (Descriptor *)socket;
     tracker_updateSocketInputBuffer(tracker, descriptor->handle, socket->inputBufferLength, socket->inputBufferSize);
 
-    /* we just added a packet, so we are readable */
-    if(socket->inputBufferLength > 0) {
-        descriptor_adjustStatus((Descriptor*)socket, DS_READABLE, TRUE);
-    }
+    /* we just added a packet, so we are readable (even an empty udp datagram can be read) */
+    descriptor_adjustStatus((Descriptor*)socket, DS_READABLE, TRUE);
 
     return TRUE;
 }
@@ -353,7 +351,7 @@ Packet* socket_removeFromInputBuffer(Socket* socket) {
         tracker_updateSocketInputBuffer(tracker, descriptor->handle, socket->inputBufferLength, socket->inputBufferSize);
 
         /* we are not readable if we are now empty */
-        if(socket->inputBufferLength <= 0) {
+        if(g_queue_is_empty(socket->inputBuffer)) {
             descriptor_adjustStatus((Descriptor*)socket, DS_READABLE, FALSE);
         }
     }
@@ -165,6 +165,17 @@ struct _TCP {
         gsize space;
     } autotune;
 
+    /* delayed acknowledgments for in-order data (rfc 1122, section 4.2.3.2) */
+    struct {
+        gboolean isEnabled;
+        /* TRUE if a delayed ACK timer task is scheduled but has not yet fired */
+        gboolean timerPending;
+        /* timestamp value of the first unacknowledged segment, echoed when the timer fires */
+        SimulationTime timestamp;
+        /* bumped on cancel so that timer tasks armed before it do nothing */
+        guint generation;
+    } delack;
+
     /* congestion object for implementing different types of congestion control (aimd, reno, cubic) */
     TCPCongestion* congestion;
 
@@ -646,6 +657,15 @@ static gsize _tcp_getBufferSpaceIn(TCP* tcp) {
     return MAX(0, space);
 }
 
+/* returns how many bytes the next tcp_sendUserData call will accept */
+gsize tcp_getOutputBufferSpace(TCP* tcp) {
+    MAGIC_ASSERT(tcp);
+    if(tcp->error & TCPE_SEND_EOF) {
+        return 0;
+    }
+    return MIN(_tcp_getBufferSpaceOut(tcp), 65535);
+}
+
 static void _tcp_bufferPacketOut(TCP* tcp, Packet* packet) {
     MAGIC_ASSERT(tcp);
 
@@ -708,7 +728,8 @@ static void _tcp_updateSendWindow(TCP* tcp) {
     tcp->send.window = (guint32)MIN(tcp->congestion->window, (gint)tcp->receive.lastWindow);
 }
 
-static Packet* _tcp_createPacket(TCP* tcp, enum ProtocolTCPFlags flags, gconstpointer payload, gsize payloadLength) {
+static Packet* _tcp_createPacket(TCP* tcp, enum ProtocolTCPFlags flags,
+        const struct iovec* payload, gint payloadCount, gsize payloadOffset, gsize payloadLength) {
     MAGIC_ASSERT(tcp);
 
     /*
@@ -742,7 +763,8 @@ static Packet* _tcp_createPacket(TCP* tcp, enum ProtocolTCPFlags flags, gconstpo
 
     /* create the TCP packet. the ack, window, and timestamps will be set in _tcp_flush */
     Host* host = worker_getActiveHost();
-    Packet* packet = packet_new(payload, payloadLength, (guint)host_getID(host), host_getNewPacketID(host));
+    Packet* packet = packet_newFromIOVec(payload, payloadCount, payloadOffset, payloadLength,
+            (guint)host_getID(host), host_getNewPacketID(host));
     packet_setTCP(packet, flags, sourceIP, sourcePort, destinationIP, destinationPort, sequence);
     packet_addDeliveryStatus(packet, PDS_SND_CREATED);
 
@@ -964,6 +986,15 @@ static void _tcp_retransmitPacket(TCP* tcp, gint sequence) {
 }
 
 
+static void _tcp_cancelDelayedAck(TCP* tcp) {
+    MAGIC_ASSERT(tcp);
+    if(tcp->delack.timerPending) {
+        tcp->delack.timerPending = FALSE;
+        tcp->delack.timestamp = 0;
+        tcp->delack.generation++;
+    }
+}
+
 static void _tcp_flush(TCP* tcp) {
     MAGIC_ASSERT(tcp);
 
@@ -1056,6 +1087,7 @@ static void _tcp_flush(TCP* tcp) {
         /* keep track of the last things we sent them */
         tcp->send.lastAcknowledgment = tcp->receive.next;
         tcp->send.lastWindow = tcp->receive.window;
+        _tcp_cancelDelayedAck(tcp);
         // fprintf(stderr, "SND/RCV Sending %s %s %d @ %f\n", tcp->super.boundString, tcp->super.peerString, header.sequence, dtime);
         tcp->info.lastAckSent = now;
 
@@ -1354,7 +1386,7 @@ gint tcp_connectToPeer(TCP* tcp, in_addr_t ip, in_port_t port, sa_family_t famil
     socket_setPeerName(&(tcp->super), ip, port);
 
     /* send 1st part of 3-way handshake, state->syn_sent */
-    Packet* packet = _tcp_createPacket(tcp, PTCP_SYN, NULL, 0);
+    Packet* packet = _tcp_createPacket(tcp, PTCP_SYN, NULL, 0, 0, 0);
 
     /* dont have to worry about space since this has no payload */
     _tcp_bufferPacketOut(tcp, packet);
@@ -1619,6 +1651,79 @@ TCPProcessFlags _tcp_ackProcessing(TCP* tcp, Packet* packet, PacketTCPHeader *he
     return flags;
 }
 
+static void _tcp_runDelayedAckTimerExpiredTask(TCP* tcp, gpointer userData) {
+    MAGIC_ASSERT(tcp);
+
+    /* the ACK was already sent and the timer possibly re-armed since this task was scheduled */
+    if(GPOINTER_TO_UINT(userData) != tcp->delack.generation) {
+        return;
+    }
+
+    tcp->delack.timerPending = FALSE;
+
+    /* nothing to do if we closed or an outgoing packet already carried the ACK */
+    if(tcp->state == TCPS_CLOSED || tcp->receive.next <= tcp->send.lastAcknowledgment) {
+        return;
+    }
+
+    debug("%s <-> %s: delayed ACK timer expired, acknowledging through %"G_GUINT32_FORMAT,
+            tcp->super.boundString, tcp->super.peerString, tcp->receive.next);
+
+    /* echo the timestamp of the segment we delayed, like Linux does with ts_recent */
+    tcp->receive.lastTimestamp = tcp->delack.timestamp;
+
+    Packet* ack = _tcp_createPacket(tcp, PTCP_ACK, NULL, 0, 0, 0);
+    packet_setPriority(ack, 0.0);
+    _tcp_bufferPacketOut(tcp, ack);
+    _tcp_flush(tcp);
+
+    /* the output buffer holds the packet ref now */
+    packet_unref(ack);
+
+    tcp->receive.lastTimestamp = 0;
+}
+
+static void _tcp_scheduleDelayedAck(TCP* tcp, SimulationTime timestamp) {
+    MAGIC_ASSERT(tcp);
+
+    /* the timer is armed by the first unacknowledged segment and is not reset by later ones */
+    if(tcp->delack.timerPending) {
+        return;
+    }
+
+    descriptor_ref(tcp);
+    Task* delackTask = task_new((TaskCallbackFunc)_tcp_runDelayedAckTimerExpiredTask,
+            tcp, GUINT_TO_POINTER(tcp->delack.generation), descriptor_unref, NULL);
+    worker_scheduleTask(delackTask, CONFIG_TCP_DELACK_TIMEOUT);
+    task_unref(delackTask);
+
+    tcp->delack.timerPending = TRUE;
+    tcp->delack.timestamp = timestamp;
+}
+
+/* returns TRUE if the ACK for in-order data we just received may be delayed.
+ * see __tcp_ack_snd_check() in net/ipv4/tcp_input.c: we ACK immediately when
+ * enough full segments are unacknowledged, when data is out of order or just
+ * filled a hole, or when our receive window opened. */
+static gboolean _tcp_canDelayAck(TCP* tcp, gboolean filledHole) {
+    MAGIC_ASSERT(tcp);
+
+    if(!tcp->delack.isEnabled || tcp->state != TCPS_ESTABLISHED) {
+        return FALSE;
+    }
+
+    if(filledHole || tcp->send.selectiveACKs || !priorityqueue_isEmpty(tcp->unorderedInput)) {
+        return FALSE;
+    }
+
+    if(tcp->receive.window > tcp->send.lastWindow) {
+        return FALSE;
+    }
+
+    guint32 unackedSegments = tcp->receive.next - tcp->send.lastAcknowledgment;
+    return (unackedSegments < CONFIG_TCP_DELACK_SEGMENTS) ? TRUE : FALSE;
+}
+
 static void _tcp_logCongestionInfo(TCP* tcp) {
     gsize outSize = socket_getOutputBufferSize(&tcp->super);
     gsize outLength = socket_getOutputBufferLength(&tcp->super);
@@ -1858,6 +1963,9 @@ void tcp_processPacket(TCP* tcp, Packet* packet) {
 
     gint nPacketsAcked = 0;
 
+    /* if we had a hole in our sequence space, this packet may fill it */
+    gboolean hadSelectiveACKs = (tcp->send.selectiveACKs != NULL) ? TRUE : FALSE;
+
     if(packetLength > 0) {
         flags |= _tcp_dataProcessing(tcp, packet, header);
     }
@@ -1918,8 +2026,14 @@ void tcp_processPacket(TCP* tcp, Packet* packet) {
     /* now flush as many packets as we can to socket */
     _tcp_flush(tcp);
 
+    gboolean needsAck = (tcp->receive.next > tcp->send.lastAcknowledgment) ? TRUE : FALSE;
+
     /* send ack if they need updates but we didn't send any yet (selective acks) */
-    if((tcp->receive.next > tcp->send.lastAcknowledgment) ||
+    if(needsAck && packetLength > 0 && responseFlags == PTCP_NONE &&
+            _tcp_canDelayAck(tcp, hadSelectiveACKs)) {
+        /* in-order data, acknowledge it with the next segment or when the timer fires */
+        _tcp_scheduleDelayedAck(tcp, header->timestampValue);
+    } else if(needsAck ||
         (tcp->receive.window != tcp->send.lastWindow) ||
         (tcp->congestion->fastRetransmit && header->sequence > (guint)tcp->receive.next))
     {
@@ -1937,7 +2051,7 @@ void tcp_processPacket(TCP* tcp, Packet* packet) {
 
         debug("%s <-> %s: sending response control packet",
                 tcp->super.boundString, tcp->super.peerString);
-        Packet* response = _tcp_createPacket(tcp, responseFlags, NULL, 0);
+        Packet* response = _tcp_createPacket(tcp, responseFlags, NULL, 0, 0, 0);
         packet_setPriority(response, 0.0);
         _tcp_bufferPacketOut(tcp, response);
         _tcp_flush(tcp);
@@ -1973,7 +2087,8 @@ static void _tcp_endOfFileSignalled(TCP* tcp) {
     descriptor_adjustStatus(&(tcp->super.super.super), DS_ACTIVE, FALSE);
 }
 
-gssize tcp_sendUserData(TCP* tcp, gconstpointer buffer, gsize nBytes, in_addr_t ip, in_port_t port) {
+gssize tcp_sendUserData(TCP* tcp, const struct iovec* iov, gint iovcnt, gsize nBytes,
+        in_addr_t ip, in_port_t port) {
     MAGIC_ASSERT(tcp);
 
     /* return 0 to signal close, if necessary */
@@ -2003,7 +2118,7 @@ gssize tcp_sendUserData(TCP* tcp, gconstpointer buffer, gsize nBytes, in_addr_t
         gsize copyLength = MIN(maxPacketLength, remaining);
 
         /* use helper to create the packet */
-        Packet* packet = _tcp_createPacket(tcp, PTCP_ACK, buffer + bytesCopied, copyLength);
+        Packet* packet = _tcp_createPacket(tcp, PTCP_ACK, iov, iovcnt, bytesCopied, copyLength);
         if(copyLength > 0) {
             /* we are sending more user data */
             tcp->send.end++;
@@ -2034,7 +2149,7 @@ static void _tcp_sendWindowUpdate(TCP* tcp, gpointer data) {
             tcp->super.boundString, tcp->super.peerString, tcp->receive.window);
 
     // XXX we may be in trouble if this packet gets dropped
-    Packet* windowUpdate = _tcp_createPacket(tcp, PTCP_ACK, NULL, 0);
+    Packet* windowUpdate = _tcp_createPacket(tcp, PTCP_ACK, NULL, 0, 0, 0);
     _tcp_bufferPacketOut(tcp, windowUpdate);
     _tcp_flush(tcp);
 
@@ -2044,7 +2159,8 @@ static void _tcp_sendWindowUpdate(TCP* tcp, gpointer data) {
     tcp->receive.windowUpdatePending = FALSE;
 }
 
-gssize tcp_receiveUserData(TCP* tcp, gpointer buffer, gsize nBytes, in_addr_t* ip, in_port_t* port) {
+gssize tcp_receiveUserData(TCP* tcp, const struct iovec* iov, gint iovcnt, gsize nBytes,
+        in_addr_t* ip, in_port_t* port) {
     MAGIC_ASSERT(tcp);
 
     /*
@@ -2071,7 +2187,8 @@ gssize tcp_receiveUserData(TCP* tcp, gpointer buffer, gsize nBytes, in_addr_t* i
         utility_assert(partialBytes > 0);
 
         copyLength = MIN(partialBytes, remaining);
-        bytesCopied = packet_copyPayload(tcp->partialUserDataPacket, tcp->partialOffset, buffer, copyLength);
+        bytesCopied = packet_copyPayloadIOVec(tcp->partialUserDataPacket, tcp->partialOffset,
+                iov, iovcnt, offset, copyLength);
         totalCopied += bytesCopied;
         remaining -= bytesCopied;
         offset += bytesCopied;
@@ -2105,7 +2222,7 @@ gssize tcp_receiveUserData(TCP* tcp, gpointer buffer, gsize nBytes, in_addr_t* i
 
         guint packetLength = packet_getPayloadLength(packet);
         copyLength = MIN(packetLength, remaining);
-        bytesCopied = packet_copyPayload(packet, 0, buffer + offset, copyLength);
+        bytesCopied = packet_copyPayloadIOVec(packet, 0, iov, iovcnt, offset, copyLength);
         totalCopied += bytesCopied;
         remaining -= bytesCopied;
         offset += bytesCopied;
@@ -2236,7 +2353,7 @@ void tcp_close(TCP* tcp) {
 
         case TCPS_SYNRECEIVED:
         case TCPS_SYNSENT: {
-            Packet* reset = _tcp_createPacket(tcp, PTCP_RST, NULL, 0);
+            Packet* reset = _tcp_createPacket(tcp, PTCP_RST, NULL, 0, 0, 0);
             _tcp_bufferPacketOut(tcp, reset);
             _tcp_flush(tcp);
             /* the output buffer holds the packet ref now */
@@ -2253,7 +2370,7 @@ void tcp_close(TCP* tcp) {
     }
 
     /* send a FIN */
-    Packet* packet = _tcp_createPacket(tcp, PTCP_FIN, NULL, 0);
+    Packet* packet = _tcp_createPacket(tcp, PTCP_FIN, NULL, 0, 0, 0);
 
     /* dont have to worry about space since this has no payload */
     _tcp_bufferPacketOut(tcp, packet);
@@ -2335,6 +2452,7 @@ TCP* tcp_new(gint handle, guint receiveBufferSize, guint sendBufferSize) {
     tcp->receive.lastAcknowledgment = initialSequenceNumber;
 
     tcp->autotune.isEnabled = TRUE;
+    tcp->delack.isEnabled = options_doTCPDelayedAck(options);
 
     tcp->throttledOutput =
             priorityqueue_new((GCompareDataFunc)packet_compareTCPSequence, NULL, (GDestroyNotify)packet_unref);
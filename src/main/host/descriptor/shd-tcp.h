@@ -32,6 +32,7 @@ void tcp_clearAllChildrenIfServer(TCP* tcp);
 
 gsize tcp_getOutputBufferLength(TCP* tcp);
 gsize tcp_getInputBufferLength(TCP* tcp);
+gsize tcp_getOutputBufferSpace(TCP* tcp);
 
 void tcp_disableSendBufferAutotuning(TCP* tcp);
 void tcp_disableReceiveBufferAutotuning(TCP* tcp);
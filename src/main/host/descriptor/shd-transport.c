@@ -38,16 +38,16 @@ void transport_init(Transport* transport, TransportFunctionTable* vtable, Descri
 
 }
 
-gssize transport_sendUserData(Transport* transport, gconstpointer buffer, gsize nBytes,
-        in_addr_t ip, in_port_t port) {
+gssize transport_sendUserData(Transport* transport, const struct iovec* iov, gint iovcnt,
+        gsize nBytes, in_addr_t ip, in_port_t port) {
     MAGIC_ASSERT(transport);
     MAGIC_ASSERT(transport->vtable);
-    return transport->vtable->send(transport, buffer, nBytes, ip, port);
+    return transport->vtable->send(transport, iov, iovcnt, nBytes, ip, port);
 }
 
-gssize transport_receiveUserData(Transport* transport, gpointer buffer, gsize nBytes,
-        in_addr_t* ip, in_port_t* port) {
+gssize transport_receiveUserData(Transport* transport, const struct iovec* iov, gint iovcnt,
+        gsize nBytes, in_addr_t* ip, in_port_t* port) {
     MAGIC_ASSERT(transport);
     MAGIC_ASSERT(transport->vtable);
-    return transport->vtable->receive(transport, buffer, nBytes, ip, port);
+    return transport->vtable->receive(transport, iov, iovcnt, nBytes, ip, port);
 }
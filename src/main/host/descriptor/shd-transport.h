@@ -12,8 +12,12 @@
 typedef struct _Transport Transport;
 typedef struct _TransportFunctionTable TransportFunctionTable;
 
-typedef gssize (*TransportSendFunc)(Transport* transport, gconstpointer buffer, gsize nBytes, in_addr_t ip, in_port_t port);
-typedef gssize (*TransportReceiveFunc)(Transport* transport, gpointer buffer, gsize nBytes, in_addr_t* ip, in_port_t* port);
+/* user data is passed as an iovec array holding nBytes in total, so that it is
+ * copied only once between the user buffers and our packet or channel storage */
+typedef gssize (*TransportSendFunc)(Transport* transport, const struct iovec* iov, gint iovcnt,
+        gsize nBytes, in_addr_t ip, in_port_t port);
+typedef gssize (*TransportReceiveFunc)(Transport* transport, const struct iovec* iov, gint iovcnt,
+        gsize nBytes, in_addr_t* ip, in_port_t* port);
 
 struct _TransportFunctionTable {
     DescriptorFunc close;
@@ -32,9 +36,9 @@ struct _Transport {
 
 void transport_init(Transport* transport, TransportFunctionTable* vtable, DescriptorType type, gint handle);
 
-gssize transport_sendUserData(Transport* transport, gconstpointer buffer, gsize nBytes,
-        in_addr_t ip, in_port_t port);
-gssize transport_receiveUserData(Transport* transport, gpointer buffer, gsize nBytes,
-        in_addr_t* ip, in_port_t* port);
+gssize transport_sendUserData(Transport* transport, const struct iovec* iov, gint iovcnt,
+        gsize nBytes, in_addr_t ip, in_port_t port);
+gssize transport_receiveUserData(Transport* transport, const struct iovec* iov, gint iovcnt,
+        gsize nBytes, in_addr_t* ip, in_port_t* port);
 
 #endif /* SHD_TRANSPORT_H_ */
@@ -36,11 +36,10 @@ gint udp_connectToPeer(UDP* udp, in_addr_t ip, in_port_t port, sa_family_t famil
 void udp_processPacket(UDP* udp, Packet* packet) {
     MAGIC_ASSERT(udp);
 
-    /* UDP packet contains data for user and can be buffered immediately */
-    if(packet_getPayloadLength(packet) > 0) {
-        if(!socket_addToInputBuffer((Socket*)udp, packet)) {
-            packet_addDeliveryStatus(packet, PDS_RCV_SOCKET_DROPPED);
-        }
+    /* UDP packet contains data for user and can be buffered immediately.
+     * empty datagrams are buffered too, the user reads them as 0 bytes */
+    if(!socket_addToInputBuffer((Socket*)udp, packet)) {
+        packet_addDeliveryStatus(packet, PDS_RCV_SOCKET_DROPPED);
     }
 }
 
@@ -55,7 +54,8 @@ void udp_dropPacket(UDP* udp, Packet* packet) {
  * ip and port parameters. this function assumes that the socket is already
  * bound to a local port, no matter if that happened explicitly or implicitly.
  */
-gssize udp_sendUserData(UDP* udp, gconstpointer buffer, gsize nBytes, in_addr_t ip, in_port_t port) {
+gssize udp_sendUserData(UDP* udp, const struct iovec* iov, gint iovcnt, gsize nBytes,
+        in_addr_t ip, in_port_t port) {
     MAGIC_ASSERT(udp);
 
     gsize space = socket_getOutputBufferSpace(&(udp->super));
@@ -69,8 +69,8 @@ gssize udp_sendUserData(UDP* udp, gconstpointer buffer, gsize nBytes, in_addr_t
     gsize remaining = nBytes;
     gsize offset = 0;
 
-    /* create as many packets as needed */
-    while(remaining > 0) {
+    /* create as many packets as needed, and one for an empty datagram */
+    do {
         gsize copyLength = MIN(maxPacketLength, remaining);
 
         /* use default destination if none was specified */
@@ -94,7 +94,8 @@ gssize udp_sendUserData(UDP* udp, gconstpointer buffer, gsize nBytes, in_addr_t
 
         /* create the UDP packet */
         Host* host = worker_getActiveHost();
-        Packet* packet = packet_new(buffer + offset, copyLength, (guint)host_getID(host), host_getNewPacketID(host));
+        Packet* packet = packet_newFromIOVec(iov, iovcnt, offset, copyLength,
+                (guint)host_getID(host), host_getNewPacketID(host));
         packet_setUDP(packet, PUDP_NONE, sourceIP, sourcePort, destinationIP, destinationPort);
         packet_addDeliveryStatus(packet, PDS_SND_CREATED);
 
@@ -109,7 +110,7 @@ gssize udp_sendUserData(UDP* udp, gconstpointer buffer, gsize nBytes, in_addr_t
             warning("unable to send UDP packet");
             break;
         }
-    }
+    } while(remaining > 0);
 
     /* update the tracker output buffer stats */
     Tracker* tracker = host_getTracker(worker_getActiveHost());
@@ -124,7 +125,8 @@ gssize udp_sendUserData(UDP* udp, gconstpointer buffer, gsize nBytes, in_addr_t
     return (gssize) offset;
 }
 
-gssize udp_receiveUserData(UDP* udp, gpointer buffer, gsize nBytes, in_addr_t* ip, in_port_t* port) {
+gssize udp_receiveUserData(UDP* udp, const struct iovec* iov, gint iovcnt, gsize nBytes,
+        in_addr_t* ip, in_port_t* port) {
     MAGIC_ASSERT(udp);
 
     Packet* packet = socket_removeFromInputBuffer((Socket*)udp);
@@ -135,7 +137,7 @@ gssize udp_receiveUserData(UDP* udp, gpointer buffer, gsize nBytes, in_addr_t* i
     /* copy lesser of requested and available amount to application buffer */
     guint packetLength = packet_getPayloadLength(packet);
     gsize copyLength = MIN(nBytes, packetLength);
-    guint bytesCopied = packet_copyPayload(packet, 0, buffer, copyLength);
+    guint bytesCopied = packet_copyPayloadIOVec(packet, 0, iov, iovcnt, 0, copyLength);
 
     utility_assert(bytesCopied == copyLength);
     packet_addDeliveryStatus(packet, PDS_RCV_SOCKET_DELIVERED);
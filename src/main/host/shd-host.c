@@ -23,8 +23,11 @@ struct _Host {
     /* a statistics tracker for in/out bytes, CPU, memory, etc. */
     Tracker* tracker;
 
-    /* virtual descriptor numbers */
-    GQueue* availableDescriptors;
+    /* optional private heap for the memory our processes allocate */
+    Arena* arena;
+
+    /* virtual descriptor numbers, freed handles are reused lowest first */
+    PriorityQueue* availableDescriptors;
     gint descriptorHandleCounter;
 
     /* virtual process and event id counter */
@@ -32,8 +35,8 @@ struct _Host {
     guint64 eventIDCounter;
     guint64 packetIDCounter;
 
-    /* all file, socket, and epoll descriptors we know about and track */
-    GHashTable* descriptors;
+    /* all file, socket, and epoll descriptors we know about and track, indexed by handle */
+    GPtrArray* descriptors;
 
     /* map from the descriptor handle we returned to the plug-in, and
      * descriptor handle that the OS gave us for files, etc.
@@ -63,6 +66,12 @@ struct _Host {
     MAGIC_DECLARE;
 };
 
+static gint _host_compareDescriptors(gconstpointer a, gconstpointer b, gpointer userData) {
+  gint aint = GPOINTER_TO_INT(a);
+  gint bint = GPOINTER_TO_INT(b);
+  return aint < bint ? -1 : aint == bint ? 0 : 1;
+}
+
 /* this function is called by slave before the workers exist */
 Host* host_new(HostParameters* params) {
     utility_assert(params);
@@ -91,11 +100,11 @@ Host* host_new(HostParameters* params) {
 
     host->interfaces = g_hash_table_new_full(g_direct_hash, g_direct_equal,
             NULL, (GDestroyNotify) networkinterface_free);
-    host->availableDescriptors = g_queue_new();
+    host->availableDescriptors = priorityqueue_new(_host_compareDescriptors, NULL, NULL);
     host->descriptorHandleCounter = MIN_DESCRIPTOR;
 
     /* virtual descriptor management */
-    host->descriptors = g_hash_table_new_full(g_int_hash, g_int_equal, NULL, descriptor_unref);
+    host->descriptors = g_ptr_array_sized_new(MIN_DESCRIPTOR * 2);
     host->shadowToOSHandleMap = g_hash_table_new(g_direct_hash, g_direct_equal);
     host->osToShadowHandleMap = g_hash_table_new(g_direct_hash, g_direct_equal);
     host->randomShadowHandleMap = g_hash_table_new(g_direct_hash, g_direct_equal);
@@ -202,11 +211,8 @@ void host_shutdown(Host* host) {
     }
 
     if(host->descriptors) {
-        GHashTableIter iter;
-        gpointer key, value;
-        g_hash_table_iter_init(&iter, host->descriptors);
-        while(g_hash_table_iter_next(&iter, &key, &value)) {
-            Descriptor* desc = value;
+        for(guint i = 0; i < host->descriptors->len; i++) {
+            Descriptor* desc = g_ptr_array_index(host->descriptors, i);
             if(desc && desc->type == DT_TCPSOCKET) {
               /* tcp servers and their children holds refs to each other. make
                * sure they all get freed by removing the refs in one direction */
@@ -217,7 +223,18 @@ void host_shutdown(Host* host) {
             }
         }
 
-        g_hash_table_destroy(host->descriptors);
+        /* clear each slot before dropping the table's ref, in case freeing
+         * one descriptor causes another one to be closed */
+        for(guint i = 0; i < host->descriptors->len; i++) {
+            Descriptor* desc = g_ptr_array_index(host->descriptors, i);
+            if(desc) {
+                g_ptr_array_index(host->descriptors, i) = NULL;
+                descriptor_unref(desc);
+            }
+        }
+
+        g_ptr_array_free(host->descriptors, TRUE);
+        host->descriptors = NULL;
     }
 
     if(host->shadowToOSHandleMap) {
@@ -239,9 +256,15 @@ void host_shutdown(Host* host) {
     if(host->tracker) {
         tracker_free(host->tracker);
     }
+    if(host->arena) {
+        /* the processes are gone, so this releases everything they leaked */
+        Arena* arena = host->arena;
+        host->arena = NULL;
+        arena_free(arena);
+    }
 
     if(host->availableDescriptors) {
-        g_queue_free(host->availableDescriptors);
+        priorityqueue_free(host->availableDescriptors);
     }
     if(host->random) {
         random_free(host->random);
@@ -322,7 +345,16 @@ void host_boot(Host* host) {
     MAGIC_ASSERT(host);
 
     /* must be done after the default IP exists so tracker_heartbeat works */
-    host->tracker = tracker_new(host->params.heartbeatInterval, host->params.heartbeatLogLevel, host->params.heartbeatLogInfo);
+    host->tracker = tracker_new(host->params.heartbeatInterval, host->params.heartbeatLogLevel,
+            host->params.heartbeatLogInfo, host->params.heartbeatFormat, host->dataDirPath);
+
+    if(host->params.arenaSize > 0) {
+        host->arena = arena_new((gsize)host->params.arenaSize);
+        if(!host->arena) {
+            warning("unable to reserve a %"G_GUINT64_FORMAT" byte arena for host %s, "
+                    "using the shared heap instead", host->params.arenaSize, host->params.hostname);
+        }
+    }
 
     /* scheduling the starting and stopping of our virtual processes */
     g_queue_foreach(host->processes, (GFunc)process_schedule, NULL);
@@ -345,10 +377,10 @@ guint64 host_getNewPacketID(Host* host) {
 
 void host_addApplication(Host* host, SimulationTime startTime, SimulationTime stopTime,
         const gchar* pluginName, const gchar* pluginPath, const gchar* pluginSymbol,
-        const gchar* preloadName, const gchar* preloadPath, gchar* arguments) {
+        gsize pluginStackSize, const gchar* preloadName, const gchar* preloadPath, gchar* arguments) {
     MAGIC_ASSERT(host);
     guint processID = host_getNewProcessID(host);
-    Process* proc = process_new(host, processID, startTime, stopTime, pluginName, pluginPath, pluginSymbol, preloadName, preloadPath, arguments);
+    Process* proc = process_new(host, processID, startTime, stopTime, pluginName, pluginPath, pluginSymbol, pluginStackSize, preloadName, preloadPath, arguments);
     g_queue_push_tail(host->processes, proc);
 }
 
@@ -363,12 +395,9 @@ void host_freeAllApplications(Host* host) {
     debug("done freeing application for host '%s'", host->params.hostname);
 
     debug("start clearing epoll descriptors for host '%s'", host->params.hostname);
-    GHashTableIter iter;
-    gpointer key, value;
-    g_hash_table_iter_init(&iter, host->descriptors);
-    while(g_hash_table_iter_next(&iter, &key, &value)) {
-        Descriptor* descriptor = value;
-        if(descriptor->type == DT_EPOLL) {
+    for(guint i = 0; i < host->descriptors->len; i++) {
+        Descriptor* descriptor = g_ptr_array_index(host->descriptors, i);
+        if(descriptor && descriptor->type == DT_EPOLL) {
             epoll_clearWatchListeners((Epoll*) descriptor);
         }
     }
@@ -430,7 +459,10 @@ gboolean host_autotuneSendBuffer(Host* host) {
 
 Descriptor* host_lookupDescriptor(Host* host, gint handle) {
     MAGIC_ASSERT(host);
-    return g_hash_table_lookup(host->descriptors, (gconstpointer) &handle);
+    if(handle < 0 || (guint)handle >= host->descriptors->len) {
+        return NULL;
+    }
+    return g_ptr_array_index(host->descriptors, handle);
 }
 
 NetworkInterface* host_lookupInterface(Host* host, in_addr_t handle) {
@@ -493,8 +525,15 @@ static gint _host_monitorDescriptor(Host* host, Descriptor* descriptor) {
 
     /* make sure there are no collisions before inserting */
     gint* handle = descriptor_getHandleReference(descriptor);
-    utility_assert(handle && !host_lookupDescriptor(host, *handle));
-    g_hash_table_replace(host->descriptors, handle, descriptor);
+    utility_assert(handle && *handle >= 0 && !host_lookupDescriptor(host, *handle));
+
+    /* grow the table so the handle indexes into it, new slots are NULL */
+    if((guint)*handle >= host->descriptors->len) {
+        g_ptr_array_set_size(host->descriptors, MAX((guint)*handle + 1, host->descriptors->len * 2));
+    }
+
+    /* the table consumes the descriptor's initial ref */
+    g_ptr_array_index(host->descriptors, *handle) = descriptor;
 
     return *handle;
 }
@@ -509,28 +548,25 @@ static void _host_unmonitorDescriptor(Host* host, gint handle) {
             _host_disassociateInterface(host, socket);
         }
 
-        g_hash_table_remove(host->descriptors, (gconstpointer) &handle);
+        /* clear the slot first, dropping the ref may cause other closes */
+        g_ptr_array_index(host->descriptors, handle) = NULL;
+        descriptor_unref(descriptor);
     }
 }
 
-static gint _host_compareDescriptors(gconstpointer a, gconstpointer b, gpointer userData) {
-  gint aint = GPOINTER_TO_INT(a);
-  gint bint = GPOINTER_TO_INT(b);
-  return aint < bint ? -1 : aint == bint ? 0 : 1;
-}
-
 static gint _host_getNextDescriptorHandle(Host* host) {
     MAGIC_ASSERT(host);
-    if(g_queue_get_length(host->availableDescriptors) > 0) {
-        return GPOINTER_TO_INT(g_queue_pop_head(host->availableDescriptors));
+    if(!priorityqueue_isEmpty(host->availableDescriptors)) {
+        return GPOINTER_TO_INT(priorityqueue_pop(host->availableDescriptors));
     }
     return (host->descriptorHandleCounter)++;
 }
 
 static void _host_returnPreviousDescriptorHandle(Host* host, gint handle) {
     MAGIC_ASSERT(host);
+    /* the heap ignores duplicates, so a handle is never handed out twice */
     if(handle >= 3) {
-        g_queue_insert_sorted(host->availableDescriptors, GINT_TO_POINTER(handle), _host_compareDescriptors, NULL);
+        priorityqueue_push(host->availableDescriptors, GINT_TO_POINTER(handle));
     }
 }
 
@@ -785,7 +821,40 @@ gint host_epollGetEvents(Host* host, gint handle,
     return ret;
 }
 
-gint host_select(Host* host, fd_set* readable, fd_set* writeable, fd_set* erroneous) {
+static DescriptorStatus _host_getReadiness(Host* host, gint handle, gshort events) {
+    MAGIC_ASSERT(host);
+
+    /* shadow descriptors are indexed by handle, so this is a direct lookup */
+    Descriptor* descriptor = host_lookupDescriptor(host, handle);
+    if(descriptor) {
+        return descriptor_getStatus(descriptor);
+    }
+
+    /* check if we have a mapped os fd, and ask the OS without letting it block */
+    gint osHandle = host_getOSHandle(host, handle);
+    if(osHandle < 0) {
+        return DS_NONE;
+    }
+
+    struct pollfd osPollFD;
+    osPollFD.fd = osHandle;
+    osPollFD.events = events;
+    osPollFD.revents = 0;
+
+    DescriptorStatus status = DS_NONE;
+    if(poll(&osPollFD, (nfds_t)1, 0) > 0) {
+        status |= DS_ACTIVE;
+        if(osPollFD.revents & POLLIN) {
+            status |= DS_READABLE;
+        }
+        if(osPollFD.revents & POLLOUT) {
+            status |= DS_WRITABLE;
+        }
+    }
+    return status;
+}
+
+gint host_select(Host* host, gint nfds, fd_set* readable, fd_set* writeable, fd_set* erroneous) {
     MAGIC_ASSERT(host);
 
     /* if they dont want readability or writeability, then we have nothing to do */
@@ -796,98 +865,44 @@ gint host_select(Host* host, fd_set* readable, fd_set* writeable, fd_set* errone
         return 0;
     }
 
-    GQueue* readyDescsRead = g_queue_new();
-    GQueue* readyDescsWrite = g_queue_new();
-
-    /* first look at shadow internal descriptors */
-    GList* descs = g_hash_table_get_values(host->descriptors);
-    GList* item = g_list_first(descs);
+    fd_set readyRead;
+    fd_set readyWrite;
+    FD_ZERO(&readyRead);
+    FD_ZERO(&readyWrite);
+    gint nReady = 0;
 
-    /* iterate all descriptors */
-    while(item) {
-        Descriptor* desc = item->data;
-        if(desc) {
-            DescriptorStatus status = descriptor_getStatus(desc);
-            if((readable != NULL) && FD_ISSET(desc->handle, readable) && (status & DS_ACTIVE) && (status & DS_READABLE)) {
-                g_queue_push_head(readyDescsRead, GINT_TO_POINTER(desc->handle));
-            }
-            if((writeable != NULL) && FD_ISSET(desc->handle, writeable) && (status & DS_ACTIVE) && (status & DS_WRITABLE)) {
-                g_queue_push_head(readyDescsWrite, GINT_TO_POINTER(desc->handle));
-            }
+    /* only visit the handles that were actually requested, instead of
+     * scanning every descriptor the host owns */
+    for(gint handle = 0; handle < nfds; handle++) {
+        gboolean wantsRead = (readable != NULL) && FD_ISSET(handle, readable);
+        gboolean wantsWrite = (writeable != NULL) && FD_ISSET(handle, writeable);
+        if(!wantsRead && !wantsWrite) {
+            continue;
         }
-        item = g_list_next(item);
-    }
-    /* cleanup the iterator lists */
-    g_list_free(descs);
-    item = descs = NULL;
-
-    /* now check on OS descriptors */
-    struct timeval zeroTimeout;
-    zeroTimeout.tv_sec = 0;
-    zeroTimeout.tv_usec = 0;
-    fd_set osFDSet;
-
-    /* setup our iterator */
-    GHashTableIter iter;
-    gpointer key, value;
-    g_hash_table_iter_init(&iter, host->shadowToOSHandleMap);
-
-    /* iterate all os handles and ask the os for events */
-    while (g_hash_table_iter_next(&iter, &key, &value)) {
-        gint shadowHandle = GPOINTER_TO_INT(key);
-        gint osHandle = GPOINTER_TO_INT(value);
-
-        if ((readable != NULL) && FD_ISSET(shadowHandle, readable)) {
-            FD_ZERO(&osFDSet);
-            FD_SET(osHandle, &osFDSet);
-            select(osHandle+1, &osFDSet, NULL, NULL, &zeroTimeout);
-            if (FD_ISSET(osHandle, &osFDSet)) {
-                g_queue_push_head(readyDescsRead, GINT_TO_POINTER(shadowHandle));
-            }
+
+        gshort events = (wantsRead ? POLLIN : 0) | (wantsWrite ? POLLOUT : 0);
+        DescriptorStatus status = _host_getReadiness(host, handle, events);
+
+        if(wantsRead && (status & DS_ACTIVE) && (status & DS_READABLE)) {
+            FD_SET(handle, &readyRead);
+            nReady++;
         }
-        if ((writeable != NULL) && FD_ISSET(shadowHandle, writeable)) {
-            FD_ZERO(&osFDSet);
-            FD_SET(osHandle, &osFDSet);
-            select(osHandle+1, NULL, &osFDSet, NULL, &zeroTimeout);
-            if (FD_ISSET(osHandle, &osFDSet)) {
-                g_queue_push_head(readyDescsWrite, GINT_TO_POINTER(shadowHandle));
-            }
+        if(wantsWrite && (status & DS_ACTIVE) && (status & DS_WRITABLE)) {
+            FD_SET(handle, &readyWrite);
+            nReady++;
         }
     }
 
-    /* now prepare and return the response, start with empty sets */
+    /* now return the response */
     if(readable != NULL) {
-        FD_ZERO(readable);
+        *readable = readyRead;
     }
     if(writeable != NULL) {
-        FD_ZERO(writeable);
+        *writeable = readyWrite;
     }
     if(erroneous != NULL) {
         FD_ZERO(erroneous);
     }
-    gint nReady = 0;
-
-    /* mark all of the readable handles */
-    if(readable != NULL) {
-        while(!g_queue_is_empty(readyDescsRead)) {
-            gint handle = GPOINTER_TO_INT(g_queue_pop_head(readyDescsRead));
-            FD_SET(handle, readable);
-            nReady++;
-        }
-    }
-    /* cleanup */
-    g_queue_free(readyDescsRead);
-
-    /* mark all of the writeable handles */
-    if(writeable != NULL) {
-        while(!g_queue_is_empty(readyDescsWrite)) {
-            gint handle = GPOINTER_TO_INT(g_queue_pop_head(readyDescsWrite));
-            FD_SET(handle, writeable);
-            nReady++;
-        }
-    }
-    /* cleanup */
-    g_queue_free(readyDescsWrite);
 
     /* return the total number of bits that are set in all three fdsets */
     return nReady;
@@ -906,9 +921,8 @@ gint host_poll(Host* host, struct pollfd *pollFDs, nfds_t numPollFDs) {
             continue;
         }
 
-        if(host_isShadowDescriptor(host, pfd->fd)){
-            /* descriptor lookup is not NULL */
-            Descriptor* descriptor = host_lookupDescriptor(host, pfd->fd);
+        Descriptor* descriptor = host_lookupDescriptor(host, pfd->fd);
+        if(descriptor) {
             DescriptorStatus status = descriptor_getStatus(descriptor);
             if(status & DS_CLOSED) {
                 pfd->revents |= POLLNVAL;
@@ -1427,11 +1441,13 @@ gint host_getSocketName(Host* host, gint handle, const struct sockaddr* address,
     }
 }
 
-gint host_sendUserData(Host* host, gint handle, gconstpointer buffer, gsize nBytes,
+gint host_sendUserData(Host* host, gint handle, const struct iovec* iov, gint iovcnt,
         in_addr_t ip, in_addr_t port, gsize* bytesCopied) {
     MAGIC_ASSERT(host);
     utility_assert(bytesCopied);
 
+    gsize nBytes = utility_getIOVecLength(iov, iovcnt);
+
     Descriptor* descriptor = host_lookupDescriptor(host, handle);
     if(descriptor == NULL) {
         warning("descriptor handle '%i' not found", handle);
@@ -1502,7 +1518,7 @@ gint host_sendUserData(Host* host, gint handle, gconstpointer buffer, gsize nByt
         }
     }
 
-    gssize n = transport_sendUserData(transport, buffer, nBytes, ip, port);
+    gssize n = transport_sendUserData(transport, iov, iovcnt, nBytes, ip, port);
     if(n > 0) {
         /* user is writing some bytes. */
         *bytesCopied = (gsize)n;
@@ -1515,11 +1531,13 @@ gint host_sendUserData(Host* host, gint handle, gconstpointer buffer, gsize nByt
     return 0;
 }
 
-gint host_receiveUserData(Host* host, gint handle, gpointer buffer, gsize nBytes,
+gint host_receiveUserData(Host* host, gint handle, const struct iovec* iov, gint iovcnt,
         in_addr_t* ip, in_port_t* port, gsize* bytesCopied) {
     MAGIC_ASSERT(host);
     utility_assert(ip && port && bytesCopied);
 
+    gsize nBytes = utility_getIOVecLength(iov, iovcnt);
+
     Descriptor* descriptor = host_lookupDescriptor(host, handle);
     if(descriptor == NULL) {
         warning("descriptor handle '%i' not found", handle);
@@ -1551,7 +1569,7 @@ gint host_receiveUserData(Host* host, gint handle, gpointer buffer, gsize nBytes
         return EAGAIN;
     }
 
-    gssize n = transport_receiveUserData(transport, buffer, nBytes, ip, port);
+    gssize n = transport_receiveUserData(transport, iov, iovcnt, nBytes, ip, port);
     if(n > 0) {
         /* user is reading some bytes. */
         *bytesCopied = (gsize)n;
@@ -1589,6 +1607,11 @@ Tracker* host_getTracker(Host* host) {
     return host->tracker;
 }
 
+Arena* host_getArena(Host* host) {
+    MAGIC_ASSERT(host);
+    return host->arena;
+}
+
 LogLevel host_getLogLevel(Host* host) {
     MAGIC_ASSERT(host);
     return host->params.logLevel;
@@ -31,6 +31,7 @@ struct _HostParameters {
     SimulationTime heartbeatInterval;
     LogLevel heartbeatLogLevel;
     LogInfoFlags heartbeatLogInfo;
+    HeartbeatFormat heartbeatFormat;
     LogLevel logLevel;
     gboolean logPcap;
     gchar* pcapDir;
@@ -40,6 +41,7 @@ struct _HostParameters {
     guint64 sendBufSize;
     gboolean autotuneSendBuf;
     guint64 interfaceBufSize;
+    guint64 arenaSize;
 };
 
 Host* host_new(HostParameters* params);
@@ -62,7 +64,7 @@ guint64 host_getNewEventID(Host* host);
 guint64 host_getNewPacketID(Host* host);
 void host_addApplication(Host* host, SimulationTime startTime, SimulationTime stopTime,
         const gchar* pluginName, const gchar* pluginPath, const gchar* pluginSymbol,
-        const gchar* preloadName, const gchar* preloadPath, gchar* arguments);
+        gsize pluginStackSize, const gchar* preloadName, const gchar* preloadPath, gchar* arguments);
 void host_freeAllApplications(Host* host);
 
 gint host_compare(gconstpointer a, gconstpointer b, gpointer user_data);
@@ -97,19 +99,20 @@ gint host_epollControl(Host* host, gint epollDescriptor, gint operation,
         gint fileDescriptor, struct epoll_event* event);
 gint host_epollGetEvents(Host* host, gint handle, struct epoll_event* eventArray,
         gint eventArrayLength, gint* nEvents);
-gint host_select(Host* host, fd_set* readable, fd_set* writeable, fd_set* erroneous);
+gint host_select(Host* host, gint nfds, fd_set* readable, fd_set* writeable, fd_set* erroneous);
 gint host_poll(Host* host, struct pollfd *pollFDs, nfds_t numPollFDs);
 
 gint host_bindToInterface(Host* host, gint handle, const struct sockaddr* address);
 gint host_connectToPeer(Host* host, gint handle, const struct sockaddr* address);
 gint host_listenForPeer(Host* host, gint handle, gint backlog);
 gint host_acceptNewPeer(Host* host, gint handle, in_addr_t* ip, in_port_t* port, gint* acceptedHandle);
-gint host_sendUserData(Host* host, gint handle, gconstpointer buffer, gsize nBytes, in_addr_t ip, in_addr_t port, gsize* bytesCopied);
-gint host_receiveUserData(Host* host, gint handle, gpointer buffer, gsize nBytes, in_addr_t* ip, in_port_t* port, gsize* bytesCopied);
+gint host_sendUserData(Host* host, gint handle, const struct iovec* iov, gint iovcnt, in_addr_t ip, in_addr_t port, gsize* bytesCopied);
+gint host_receiveUserData(Host* host, gint handle, const struct iovec* iov, gint iovcnt, in_addr_t* ip, in_port_t* port, gsize* bytesCopied);
 gint host_getPeerName(Host* host, gint handle, const struct sockaddr* address, socklen_t* len);
 gint host_getSocketName(Host* host, gint handle, const struct sockaddr* address, socklen_t* len);
 
 Tracker* host_getTracker(Host* host);
+Arena* host_getArena(Host* host);
 LogLevel host_getLogLevel(Host* host);
 
 const gchar* host_getDataPath(Host* host);
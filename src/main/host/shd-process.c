@@ -163,6 +163,9 @@ struct _Process {
         GString* preloadName;
         GString* preloadPath;
 
+        /* the stack size of every pth thread running the plugin */
+        gsize stackSize;
+
         /* every plug-in needs a main function, which we call to start the virtual process */
         PluginMainFunc main;
 
@@ -217,6 +220,11 @@ struct _Process {
      * interceptions, etc)
      */
     ProcessContext activeContext;
+    /* cached --task-profile, so that context switches skip the worker lookup when it is off */
+    gboolean isProfilingTasks;
+
+    /* the emulated time and context, readable by the preload library */
+    ProcessTimePage timePage;
 
     /* timer for CPU delay measurements */
     GTimer* cpuDelayTimer;
@@ -265,6 +273,10 @@ static ProcessContext _process_changeContext(Process* proc, ProcessContext from,
         prevContext = proc->activeContext;
         proc->activeContext = to;
     }
+    proc->timePage.isEmulating = (to == PCTX_SHADOW) ? 0 : 1;
+    if(proc->isProfilingTasks && (from == PCTX_PLUGIN || to == PCTX_PLUGIN)) {
+        worker_setPluginProfileContext((to == PCTX_PLUGIN) ? TRUE : FALSE);
+    }
     return prevContext;
 }
 
@@ -553,8 +565,8 @@ static void _process_loadPlugin(Process* proc) {
 
 Process* process_new(gpointer host, guint processID,
         SimulationTime startTime, SimulationTime stopTime, const gchar* pluginName,
-        const gchar* pluginPath, const gchar* pluginSymbol, const gchar* preloadName,
-        const gchar* preloadPath, gchar* arguments) {
+        const gchar* pluginPath, const gchar* pluginSymbol, gsize pluginStackSize,
+        const gchar* preloadName, const gchar* preloadPath, gchar* arguments) {
     Process* proc = g_new0(Process, 1);
     MAGIC_INIT(proc);
 
@@ -576,6 +588,9 @@ Process* process_new(gpointer host, guint processID,
         proc->plugin.preloadName = g_string_new(preloadName);
         proc->plugin.preloadPath = g_string_new(preloadPath);
     }
+    proc->plugin.stackSize = pluginStackSize > 0 ? pluginStackSize : PROC_PTH_STACK_SIZE;
+    /* the configuration bounds it, pth takes it as unsigned int */
+    utility_assert(proc->plugin.stackSize <= CONFIG_PLUGIN_MAX_STACK_SIZE);
 
     proc->processName = g_string_new(NULL);
     g_string_printf(proc->processName, "%s.%s.%u",
@@ -1040,6 +1055,64 @@ gboolean process_addAtExitCallback(Process* proc, gpointer userCallback, gpointe
     return TRUE;
 }
 
+/* the pth notifier hooks are called by the rpth scheduler in pth context;
+ * they go straight to our epoll object instead of through the interposer */
+static int _process_pthNotifierWatch(gpointer arg, int op, int fd, struct epoll_event* event) {
+    Process* proc = arg;
+    MAGIC_ASSERT(proc);
+
+    ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
+    gint result = host_epollControl(proc->host, proc->epollfd, op, fd, event);
+    _process_changeContext(proc, PCTX_SHADOW, prevCTX);
+
+    if(result != 0) {
+        errno = result;
+        return -1;
+    }
+    return 0;
+}
+
+static int _process_pthNotifierCollect(gpointer arg, struct epoll_event* events, int maxEvents) {
+    Process* proc = arg;
+    MAGIC_ASSERT(proc);
+
+    ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
+    gint nEvents = 0;
+    gint result = host_epollGetEvents(proc->host, proc->epollfd, events, maxEvents, &nEvents);
+    _process_changeContext(proc, PCTX_SHADOW, prevCTX);
+
+    if(result != 0) {
+        errno = result;
+        return -1;
+    }
+    return nEvents;
+}
+
+static void _process_runContinueTask(Process* proc, gpointer nothing) {
+    process_continue(proc);
+}
+
+static void _process_pthNotifierWakeup(gpointer arg, pth_time_t when) {
+    Process* proc = arg;
+    MAGIC_ASSERT(proc);
+
+    ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
+
+    /* pth timeouts are absolute, in the emulated time we handed out via gettimeofday */
+    EmulatedTime wakeupTime = ((EmulatedTime)when.tv_sec * SIMTIME_ONE_SECOND) +
+            ((EmulatedTime)when.tv_usec * SIMTIME_ONE_MICROSECOND);
+    EmulatedTime now = worker_getEmulatedTime();
+    SimulationTime delay = wakeupTime > now ? (SimulationTime)(wakeupTime - now) : 1;
+
+    process_ref(proc);
+    Task* continueTask = task_new((TaskCallbackFunc)_process_runContinueTask,
+            proc, NULL, (TaskObjectFreeFunc)process_unref, NULL);
+    worker_scheduleTask(continueTask, delay);
+    task_unref(continueTask);
+
+    _process_changeContext(proc, PCTX_SHADOW, prevCTX);
+}
+
 static void _process_start(Process* proc) {
     MAGIC_ASSERT(proc);
 
@@ -1050,6 +1123,8 @@ static void _process_start(Process* proc) {
 
     message("starting process '%s'", _process_getName(proc));
 
+    proc->isProfilingTasks = options_doRunTaskProfile(worker_getOptions());
+
     /* start a timer for initialization tasks */
     GTimer* initTimer = g_timer_new();
 
@@ -1067,11 +1142,24 @@ static void _process_start(Process* proc) {
     /* now we will execute in the pth/plugin context, so we need to load the state */
     worker_setActiveProcess(proc);
     proc->plugin.isExecuting = TRUE;
+
+    /* the epoll we use to continue the pth scheduler; creating it while we are
+     * the active process makes us its owner, so it will notify us */
+    proc->epollfd = host_createDescriptor(proc->host, DT_EPOLL);
+
     _process_changeContext(proc, PCTX_SHADOW, PCTX_PTH);
 
     /* create a new global context for this process, 0 means it should never block */
     proc->tstate = pth_gctx_new(0);
 
+    /* rpth learns about readiness and timeouts from us directly */
+    pth_notifier_t pthNotifier;
+    pthNotifier.arg = proc;
+    pthNotifier.watch = _process_pthNotifierWatch;
+    pthNotifier.collect = _process_pthNotifierCollect;
+    pthNotifier.wakeup = _process_pthNotifierWakeup;
+    pth_gctx_set_notifier(proc->tstate, &pthNotifier);
+
     /* we are in pth land, load in the pth state for this process */
     pth_gctx_t prevPthGlobalContext = pth_gctx_get();
     pth_gctx_set(proc->tstate);
@@ -1079,9 +1167,6 @@ static void _process_start(Process* proc) {
     /* pth_gctx_new implicitly created a 'main' thread, which shadow now runs in */
     proc->shadowThread = pth_self();
 
-    /* it also created a special epollfd which we will use to continue the pth scheduler */
-    proc->epollfd = pth_gctx_get_main_epollfd(proc->tstate);
-
     /* set some defaults for out special shadow thread: not joinable, and set the
      * min (worst) priority so that all other threads will run before coming back to shadow
      * (the main thread is special in pth, and has a stack size of 0 internally ) */
@@ -1094,7 +1179,7 @@ static void _process_start(Process* proc) {
     /* spawn the program main thread: joinable by default, bigger stack */
     pth_attr_t programMainThreadAttr = pth_attr_new();
     pth_attr_set(programMainThreadAttr, PTH_ATTR_NAME, programMainThreadNameBuf->str);
-    pth_attr_set(programMainThreadAttr, PTH_ATTR_STACK_SIZE, PROC_PTH_STACK_SIZE);
+    pth_attr_set(programMainThreadAttr, PTH_ATTR_STACK_SIZE, (unsigned int)proc->plugin.stackSize);
     proc->programMainThread = pth_spawn(programMainThreadAttr, (PthSpawnFunc)_process_executeMain, proc);
     pth_attr_destroy(programMainThreadAttr);
 
@@ -1304,6 +1389,11 @@ void process_stop(Process* proc) {
 
     /* the pth threads finished or blocked somewhere and we are back in shadow land */
     _process_changeContext(proc, PCTX_PTH, PCTX_SHADOW);
+
+    if(proc->epollfd > 0) {
+        host_closeUser(proc->host, proc->epollfd);
+        proc->epollfd = 0;
+    }
     proc->plugin.isExecuting = FALSE;
     worker_setActiveProcess(NULL);
 
@@ -1366,6 +1456,14 @@ gboolean process_shouldEmulate(Process* proc) {
     return ((!proc) || (proc->activeContext == PCTX_SHADOW)) ? FALSE : TRUE;
 }
 
+ProcessTimePage* process_updateTimePage(Process* proc) {
+    MAGIC_ASSERT(proc);
+    /* the clock does not advance while the process runs, so this stays valid
+     * until shadow resumes the process again */
+    proc->timePage.now = worker_getEmulatedTime();
+    return &(proc->timePage);
+}
+
 void process_migrate(Process* proc, gpointer threads) {
     MAGIC_ASSERT(proc);
     struct ProcessMigrateArgs* ts = threads;
@@ -1452,7 +1550,31 @@ static gint _process_emu_addressHelper(Process* proc, gint fd, const struct sock
     return 0;
 }
 
-static gssize _process_emu_sendHelper(Process* proc, gint fd, gconstpointer buf, gsize n, gint flags,
+static void _process_emu_waitForDescriptor(Process* proc, gint fd, gint flags, gboolean isWriting) {
+    /* this function MUST be called after switching in shadow context */
+    utility_assert(proc->activeContext == PCTX_SHADOW);
+
+    Descriptor* descriptor = host_lookupDescriptor(proc->host, fd);
+    if(descriptor == NULL || (descriptor_getFlags(descriptor) & O_NONBLOCK) || (flags & MSG_DONTWAIT)) {
+        return;
+    }
+
+    /* a blocking socket waits in pth until shadow marks it ready, like pth_send and pth_recv */
+    DescriptorStatus goal = isWriting ? DS_WRITABLE : DS_READABLE;
+    DescriptorStatus status = descriptor_getStatus(descriptor);
+    if((status & DS_ACTIVE) && (status & goal)) {
+        return;
+    }
+
+    _process_changeContext(proc, PCTX_SHADOW, PCTX_PTH);
+    utility_assert(proc->tstate == pth_gctx_get());
+    pth_event_t ev = pth_event(PTH_EVENT_FD|(isWriting ? PTH_UNTIL_FD_WRITEABLE : PTH_UNTIL_FD_READABLE), fd);
+    pth_wait(ev);
+    pth_event_free(ev, PTH_FREE_THIS);
+    _process_changeContext(proc, PCTX_PTH, PCTX_SHADOW);
+}
+
+static gssize _process_emu_sendHelper(Process* proc, gint fd, const struct iovec* iov, gint iovcnt, gint flags,
         const struct sockaddr* addr, socklen_t len) {
     /* this function MUST be called after switching in shadow context */
     utility_assert(proc->activeContext == PCTX_SHADOW);
@@ -1475,7 +1597,7 @@ static gssize _process_emu_sendHelper(Process* proc, gint fd, gconstpointer buf,
     }
 
     gsize bytes = 0;
-    gint result = host_sendUserData(proc->host, fd, buf, n, ip, port, &bytes);
+    gint result = host_sendUserData(proc->host, fd, iov, iovcnt, ip, port, &bytes);
 
     if(result != 0) {
         _process_setErrno(proc, result);
@@ -1484,7 +1606,7 @@ static gssize _process_emu_sendHelper(Process* proc, gint fd, gconstpointer buf,
     return (gssize) bytes;
 }
 
-static gssize _process_emu_recvHelper(Process* proc, gint fd, gpointer buf, size_t n, gint flags,
+static gssize _process_emu_recvHelper(Process* proc, gint fd, const struct iovec* iov, gint iovcnt, gint flags,
         struct sockaddr* addr, socklen_t* len) {
     /* this function MUST be called after switching in shadow context */
     utility_assert(proc->activeContext == PCTX_SHADOW);
@@ -1500,7 +1622,7 @@ static gssize _process_emu_recvHelper(Process* proc, gint fd, gpointer buf, size
     in_port_t port = 0;
 
     gsize bytes = 0;
-    gint result = host_receiveUserData(proc->host, fd, buf, n, &ip, &port, &bytes);
+    gint result = host_receiveUserData(proc->host, fd, iov, iovcnt, &ip, &port, &bytes);
 
     if(result != 0) {
         _process_setErrno(proc, result);
@@ -1625,6 +1747,81 @@ static gint _process_emu_ioctlHelper(Process* proc, int fd, unsigned long int re
     return result;
 }
 
+static void _process_emu_waitForEvents(Process* proc, struct pollfd *fds, nfds_t nfds, const struct timespec *timeout) {
+    /* this function MUST be called after switching in shadow context */
+    utility_assert(proc->activeContext == PCTX_SHADOW);
+
+    /* wait on the requested descriptors directly with pth fd events. pth adds them
+     * to its own epoll, so a status change on any of them wakes us through the
+     * existing epoll notification path, and the plugin never sees an extra handle. */
+    gint* watchFDs = g_new0(gint, MAX(nfds, 1));
+    gint* watchGoals = g_new0(gint, MAX(nfds, 1));
+    guint nWatches = 0;
+
+    for(nfds_t i = 0; i < nfds; i++) {
+        if(fds[i].fd < 0 || fds[i].events == 0) {
+            continue;
+        }
+
+        /* system files cannot be watched, and bad or closed descriptors are
+         * reported by the caller. skip them and still wait on the rest. */
+        if(!host_isShadowDescriptor(proc->host, fds[i].fd)) {
+            continue;
+        }
+        Descriptor* descriptor = host_lookupDescriptor(proc->host, fds[i].fd);
+        if(!descriptor || (descriptor_getStatus(descriptor) & DS_CLOSED)) {
+            continue;
+        }
+
+        gint goal = 0;
+        if(fds[i].events & (POLLIN|POLLRDNORM)) {
+            goal |= PTH_UNTIL_FD_READABLE;
+        }
+        if(fds[i].events & (POLLOUT|POLLWRNORM|POLLWRBAND)) {
+            goal |= PTH_UNTIL_FD_WRITEABLE;
+        }
+        if(fds[i].events & (POLLPRI|POLLRDBAND)) {
+            goal |= PTH_UNTIL_FD_EXCEPTION;
+        }
+
+        if(goal) {
+            watchFDs[nWatches] = fds[i].fd;
+            watchGoals[nWatches] = goal;
+            nWatches++;
+        }
+    }
+
+    /* with nothing to watch and no timeout, we block until pth wakes us up again */
+    struct timespec forever;
+    forever.tv_sec = (__time_t)INT_MAX;
+    forever.tv_nsec = 999999999;
+    if(timeout == NULL && nWatches == 0) {
+        timeout = &forever;
+    }
+
+    _process_changeContext(proc, PCTX_SHADOW, PCTX_PTH);
+    utility_assert(proc->tstate == pth_gctx_get());
+
+    pth_event_t evRing = NULL;
+    for(guint i = 0; i < nWatches; i++) {
+        pth_event_t ev = pth_event(PTH_EVENT_FD|watchGoals[i], watchFDs[i]);
+        evRing = (evRing == NULL) ? ev : pth_event_concat(evRing, ev, NULL);
+    }
+    if(timeout != NULL) {
+        pth_event_t evTimeout = pth_event(PTH_EVENT_TIME,
+                pth_timeout(timeout->tv_sec, (timeout->tv_nsec)/1000));
+        evRing = (evRing == NULL) ? evTimeout : pth_event_concat(evRing, evTimeout, NULL);
+    }
+
+    pth_wait(evRing);
+    pth_event_free(evRing, PTH_FREE_ALL);
+
+    _process_changeContext(proc, PCTX_PTH, PCTX_SHADOW);
+
+    g_free(watchFDs);
+    g_free(watchGoals);
+}
+
 static int _process_emu_selectHelper(Process* proc, int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds, const struct timespec *timeout) {
     /* this function MUST be called after switching in shadow context */
     utility_assert(proc->activeContext == PCTX_SHADOW);
@@ -1640,81 +1837,67 @@ static int _process_emu_selectHelper(Process* proc, int nfds, fd_set *readfds, f
         pth_nanosleep(timeout, NULL);
         _process_changeContext(proc, PCTX_PTH, PCTX_SHADOW);
     } else {
-        fd_set* tmpReadFDs = NULL;
+        fd_set tmpReadFDs, tmpWriteFDs, tmpExceptFDs;
         if(readfds) {
-            tmpReadFDs = g_new0(fd_set, 1);
-            FD_ZERO(tmpReadFDs);
-            g_memmove(tmpReadFDs, readfds, sizeof(fd_set));
+            tmpReadFDs = *readfds;
         }
-        fd_set* tmpWriteFDs = NULL;
         if(writefds) {
-            tmpWriteFDs = g_new0(fd_set, 1);
-            FD_ZERO(tmpWriteFDs);
-            g_memmove(tmpWriteFDs, writefds, sizeof(fd_set));
+            tmpWriteFDs = *writefds;
         }
-        fd_set* tmpExceptFDs = NULL;
         if(exceptfds) {
-            tmpExceptFDs = g_new0(fd_set, 1);
-            FD_ZERO(tmpExceptFDs);
-            g_memmove(tmpExceptFDs, exceptfds, sizeof(fd_set));
-        }
-
-        ret = host_select(proc->host, tmpReadFDs, tmpWriteFDs, tmpExceptFDs);
-
-        if(ret == 0) {
-            /* we have no events */
-            struct timespec forever;
-            forever.tv_sec = (__time_t)INT_MAX;
-            forever.tv_nsec = 999999999;
-            const struct timespec* sleepTime = NULL;
-
-            if(timeout == NULL) {
-                /* block indefinitely (until pth wakes us up again) */
-                sleepTime = &forever;
-            } else if(timeout->tv_sec > 0 || timeout->tv_nsec > 0) {
-                /* return after timeout fires */
-                sleepTime = timeout;
-            } else {
-                /* timeout != NULL && timeout->tv_sec == 0 && timeout->tv_nsec == 0 */
-                /* return immediately */
-                sleepTime = NULL;
-            }
+            tmpExceptFDs = *exceptfds;
+        }
 
-            if(sleepTime) {
-                _process_changeContext(proc, PCTX_SHADOW, PCTX_PTH);
-                utility_assert(proc->tstate == pth_gctx_get());
-                pth_nanosleep(sleepTime, NULL);
-                _process_changeContext(proc, PCTX_PTH, PCTX_SHADOW);
+        ret = host_select(proc->host, nfds, readfds ? &tmpReadFDs : NULL,
+                writefds ? &tmpWriteFDs : NULL, exceptfds ? &tmpExceptFDs : NULL);
+
+        gboolean shouldBlock = (timeout == NULL) || timeout->tv_sec > 0 || timeout->tv_nsec > 0;
 
-                /* ask shadow again */
-                if(tmpReadFDs) {
-                    FD_ZERO(tmpReadFDs);
-                    g_memmove(tmpReadFDs, readfds, sizeof(fd_set));
+        if(ret == 0 && shouldBlock) {
+            /* we have no events, so wait for a status change on the requested
+             * descriptors (or the timeout) and then ask shadow again */
+            struct pollfd* pollFDs = g_new0(struct pollfd, MAX(nfds, 1));
+            nfds_t numPollFDs = 0;
+            for(gint fd = 0; fd < nfds; fd++) {
+                gshort events = 0;
+                if(readfds && FD_ISSET(fd, readfds)) {
+                    events |= POLLIN;
                 }
-                if(tmpWriteFDs) {
-                    FD_ZERO(tmpWriteFDs);
-                    g_memmove(tmpWriteFDs, writefds, sizeof(fd_set));
+                if(writefds && FD_ISSET(fd, writefds)) {
+                    events |= POLLOUT;
                 }
-                if(tmpExceptFDs) {
-                    FD_ZERO(tmpExceptFDs);
-                    g_memmove(tmpExceptFDs, exceptfds, sizeof(fd_set));
+                if(events) {
+                    pollFDs[numPollFDs].fd = fd;
+                    pollFDs[numPollFDs].events = events;
+                    numPollFDs++;
                 }
+            }
+
+            _process_emu_waitForEvents(proc, pollFDs, numPollFDs, timeout);
+            g_free(pollFDs);
 
-                ret = host_select(proc->host, tmpReadFDs, tmpWriteFDs, tmpExceptFDs);
+            if(readfds) {
+                tmpReadFDs = *readfds;
             }
+            if(writefds) {
+                tmpWriteFDs = *writefds;
+            }
+            if(exceptfds) {
+                tmpExceptFDs = *exceptfds;
+            }
+
+            ret = host_select(proc->host, nfds, readfds ? &tmpReadFDs : NULL,
+                    writefds ? &tmpWriteFDs : NULL, exceptfds ? &tmpExceptFDs : NULL);
         }
 
-        if(tmpReadFDs) {
-            g_memmove(readfds, tmpReadFDs, sizeof(fd_set));
-            g_free(tmpReadFDs);
+        if(readfds) {
+            *readfds = tmpReadFDs;
         }
-        if(tmpWriteFDs) {
-            g_memmove(writefds, tmpWriteFDs, sizeof(fd_set));
-            g_free(tmpWriteFDs);
+        if(writefds) {
+            *writefds = tmpWriteFDs;
         }
-        if(tmpExceptFDs) {
-            g_memmove(exceptfds, tmpExceptFDs, sizeof(fd_set));
-            g_free(tmpExceptFDs);
+        if(exceptfds) {
+            *exceptfds = tmpExceptFDs;
         }
     }
 
@@ -1738,14 +1921,18 @@ static int _process_emu_pollHelper(Process* proc, struct pollfd *fds, nfds_t nfd
     if(((gsize)nfds) > proc->fdLimit) {
         _process_setErrno(proc, EINVAL);
         ret = -1;
-    } else if(timeout_ts == NULL || timeout_ts->tv_sec != 0 || timeout_ts->tv_nsec != 0) {
-        /* either we should block forever, or block until a valid timeout,
-         * neither of which shadow supports */
-        warning("poll is trying to block, but Shadow doesn't support blocking without pth");
-        _process_setErrno(proc, EINTR);
-        ret = -1;
     } else {
         ret = host_poll(proc->host, fds, nfds);
+
+        gboolean shouldBlock = (timeout_ts == NULL) || timeout_ts->tv_sec != 0 || timeout_ts->tv_nsec != 0;
+
+        if(ret == 0 && shouldBlock) {
+            /* nothing is ready yet, so block until a status change on one of
+             * the descriptors (or the timeout) and then ask shadow again */
+            _process_emu_waitForEvents(proc, fds, nfds, timeout_ts);
+            ret = host_poll(proc->host, fds, nfds);
+        }
+
         if(ret < 0) {
             _process_setErrno(proc, errno);
         }
@@ -1818,12 +2005,65 @@ static int _process_emu_epollWaitHelper(Process* proc, int epfd, struct epoll_ev
 
 /* memory allocation family */
 
+/* returns the tracker if it wants allocation stats, so that we only pay for
+ * the accounting when the 'ram' heartbeat was requested */
+static Tracker* _process_getAllocationTracker(Process* proc) {
+    Tracker* tracker = host_getTracker(proc->host);
+    return (tracker && tracker_isTrackingAllocations(tracker)) ? tracker : NULL;
+}
+
+static Arena* _process_getArenaFor(Process* proc, gconstpointer ptr) {
+    Arena* arena = host_getArena(proc->host);
+    return (arena && ptr && arena_contains(arena, ptr)) ? arena : NULL;
+}
+
+static gsize _process_getUsableSize(Process* proc, gpointer ptr) {
+    Arena* arena = _process_getArenaFor(proc, ptr);
+    return arena ? arena_getUsableSize(arena, ptr) : (gsize)malloc_usable_size(ptr);
+}
+
+/* the tracker keeps the size of each block in a tag at its end, so make room for it.
+ * zero stays zero, so that realloc still frees. */
+static gsize _process_getAllocationSize(Process* proc, gsize size) {
+    gsize tagSize = _process_getAllocationTracker(proc) ? tracker_getAllocationTagSize() : 0;
+    if(size == 0 || tagSize == 0) {
+        return size;
+    }
+    /* an impossible size makes the allocator fail with ENOMEM */
+    return (size <= G_MAXSIZE - tagSize) ? size + tagSize : G_MAXSIZE;
+}
+
+/* returns NULL if the host has no arena or it cannot satisfy the request,
+ * in which case the caller falls back to the shared heap */
+static gpointer _process_allocateFromArena(Process* proc, gsize alignment, gsize size) {
+    Arena* arena = host_getArena(proc->host);
+    return arena ? arena_allocate(arena, alignment, size) : NULL;
+}
+
+static void _process_trackAllocation(Process* proc, gpointer ptr) {
+    Tracker* tracker = NULL;
+    if(ptr != NULL && (tracker = _process_getAllocationTracker(proc)) != NULL) {
+        tracker_addAllocatedBytes(tracker, ptr, _process_getUsableSize(proc, ptr));
+    }
+}
+
+static void _process_trackDeallocation(Process* proc, gpointer ptr) {
+    Tracker* tracker = NULL;
+    if(ptr != NULL && (tracker = _process_getAllocationTracker(proc)) != NULL) {
+        tracker_removeAllocatedBytes(tracker, ptr, _process_getUsableSize(proc, ptr));
+    }
+}
+
 void* process_emu_malloc(Process* proc, size_t size) {
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
 
-    void* ptr = malloc(size);
-    if(size && ptr != NULL) {
-        tracker_addAllocatedBytes(host_getTracker(proc->host), ptr, size);
+    gsize allocSize = _process_getAllocationSize(proc, size);
+    void* ptr = _process_allocateFromArena(proc, 0, allocSize);
+    if(ptr == NULL) {
+        ptr = malloc(allocSize);
+    }
+    if(size) {
+        _process_trackAllocation(proc, ptr);
     }
     if(ptr == NULL) {
         _process_setErrno(proc, errno);
@@ -1836,9 +2076,22 @@ void* process_emu_malloc(Process* proc, size_t size) {
 void* process_emu_calloc(Process* proc, size_t nmemb, size_t size) {
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
 
-    void* ptr = calloc(nmemb, size);
-    if(size && ptr != NULL) {
-        tracker_addAllocatedBytes(host_getTracker(proc->host), ptr, size);
+    void* ptr = NULL;
+    if(size == 0 || nmemb <= G_MAXSIZE / size) {
+        gsize allocSize = _process_getAllocationSize(proc, nmemb * size);
+        /* recycled arena blocks are not zeroed */
+        ptr = _process_allocateFromArena(proc, 0, allocSize);
+        if(ptr != NULL) {
+            memset(ptr, 0, allocSize);
+        } else {
+            ptr = calloc(1, allocSize);
+        }
+    } else {
+        /* let libc report the overflow */
+        ptr = calloc(nmemb, size);
+    }
+    if(size) {
+        _process_trackAllocation(proc, ptr);
     }
     if(ptr == NULL) {
         _process_setErrno(proc, errno);
@@ -1851,26 +2104,43 @@ void* process_emu_calloc(Process* proc, size_t nmemb, size_t size) {
 void* process_emu_realloc(Process* proc, void *ptr, size_t size) {
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
 
-    gpointer newptr = realloc(ptr, size);
-    if(newptr != NULL) {
-        if(ptr == NULL) {
-            /* equivalent to malloc */
-            if(size) {
-                tracker_addAllocatedBytes(host_getTracker(proc->host), newptr, size);
-            }
-        } else if (size == 0) {
-            /* equivalent to free */
-            tracker_removeAllocatedBytes(host_getTracker(proc->host), ptr);
-        } else {
-            /* true realloc */
-            tracker_removeAllocatedBytes(host_getTracker(proc->host), ptr);
-            if(size) {
-                tracker_addAllocatedBytes(host_getTracker(proc->host), newptr, size);
-            }
+    Tracker* tracker = _process_getAllocationTracker(proc);
+    gsize allocSize = _process_getAllocationSize(proc, size);
+
+    /* the tag is at the end of the old block, so take it out while the block still exists */
+    gboolean wasTagged = FALSE;
+    if(tracker && ptr != NULL) {
+        wasTagged = tracker_removeAllocatedBytes(tracker, ptr, _process_getUsableSize(proc, ptr));
+    }
+
+    gpointer newptr = NULL;
+    Arena* arena = _process_getArenaFor(proc, ptr);
+    if(ptr == NULL) {
+        newptr = _process_allocateFromArena(proc, 0, allocSize);
+        if(newptr == NULL) {
+            newptr = malloc(allocSize);
         }
+    } else if(arena && size == 0) {
+        arena_deallocate(arena, ptr);
+    } else if(arena) {
+        newptr = arena_reallocate(arena, ptr, allocSize);
+        if(newptr == NULL && (newptr = malloc(allocSize)) != NULL) {
+            /* the arena is full, move the block to the shared heap */
+            memcpy(newptr, ptr, arena_getUsableSize(arena, ptr));
+            arena_deallocate(arena, ptr);
+        }
+    } else {
+        newptr = realloc(ptr, allocSize);
     }
 
-    if(newptr == NULL) {
+    if(tracker && newptr != NULL && size) {
+        tracker_addAllocatedBytes(tracker, newptr, _process_getUsableSize(proc, newptr));
+    } else if(tracker && newptr == NULL && size && wasTagged) {
+        /* the old block is still valid and needs its tag back */
+        tracker_addAllocatedBytes(tracker, ptr, _process_getUsableSize(proc, ptr));
+    }
+
+    if(newptr == NULL && size) {
         _process_setErrno(proc, errno);
     }
 
@@ -1878,20 +2148,42 @@ void* process_emu_realloc(Process* proc, void *ptr, size_t size) {
     return newptr;
 }
 
+size_t process_emu_malloc_usable_size(Process* proc, void *ptr) {
+    ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
+    size_t ret = ptr ? (size_t)_process_getUsableSize(proc, ptr) : 0;
+    if(_process_getAllocationTracker(proc) && ret >= tracker_getAllocationTagSize()) {
+        /* the plugin must not write over the tracker's tag */
+        ret -= tracker_getAllocationTagSize();
+    }
+    _process_changeContext(proc, PCTX_SHADOW, prevCTX);
+    return ret;
+}
+
 void process_emu_free(Process* proc, void *ptr) {
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
-    free(ptr);
-    if(ptr != NULL) {
-        tracker_removeAllocatedBytes(host_getTracker(proc->host), ptr);
+    _process_trackDeallocation(proc, ptr);
+    Arena* arena = _process_getArenaFor(proc, ptr);
+    if(arena) {
+        arena_deallocate(arena, ptr);
+    } else {
+        free(ptr);
     }
     _process_changeContext(proc, PCTX_SHADOW, prevCTX);
 }
 
 int process_emu_posix_memalign(Process* proc, void** memptr, size_t alignment, size_t size) {
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
-    gint ret = posix_memalign(memptr, alignment, size);
+    gint ret = 0;
+    /* let libc handle (and reject) alignments the arena does not accept */
+    gsize allocSize = _process_getAllocationSize(proc, size);
+    gpointer ptr = (alignment % sizeof(void*) == 0) ? _process_allocateFromArena(proc, alignment, allocSize) : NULL;
+    if(ptr != NULL) {
+        *memptr = ptr;
+    } else {
+        ret = posix_memalign(memptr, alignment, allocSize);
+    }
     if(ret == 0 && size) {
-        tracker_addAllocatedBytes(host_getTracker(proc->host), *memptr, size);
+        _process_trackAllocation(proc, *memptr);
     }
     _process_changeContext(proc, PCTX_SHADOW, prevCTX);
     return ret;
@@ -1899,9 +2191,13 @@ int process_emu_posix_memalign(Process* proc, void** memptr, size_t alignment, s
 
 void* process_emu_memalign(Process* proc, size_t blocksize, size_t bytes) {
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
-    gpointer ptr = memalign(blocksize, bytes);
-    if(bytes && ptr != NULL) {
-        tracker_addAllocatedBytes(host_getTracker(proc->host), ptr, bytes);
+    gsize allocSize = _process_getAllocationSize(proc, bytes);
+    gpointer ptr = _process_allocateFromArena(proc, blocksize, allocSize);
+    if(ptr == NULL) {
+        ptr = memalign(blocksize, allocSize);
+    }
+    if(bytes) {
+        _process_trackAllocation(proc, ptr);
     }
     if(ptr == NULL) {
         _process_setErrno(proc, errno);
@@ -1913,9 +2209,13 @@ void* process_emu_memalign(Process* proc, size_t blocksize, size_t bytes) {
 /* aligned_alloc doesnt exist in glibc in the current LTS version of ubuntu */
 void* process_emu_aligned_alloc(Process* proc, size_t alignment, size_t size) {
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
-    gpointer ptr = aligned_alloc(alignment, size);
-    if(size && ptr != NULL) {
-        tracker_addAllocatedBytes(host_getTracker(proc->host), ptr, size);
+    gsize allocSize = _process_getAllocationSize(proc, size);
+    gpointer ptr = _process_allocateFromArena(proc, alignment, allocSize);
+    if(ptr == NULL) {
+        ptr = aligned_alloc(alignment, allocSize);
+    }
+    if(size) {
+        _process_trackAllocation(proc, ptr);
     }
     if(ptr == NULL) {
         _process_setErrno(proc, errno);
@@ -1926,9 +2226,13 @@ void* process_emu_aligned_alloc(Process* proc, size_t alignment, size_t size) {
 
 void* process_emu_valloc(Process* proc, size_t size) {
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
-    gpointer ptr = valloc(size);
-    if(size && ptr != NULL) {
-        tracker_addAllocatedBytes(host_getTracker(proc->host), ptr, size);
+    gsize allocSize = _process_getAllocationSize(proc, size);
+    gpointer ptr = _process_allocateFromArena(proc, (gsize)sysconf(_SC_PAGESIZE), allocSize);
+    if(ptr == NULL) {
+        ptr = valloc(allocSize);
+    }
+    if(size) {
+        _process_trackAllocation(proc, ptr);
     }
     if(ptr == NULL) {
         _process_setErrno(proc, errno);
@@ -1939,9 +2243,18 @@ void* process_emu_valloc(Process* proc, size_t size) {
 
 void* process_emu_pvalloc(Process* proc, size_t size) {
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
-    gpointer ptr = pvalloc(size);
-    if(size && ptr != NULL) {
-        tracker_addAllocatedBytes(host_getTracker(proc->host), ptr, size);
+    gsize pageSize = (gsize)sysconf(_SC_PAGESIZE);
+    gsize allocSize = _process_getAllocationSize(proc, size);
+    gpointer ptr = NULL;
+    if(allocSize <= G_MAXSIZE - pageSize) {
+        /* pvalloc rounds the size up to a whole number of pages */
+        ptr = _process_allocateFromArena(proc, pageSize, (allocSize + pageSize - 1) & ~(pageSize - 1));
+    }
+    if(ptr == NULL) {
+        ptr = pvalloc(allocSize);
+    }
+    if(size) {
+        _process_trackAllocation(proc, ptr);
     }
     if(ptr == NULL) {
         _process_setErrno(proc, errno);
@@ -2240,7 +2553,8 @@ ssize_t process_emu_send(Process* proc, int fd, const void *buf, size_t n, int f
             _process_setErrno(proc, errno);
         }
     } else {
-        ret = _process_emu_sendHelper(proc, fd, buf, n, flags, NULL, 0);
+        struct iovec iov = {(void*)buf, n};
+        ret = _process_emu_sendHelper(proc, fd, &iov, 1, flags, NULL, 0);
     }
     _process_changeContext(proc, PCTX_SHADOW, prevCTX);
     return ret;
@@ -2258,19 +2572,45 @@ ssize_t process_emu_sendto(Process* proc, int fd, const void *buf, size_t n, int
             _process_setErrno(proc, errno);
         }
     } else {
-        ret = _process_emu_sendHelper(proc, fd, buf, n, flags, addr, addr_len);
+        struct iovec iov = {(void*)buf, n};
+        ret = _process_emu_sendHelper(proc, fd, &iov, 1, flags, addr, addr_len);
     }
     _process_changeContext(proc, PCTX_SHADOW, prevCTX);
     return ret;
 }
 
 ssize_t process_emu_sendmsg(Process* proc, int fd, const struct msghdr *message, int flags) {
-    /* TODO implement */
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
-    warning("sendmsg not implemented");
-    _process_setErrno(proc, ENOSYS);
+    gssize ret = 0;
+
+    if(message == NULL) {
+        _process_setErrno(proc, EFAULT);
+        ret = -1;
+    } else if(!host_isShadowDescriptor(proc->host, fd)) {
+        gint osfd = host_getOSHandle(proc->host, fd);
+        if(osfd >= 0) {
+            ret = sendmsg(osfd, message, flags);
+            if(ret < 0) {
+                _process_setErrno(proc, errno);
+            }
+        } else {
+            _process_setErrno(proc, EBADF);
+            ret = -1;
+        }
+    } else if(message->msg_iovlen > IOV_MAX) {
+        _process_setErrno(proc, EMSGSIZE);
+        ret = -1;
+    } else {
+        if(prevCTX == PCTX_PLUGIN) {
+            _process_emu_waitForDescriptor(proc, fd, flags, TRUE);
+        }
+        /* ancillary data is ignored, the payload is gathered straight from the iovecs */
+        ret = _process_emu_sendHelper(proc, fd, message->msg_iov, (gint)message->msg_iovlen,
+                flags, (const struct sockaddr*)message->msg_name, message->msg_namelen);
+    }
+
     _process_changeContext(proc, PCTX_SHADOW, prevCTX);
-    return -1;
+    return ret;
 }
 
 ssize_t process_emu_recv(Process* proc, int fd, void *buf, size_t n, int flags) {
@@ -2285,7 +2625,8 @@ ssize_t process_emu_recv(Process* proc, int fd, void *buf, size_t n, int flags)
             _process_setErrno(proc, errno);
         }
     } else {
-        ret = _process_emu_recvHelper(proc, fd, buf, n, flags, NULL, 0);
+        struct iovec iov = {buf, n};
+        ret = _process_emu_recvHelper(proc, fd, &iov, 1, flags, NULL, 0);
     }
     _process_changeContext(proc, PCTX_SHADOW, prevCTX);
     return ret;
@@ -2303,19 +2644,176 @@ ssize_t process_emu_recvfrom(Process* proc, int fd, void *buf, size_t n, int fla
             _process_setErrno(proc, errno);
         }
     } else {
-        ret = _process_emu_recvHelper(proc, fd, buf, n, flags, addr, addr_len);
+        struct iovec iov = {buf, n};
+        ret = _process_emu_recvHelper(proc, fd, &iov, 1, flags, addr, addr_len);
     }
     _process_changeContext(proc, PCTX_SHADOW, prevCTX);
     return ret;
 }
 
 ssize_t process_emu_recvmsg(Process* proc, int fd, struct msghdr *message, int flags) {
-    /* TODO implement */
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
-    warning("recvmsg not implemented");
-    _process_setErrno(proc, ENOSYS);
+    gssize ret = 0;
+
+    if(message == NULL) {
+        _process_setErrno(proc, EFAULT);
+        ret = -1;
+    } else if(!host_isShadowDescriptor(proc->host, fd)) {
+        gint osfd = host_getOSHandle(proc->host, fd);
+        if(osfd >= 0) {
+            ret = recvmsg(osfd, message, flags);
+            if(ret < 0) {
+                _process_setErrno(proc, errno);
+            }
+        } else {
+            _process_setErrno(proc, EBADF);
+            ret = -1;
+        }
+    } else if(message->msg_iovlen > IOV_MAX) {
+        _process_setErrno(proc, EMSGSIZE);
+        ret = -1;
+    } else {
+        if(prevCTX == PCTX_PLUGIN) {
+            _process_emu_waitForDescriptor(proc, fd, flags, FALSE);
+        }
+        /* the payload is scattered straight into the iovecs, we have no ancillary data */
+        ret = _process_emu_recvHelper(proc, fd, message->msg_iov, (gint)message->msg_iovlen,
+                flags, (struct sockaddr*)message->msg_name,
+                message->msg_name ? &(message->msg_namelen) : NULL);
+        message->msg_controllen = 0;
+        message->msg_flags = 0;
+    }
+
     _process_changeContext(proc, PCTX_SHADOW, prevCTX);
-    return -1;
+    return ret;
+}
+
+int process_emu_sendmmsg(Process* proc, int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags) {
+    ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
+    gint ret = 0;
+
+    if(msgvec == NULL) {
+        _process_setErrno(proc, EFAULT);
+        ret = -1;
+    } else if(!host_isShadowDescriptor(proc->host, fd)) {
+        gint osfd = host_getOSHandle(proc->host, fd);
+        if(osfd >= 0) {
+            ret = sendmmsg(osfd, msgvec, vlen, flags);
+            if(ret < 0) {
+                _process_setErrno(proc, errno);
+            }
+        } else {
+            _process_setErrno(proc, EBADF);
+            ret = -1;
+        }
+    } else {
+        /* the kernel silently caps the batch at UIO_MAXIOV (== IOV_MAX) messages */
+        vlen = MIN(vlen, (unsigned int)IOV_MAX);
+
+        if(prevCTX == PCTX_PLUGIN && vlen > 0) {
+            _process_emu_waitForDescriptor(proc, fd, flags, TRUE);
+        }
+
+        /* send the whole batch without leaving shadow context. we stop at the
+         * first failure, which is only reported if nothing was sent */
+        gint numSent = 0;
+        for(unsigned int i = 0; i < vlen; i++) {
+            struct msghdr* message = &(msgvec[i].msg_hdr);
+            if(message->msg_iovlen > IOV_MAX) {
+                if(numSent == 0) {
+                    _process_setErrno(proc, EMSGSIZE);
+                    numSent = -1;
+                }
+                break;
+            }
+
+            gssize n = _process_emu_sendHelper(proc, fd, message->msg_iov, (gint)message->msg_iovlen,
+                    flags, (const struct sockaddr*)message->msg_name, message->msg_namelen);
+            if(n < 0) {
+                if(numSent == 0) {
+                    numSent = -1;
+                }
+                break;
+            }
+
+            msgvec[i].msg_len = (unsigned int)n;
+            numSent++;
+        }
+        ret = numSent;
+    }
+
+    _process_changeContext(proc, PCTX_SHADOW, prevCTX);
+    return ret;
+}
+
+int process_emu_recvmmsg(Process* proc, int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags, struct timespec *timeout) {
+    ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
+    gint ret = 0;
+
+    if(msgvec == NULL) {
+        _process_setErrno(proc, EFAULT);
+        ret = -1;
+    } else if(!host_isShadowDescriptor(proc->host, fd)) {
+        gint osfd = host_getOSHandle(proc->host, fd);
+        if(osfd >= 0) {
+            ret = recvmmsg(osfd, msgvec, vlen, flags, timeout);
+            if(ret < 0) {
+                _process_setErrno(proc, errno);
+            }
+        } else {
+            _process_setErrno(proc, EBADF);
+            ret = -1;
+        }
+    } else {
+        vlen = MIN(vlen, (unsigned int)IOV_MAX);
+
+        /* a blocking socket only waits for the first message, the rest of the
+         * batch is whatever is already queued (as with MSG_WAITFORONE). since
+         * we never block after the first message, the timeout is not needed */
+        if(prevCTX == PCTX_PLUGIN && vlen > 0) {
+            _process_emu_waitForDescriptor(proc, fd, flags, FALSE);
+        }
+
+        /* a zero-length read is EOF on a stream, but a valid empty datagram on udp */
+        Descriptor* descriptor = host_lookupDescriptor(proc->host, fd);
+        gboolean isStream = descriptor != NULL && descriptor_getType(descriptor) != DT_UDPSOCKET;
+
+        gint numReceived = 0;
+        for(unsigned int i = 0; i < vlen; i++) {
+            struct msghdr* message = &(msgvec[i].msg_hdr);
+            if(message->msg_iovlen > IOV_MAX) {
+                if(numReceived == 0) {
+                    _process_setErrno(proc, EMSGSIZE);
+                    numReceived = -1;
+                }
+                break;
+            }
+
+            gssize n = _process_emu_recvHelper(proc, fd, message->msg_iov, (gint)message->msg_iovlen,
+                    flags, (struct sockaddr*)message->msg_name,
+                    message->msg_name ? &(message->msg_namelen) : NULL);
+            if(n < 0) {
+                if(numReceived == 0) {
+                    numReceived = -1;
+                }
+                break;
+            }
+
+            message->msg_controllen = 0;
+            message->msg_flags = 0;
+            msgvec[i].msg_len = (unsigned int)n;
+            numReceived++;
+
+            if(n == 0 && isStream) {
+                /* EOF, nothing more will arrive */
+                break;
+            }
+        }
+        ret = numReceived;
+    }
+
+    _process_changeContext(proc, PCTX_SHADOW, prevCTX);
+    return ret;
 }
 
 int process_emu_getsockopt(Process* proc, int fd, int level, int optname, void* optval, socklen_t* optlen) {
@@ -2624,7 +3122,8 @@ ssize_t process_emu_read(Process* proc, int fd, void *buff, size_t numbytes) {
             if(descriptor_getType(desc) == DT_TIMER) {
                 ret = timer_read((Timer*) desc, buff, numbytes);
             } else {
-                ret = _process_emu_recvHelper(proc, fd, buff, numbytes, 0, NULL, 0);
+                struct iovec iov = {buff, numbytes};
+                ret = _process_emu_recvHelper(proc, fd, &iov, 1, 0, NULL, 0);
             }
         } else if(host_isRandomHandle(proc->host, fd)) {
             Random* random = host_getRandom(proc->host);
@@ -2674,7 +3173,8 @@ ssize_t process_emu_write(Process* proc, int fd, const void *buff, size_t n) {
         }
     } else {
         if(host_isShadowDescriptor(proc->host, fd)){
-            ret = _process_emu_sendHelper(proc, fd, buff, n, 0, NULL, 0);
+            struct iovec iov = {(void*)buff, n};
+            ret = _process_emu_sendHelper(proc, fd, &iov, 1, 0, NULL, 0);
         } else {
             gint osfd = host_getOSHandle(proc->host, fd);
             if(osfd >= 0) {
@@ -2720,36 +3220,23 @@ ssize_t process_emu_readv(Process* proc, int fd, const struct iovec *iov, int io
         if (iovcnt < 0 || iovcnt > IOV_MAX) {
             _process_setErrno(proc, EINVAL);
             ret = -1;
+        } else if (utility_getIOVecLength(iov, iovcnt) == 0) {
+            ret = 0;
         } else {
-            /* figure out how much they want to read total */
-            int i = 0;
-            size_t totalIOLength = 0;
-            for (i = 0; i < iovcnt; i++) {
-                totalIOLength += iov[i].iov_len;
-            }
-
-            if (totalIOLength == 0) {
-                ret = 0;
-            } else {
-                /* get a temporary buffer and read to it */
-                void* tempBuffer = g_malloc0(totalIOLength);
-                _process_changeContext(proc, PCTX_SHADOW, prevCTX);
-                ssize_t totalBytesRead = process_emu_read(proc, fd, tempBuffer, totalIOLength);
-                _process_changeContext(proc, prevCTX, PCTX_SHADOW);
-
-                if (totalBytesRead > 0) {
-                    /* place all of the bytes we read in the iov buffers */
-                    size_t bytesCopied = 0;
-                    for (i = 0; i < iovcnt; i++) {
-                        size_t bytesRemaining = (size_t) (totalBytesRead - bytesCopied);
-                        size_t bytesToCopy = MIN(bytesRemaining, iov[i].iov_len);
-                        g_memmove(iov[i].iov_base, tempBuffer+bytesCopied, bytesToCopy);
-                        bytesCopied += bytesToCopy;
-                    }
+            Descriptor* desc = host_lookupDescriptor(proc->host, fd);
+            if(descriptor_getType(desc) == DT_TIMER) {
+                /* timers hand out a single expiration counter */
+                guint64 expirations = 0;
+                gsize count = MIN(utility_getIOVecLength(iov, iovcnt), sizeof(guint64));
+                ret = timer_read((Timer*) desc, &expirations, count);
+                if(ret > 0) {
+                    ret = (gssize) utility_copyToIOVec(iov, iovcnt, 0, &expirations, (gsize)ret);
+                } else {
+                    _process_setErrno(proc, errno);
                 }
-
-                g_free(tempBuffer);
-                ret = totalBytesRead;
+            } else {
+                /* the transport scatters straight into the user buffers */
+                ret = _process_emu_recvHelper(proc, fd, iov, iovcnt, 0, NULL, 0);
             }
         }
     }
@@ -2785,36 +3272,11 @@ ssize_t process_emu_writev(Process* proc, int fd, const struct iovec *iov, int i
         if(iovcnt < 0 || iovcnt > IOV_MAX) {
             _process_setErrno(proc, EINVAL);
             ret = -1;
+        } else if(utility_getIOVecLength(iov, iovcnt) == 0) {
+            ret = 0;
         } else {
-            /* figure out how much they want to write total */
-            int i = 0;
-            size_t totalIOLength = 0;
-            for(i = 0; i < iovcnt; i++) {
-                totalIOLength += iov[i].iov_len;
-            }
-
-            if(totalIOLength == 0) {
-                ret = 0;
-            } else {
-                /* get a temporary buffer and write to it */
-                void* tempBuffer = g_malloc0(totalIOLength);
-                size_t bytesCopied = 0;
-                for(i = 0; i < iovcnt; i++) {
-                    g_memmove(tempBuffer+bytesCopied, iov[i].iov_base, iov[i].iov_len);
-                    bytesCopied += iov[i].iov_len;
-                }
-
-                ssize_t totalBytesWritten = 0;
-                if(bytesCopied > 0) {
-                    /* try to write all of the bytes we got from the iov buffers */
-                    _process_changeContext(proc, PCTX_SHADOW, prevCTX);
-                    totalBytesWritten = process_emu_write(proc, fd, tempBuffer, bytesCopied);
-                    _process_changeContext(proc, prevCTX, PCTX_SHADOW);
-                }
-
-                g_free(tempBuffer);
-                ret = totalBytesWritten;
-            }
+            /* the transport gathers straight from the user buffers */
+            ret = _process_emu_sendHelper(proc, fd, iov, iovcnt, 0, NULL, 0);
         }
     }
 
@@ -2897,6 +3359,329 @@ ssize_t process_emu_pwrite(Process* proc, int fd, const void *buf, size_t nbytes
     return ret;
 }
 
+static gssize _process_emu_sendFileRange(Process* proc, gint outfd, gint osInFD, off64_t* offset, gsize count) {
+    /* this function MUST be called after switching in shadow context */
+    utility_assert(proc->activeContext == PCTX_SHADOW);
+
+    /* we read at explicit positions, so that file bytes the socket did not
+     * accept are simply left in the file for the next call */
+    off64_t position = (offset != NULL) ? *offset : lseek64(osInFD, 0, SEEK_CUR);
+    if(position < 0) {
+        _process_setErrno(proc, (errno == ESPIPE) ? EINVAL : errno);
+        return -1;
+    }
+
+    gsize bufferLength = MIN(count, CONFIG_FILE_TRANSFER_CHUNK_SIZE);
+    if(bufferLength == 0) {
+        return 0;
+    }
+    guchar* buffer = g_malloc(bufferLength);
+
+    gssize ret = 0;
+    gsize totalSent = 0;
+
+    while(totalSent < count) {
+        gsize chunkLength = MIN(bufferLength, count - totalSent);
+        ssize_t numRead = pread64(osInFD, buffer, chunkLength, position);
+        if(numRead < 0) {
+            if(totalSent == 0) {
+                _process_setErrno(proc, errno);
+                ret = -1;
+            }
+            break;
+        } else if(numRead == 0) {
+            /* end of file */
+            break;
+        }
+
+        struct iovec iov = {buffer, (size_t)numRead};
+        gssize numSent = _process_emu_sendHelper(proc, outfd, &iov, 1, 0, NULL, 0);
+        if(numSent <= 0) {
+            if(totalSent == 0) {
+                ret = numSent;
+            }
+            break;
+        }
+
+        totalSent += (gsize)numSent;
+        position += (off64_t)numSent;
+
+        if(numSent < numRead) {
+            /* the socket is full */
+            break;
+        }
+    }
+
+    g_free(buffer);
+
+    if(offset != NULL) {
+        *offset = position;
+    } else {
+        lseek64(osInFD, position, SEEK_SET);
+    }
+
+    return (ret < 0) ? ret : (gssize)totalSent;
+}
+
+static gssize _process_emu_receiveFileRange(Process* proc, gint infd, gint osOutFD, off64_t* offset, gsize count) {
+    /* this function MUST be called after switching in shadow context */
+    utility_assert(proc->activeContext == PCTX_SHADOW);
+
+    /* bytes we receive can not be put back into the descriptor, so we make sure
+     * the file will take them before reading anything */
+    gint fileFlags = fcntl(osOutFD, F_GETFL);
+    if(fileFlags < 0) {
+        _process_setErrno(proc, errno);
+        return -1;
+    } else if((fileFlags & O_ACCMODE) == O_RDONLY) {
+        _process_setErrno(proc, EBADF);
+        return -1;
+    } else if(offset != NULL && (fileFlags & O_APPEND)) {
+        _process_setErrno(proc, EINVAL);
+        return -1;
+    }
+
+    /* where the next chunk lands, or -1 if the file is not seekable */
+    off64_t position = (offset != NULL) ? *offset :
+            lseek64(osOutFD, 0, (fileFlags & O_APPEND) ? SEEK_END : SEEK_CUR);
+
+    gsize bufferLength = MIN(count, CONFIG_FILE_TRANSFER_CHUNK_SIZE);
+    if(bufferLength == 0) {
+        return 0;
+    }
+    guchar* buffer = g_malloc(bufferLength);
+
+    gssize ret = 0;
+    gsize totalMoved = 0;
+
+    while(totalMoved < count) {
+        gsize chunkLength = MIN(bufferLength, count - totalMoved);
+
+        /* reserve the blocks first, so a full disk or file size limit fails
+         * here instead of after the bytes left the descriptor */
+        if(position >= 0 && fallocate(osOutFD, FALLOC_FL_KEEP_SIZE, position, (off64_t)chunkLength) < 0 &&
+                errno != EOPNOTSUPP && errno != ENODEV && errno != ESPIPE && errno != ENOSYS) {
+            if(totalMoved == 0) {
+                _process_setErrno(proc, errno);
+                ret = -1;
+            }
+            break;
+        }
+
+        struct iovec iov = {buffer, chunkLength};
+        gssize numReceived = _process_emu_recvHelper(proc, infd, &iov, 1, 0, NULL, 0);
+        if(numReceived <= 0) {
+            if(totalMoved == 0) {
+                ret = numReceived;
+            }
+            break;
+        }
+
+        gsize numWritten = 0;
+        gint writeError = 0;
+        while(numWritten < (gsize)numReceived) {
+            ssize_t n = (offset != NULL) ?
+                    pwrite64(osOutFD, buffer + numWritten, (gsize)numReceived - numWritten, *offset) :
+                    write(osOutFD, buffer + numWritten, (gsize)numReceived - numWritten);
+            if(n < 0) {
+                if(errno == EINTR) {
+                    continue;
+                }
+                writeError = errno;
+                break;
+            }
+            numWritten += (gsize)n;
+            if(offset != NULL) {
+                *offset += (off64_t)n;
+            }
+            if(position >= 0) {
+                position += (off64_t)n;
+            }
+        }
+
+        totalMoved += numWritten;
+
+        if(numWritten < (gsize)numReceived) {
+            /* only an i/o error on the reserved range gets here */
+            warning("lost %"G_GSIZE_FORMAT" spliced bytes that could not be written to fd %i: %s",
+                    (gsize)numReceived - numWritten, osOutFD, g_strerror(writeError));
+            if(totalMoved == 0) {
+                _process_setErrno(proc, writeError);
+                ret = -1;
+            }
+            break;
+        }
+    }
+
+    g_free(buffer);
+
+    return (ret < 0) ? ret : (gssize)totalMoved;
+}
+
+static gssize _process_emu_spliceDescriptors(Process* proc, gint infd, gint outfd, gsize count) {
+    /* this function MUST be called after switching in shadow context */
+    utility_assert(proc->activeContext == PCTX_SHADOW);
+
+    /* we only read as much as the output accepts right now, so that no bytes
+     * are lost between the two descriptors */
+    Descriptor* outDesc = host_lookupDescriptor(proc->host, outfd);
+    if(outDesc == NULL || (descriptor_getStatus(outDesc) & DS_CLOSED)) {
+        _process_setErrno(proc, EBADF);
+        return -1;
+    }
+
+    gsize space = 0;
+    DescriptorType outType = descriptor_getType(outDesc);
+    if(outType == DT_PIPE) {
+        if(channel_getLinkedChannel((Channel*)outDesc) == NULL) {
+            /* the read end is gone */
+            _process_setErrno(proc, EPIPE);
+            return -1;
+        }
+        space = channel_getOutputBufferSpace((Channel*)outDesc);
+    } else if(outType == DT_TCPSOCKET) {
+        gint error = tcp_getConnectError((TCP*)outDesc);
+        if(error != EISCONN) {
+            _process_setErrno(proc, (error == EALREADY) ? EWOULDBLOCK : error);
+            return -1;
+        }
+        space = tcp_getOutputBufferSpace((TCP*)outDesc);
+    } else if(outType == DT_UDPSOCKET) {
+        space = socket_getOutputBufferSpace((Socket*)outDesc);
+    } else {
+        _process_setErrno(proc, EINVAL);
+        return -1;
+    }
+
+    if(count == 0) {
+        return 0;
+    } else if(space == 0) {
+        _process_setErrno(proc, EWOULDBLOCK);
+        return -1;
+    }
+
+    gsize bufferLength = MIN(count, MIN(space, CONFIG_FILE_TRANSFER_CHUNK_SIZE));
+    guchar* buffer = g_malloc(bufferLength);
+
+    struct iovec iov = {buffer, bufferLength};
+    gssize ret = _process_emu_recvHelper(proc, infd, &iov, 1, 0, NULL, 0);
+    if(ret > 0) {
+        iov.iov_len = (gsize)ret;
+        gssize numSent = _process_emu_sendHelper(proc, outfd, &iov, 1, 0, NULL, 0);
+        if(numSent != ret) {
+            /* we checked the space above, so this is a bug */
+            error("splice from %i to %i moved %"G_GSSIZE_FORMAT" of %"G_GSSIZE_FORMAT" bytes",
+                    infd, outfd, numSent, ret);
+        }
+    }
+
+    g_free(buffer);
+    return ret;
+}
+
+ssize_t process_emu_sendfile64(Process* proc, int outfd, int infd, off64_t *offset, size_t count) {
+    ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
+    gssize ret = 0;
+
+    gint osInFD = host_getOSHandle(proc->host, infd);
+
+    if(host_isShadowDescriptor(proc->host, infd)) {
+        /* the input must be a real file that could be mmapped */
+        _process_setErrno(proc, EINVAL);
+        ret = -1;
+    } else if(osInFD < 0) {
+        _process_setErrno(proc, EBADF);
+        ret = -1;
+    } else if(!host_isShadowDescriptor(proc->host, outfd)) {
+        gint osOutFD = host_getOSHandle(proc->host, outfd);
+        if(osOutFD >= 0) {
+            ret = sendfile64(osOutFD, osInFD, offset, count);
+            if(ret < 0) {
+                _process_setErrno(proc, errno);
+            }
+        } else {
+            _process_setErrno(proc, EBADF);
+            ret = -1;
+        }
+    } else {
+        if(prevCTX == PCTX_PLUGIN) {
+            _process_emu_waitForDescriptor(proc, outfd, 0, TRUE);
+        }
+        /* move the whole range from the file into the socket in one call */
+        ret = _process_emu_sendFileRange(proc, outfd, osInFD, offset, count);
+    }
+
+    _process_changeContext(proc, PCTX_SHADOW, prevCTX);
+    return ret;
+}
+
+ssize_t process_emu_sendfile(Process* proc, int outfd, int infd, off_t *offset, size_t count) {
+    if(offset == NULL) {
+        return process_emu_sendfile64(proc, outfd, infd, NULL, count);
+    }
+
+    off64_t offset64 = (off64_t)*offset;
+    ssize_t ret = process_emu_sendfile64(proc, outfd, infd, &offset64, count);
+    *offset = (off_t)offset64;
+    return ret;
+}
+
+ssize_t process_emu_splice(Process* proc, int infd, off64_t *inoffset, int outfd, off64_t *outoffset, size_t len, unsigned int flags) {
+    ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
+    gssize ret = 0;
+
+    gboolean isShadowIn = host_isShadowDescriptor(proc->host, infd);
+    gboolean isShadowOut = host_isShadowDescriptor(proc->host, outfd);
+    gint osInFD = isShadowIn ? -1 : host_getOSHandle(proc->host, infd);
+    gint osOutFD = isShadowOut ? -1 : host_getOSHandle(proc->host, outfd);
+    gint waitFlags = (flags & SPLICE_F_NONBLOCK) ? MSG_DONTWAIT : 0;
+
+    /* pipes created by the plugin are always shadow channels */
+    gboolean isPipeIn = isShadowIn &&
+            descriptor_getType(host_lookupDescriptor(proc->host, infd)) == DT_PIPE;
+    gboolean isPipeOut = isShadowOut &&
+            descriptor_getType(host_lookupDescriptor(proc->host, outfd)) == DT_PIPE;
+
+    if((!isShadowIn && osInFD < 0) || (!isShadowOut && osOutFD < 0)) {
+        _process_setErrno(proc, EBADF);
+        ret = -1;
+    } else if(!isShadowIn && !isShadowOut) {
+        ret = splice(osInFD, inoffset, osOutFD, outoffset, len, flags);
+        if(ret < 0) {
+            _process_setErrno(proc, errno);
+        }
+    } else if(!isPipeIn && !isPipeOut) {
+        /* like the kernel, we need a pipe on one of the ends */
+        _process_setErrno(proc, EINVAL);
+        ret = -1;
+    } else if((isShadowIn && inoffset != NULL) || (isShadowOut && outoffset != NULL)) {
+        /* pipes and sockets are not seekable */
+        _process_setErrno(proc, ESPIPE);
+        ret = -1;
+    } else if(isShadowIn && isShadowOut) {
+        if(prevCTX == PCTX_PLUGIN) {
+            _process_emu_waitForDescriptor(proc, infd, waitFlags, FALSE);
+            _process_emu_waitForDescriptor(proc, outfd, waitFlags, TRUE);
+        }
+        ret = _process_emu_spliceDescriptors(proc, infd, outfd, len);
+    } else if(isShadowOut) {
+        /* from a file into a pipe */
+        if(prevCTX == PCTX_PLUGIN) {
+            _process_emu_waitForDescriptor(proc, outfd, waitFlags, TRUE);
+        }
+        ret = _process_emu_sendFileRange(proc, outfd, osInFD, inoffset, len);
+    } else {
+        /* from a pipe into a file */
+        if(prevCTX == PCTX_PLUGIN) {
+            _process_emu_waitForDescriptor(proc, infd, waitFlags, FALSE);
+        }
+        ret = _process_emu_receiveFileRange(proc, infd, osOutFD, outoffset, len);
+    }
+
+    _process_changeContext(proc, PCTX_SHADOW, prevCTX);
+    return ret;
+}
+
 int process_emu_close(Process* proc, int fd) {
     /* check if this is a socket */
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
@@ -3167,8 +3952,8 @@ int process_emu_poll(Process* proc, struct pollfd *pfd, nfds_t nfd, int timeout)
     } else {
         struct timespec timeout_ts;
         timeout_ts.tv_sec = timeout / 1000;
-        timeout_ts.tv_nsec = (__syscall_slong_t)((timeout % 1000) * 100000);
-        ret = _process_emu_pollHelper(proc, pfd, nfd, &timeout_ts);
+        timeout_ts.tv_nsec = (__syscall_slong_t)((timeout % 1000) * 1000000);
+        ret = _process_emu_pollHelper(proc, pfd, nfd, (timeout < 0) ? NULL : &timeout_ts);
     }
     _process_changeContext(proc, PCTX_SHADOW, prevCTX);
     return ret;
@@ -5778,7 +6563,7 @@ int process_emu_pthread_create(Process* proc, pthread_t *thread, const pthread_a
 
                 pth_attr_t defaultAttr = pth_attr_new();
                 pth_attr_set(defaultAttr, PTH_ATTR_NAME, programAuxThreadNameBuf->str);
-                pth_attr_set(defaultAttr, PTH_ATTR_STACK_SIZE, PROC_PTH_STACK_SIZE);
+                pth_attr_set(defaultAttr, PTH_ATTR_STACK_SIZE, (unsigned int)proc->plugin.stackSize);
                 pth_attr_set(defaultAttr, PTH_ATTR_JOINABLE, TRUE);
 
                 auxThread = pth_spawn(defaultAttr, (PthSpawnFunc) _process_executeChild, data);
@@ -6672,7 +7457,36 @@ int process_emu_pthread_mutex_getprioceiling(Process* proc, const pthread_mutex_
     return ret;
 }
 
+/* simulated threads of a process run cooperatively, so a mutex is almost
+ * never contended. when the plugin touches an initialized pth mutex that is
+ * free or already its own, taking or releasing it is only a state update that
+ * never enters the pth scheduler, and we skip the context switching for it. */
+static pth_mutex_t* _process_getUncontendedMutex(Process* proc, pthread_mutex_t* mutex, gboolean isRelease) {
+    if(proc->activeContext != PCTX_PLUGIN || mutex == NULL || proc->tstate != pth_gctx_get()) {
+        return NULL;
+    }
+
+    pth_mutex_t* pm = NULL;
+    memmove(&pm, mutex, sizeof(void*));
+    if(pm == NULL || !(pm->mx_state & PTH_MUTEX_INITIALIZED)) {
+        return NULL;
+    }
+
+    if(pm->mx_state & PTH_MUTEX_LOCKED) {
+        /* held: we may only release it or lock it recursively if it is ours */
+        return (pm->mx_owner == pth_self()) ? pm : NULL;
+    } else {
+        /* free: locking is trivial, releasing is an error left to the slow path */
+        return isRelease ? NULL : pm;
+    }
+}
+
 int process_emu_pthread_mutex_lock(Process* proc, pthread_mutex_t *mutex) {
+    pth_mutex_t* fastMutex = _process_getUncontendedMutex(proc, mutex, FALSE);
+    if(fastMutex && pth_mutex_acquire(fastMutex, TRUE, NULL)) {
+        return 0;
+    }
+
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
     int ret = 0;
     if (prevCTX == PCTX_PLUGIN) {
@@ -6717,6 +7531,11 @@ int process_emu_pthread_mutex_lock(Process* proc, pthread_mutex_t *mutex) {
 }
 
 int process_emu_pthread_mutex_trylock(Process* proc, pthread_mutex_t *mutex) {
+    pth_mutex_t* fastMutex = _process_getUncontendedMutex(proc, mutex, FALSE);
+    if(fastMutex && pth_mutex_acquire(fastMutex, TRUE, NULL)) {
+        return 0;
+    }
+
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
     int ret = 0;
     if (prevCTX == PCTX_PLUGIN) {
@@ -6761,6 +7580,12 @@ int process_emu_pthread_mutex_trylock(Process* proc, pthread_mutex_t *mutex) {
 }
 
 int process_emu_pthread_mutex_unlock(Process* proc, pthread_mutex_t *mutex) {
+    /* waiters poll the mutex state from the scheduler, so releasing never needs it */
+    pth_mutex_t* fastMutex = _process_getUncontendedMutex(proc, mutex, TRUE);
+    if(fastMutex && pth_mutex_release(fastMutex)) {
+        return 0;
+    }
+
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
     int ret = 0;
     if (prevCTX == PCTX_PLUGIN) {
@@ -7279,7 +8104,23 @@ int process_emu_pthread_cond_destroy(Process* proc, pthread_cond_t *cond) {
     return ret;
 }
 
+/* signaling a condition nobody waits on is a no-op (and pth would not yield),
+ * so we answer it without entering the pth context */
+static gboolean _process_isUnwaitedCondition(Process* proc, pthread_cond_t* cond) {
+    if(proc->activeContext != PCTX_PLUGIN || cond == NULL) {
+        return FALSE;
+    }
+
+    pth_cond_t* pcn = NULL;
+    memmove(&pcn, cond, sizeof(void*));
+    return (pcn != NULL && (pcn->cn_state & PTH_COND_INITIALIZED) && pcn->cn_waiters == 0) ? TRUE : FALSE;
+}
+
 int process_emu_pthread_cond_broadcast(Process* proc, pthread_cond_t *cond) {
+    if(_process_isUnwaitedCondition(proc, cond)) {
+        return 0;
+    }
+
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
     int ret = 0;
     if (prevCTX == PCTX_PLUGIN) {
@@ -7323,6 +8164,10 @@ int process_emu_pthread_cond_broadcast(Process* proc, pthread_cond_t *cond) {
 }
 
 int process_emu_pthread_cond_signal(Process* proc, pthread_cond_t *cond) {
+    if(_process_isUnwaitedCondition(proc, cond)) {
+        return 0;
+    }
+
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
     int ret = 0;
     if (prevCTX == PCTX_PLUGIN) {
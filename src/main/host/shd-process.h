@@ -29,6 +29,7 @@ typedef off_t off64_t;
 #include <sys/statfs.h>
 #include <sys/statvfs.h>
 #include <sys/statvfs.h>
+#include <sys/sendfile.h>
 
 #include <fcntl.h>
 
@@ -71,10 +72,22 @@ typedef off_t off64_t;
 
 #include "shadow.h"
 
+/*
+ * A vDSO-like page holding the emulated time, so the preload library can
+ * answer the plugin's clock queries without switching into shadow. Shadow
+ * refreshes it whenever it resumes the process.
+ */
+typedef struct _ProcessTimePage ProcessTimePage;
+struct _ProcessTimePage {
+    EmulatedTime now;
+    /* nonzero while the plugin or pth is running, zero while shadow is */
+    volatile gint isEmulating;
+};
+
 Process* process_new(gpointer host, guint processID,
         SimulationTime startTime, SimulationTime stopTime, const gchar* pluginName,
-        const gchar* pluginPath, const gchar* pluginSymbol, const gchar* preloadName,
-        const gchar* preloadPath, gchar* arguments);
+        const gchar* pluginPath, const gchar* pluginSymbol, gsize pluginStackSize,
+        const gchar* preloadName, const gchar* preloadPath, gchar* arguments);
 void process_ref(Process* proc);
 void process_unref(Process* proc);
 
@@ -91,6 +104,7 @@ void process_migrate(Process* proc, gpointer threads);
 gboolean process_wantsNotify(Process* proc, gint epollfd);
 gboolean process_isRunning(Process* proc);
 gboolean process_shouldEmulate(Process* proc);
+ProcessTimePage* process_updateTimePage(Process* proc);
 
 gboolean process_addAtExitCallback(Process* proc, gpointer userCallback, gpointer userArgument,
         gboolean shouldPassArgument);
@@ -106,6 +120,7 @@ gboolean process_addAtExitCallback(Process* proc, gpointer userCallback, gpointe
 void* process_emu_malloc(Process* proc, size_t size);
 void* process_emu_calloc(Process* proc, size_t nmemb, size_t size);
 void* process_emu_realloc(Process* proc, void *ptr, size_t size);
+size_t process_emu_malloc_usable_size(Process* proc, void *ptr);
 void process_emu_free(Process* proc, void *ptr);
 int process_emu_posix_memalign(Process* proc, void** memptr, size_t alignment, size_t size);
 void* process_emu_memalign(Process* proc, size_t blocksize, size_t bytes);
@@ -136,6 +151,8 @@ ssize_t process_emu_sendmsg(Process* proc, int fd, const struct msghdr *message,
 ssize_t process_emu_recv(Process* proc, int fd, void *buf, size_t n, int flags);
 ssize_t process_emu_recvfrom(Process* proc, int fd, void *buf, size_t n, int flags, struct sockaddr* addr, socklen_t *addr_len);
 ssize_t process_emu_recvmsg(Process* proc, int fd, struct msghdr *message, int flags);
+int process_emu_sendmmsg(Process* proc, int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags);
+int process_emu_recvmmsg(Process* proc, int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags, struct timespec *timeout);
 int process_emu_getsockopt(Process* proc, int fd, int level, int optname, void* optval, socklen_t* optlen);
 int process_emu_setsockopt(Process* proc, int fd, int level, int optname, const void *optval, socklen_t optlen);
 int process_emu_listen(Process* proc, int fd, int n);
@@ -148,6 +165,9 @@ ssize_t process_emu_readv(Process* proc, int fd, const struct iovec *iov, int io
 ssize_t process_emu_writev(Process* proc, int fd, const struct iovec *iov, int iovcnt);
 ssize_t process_emu_pread(Process* proc, int fd, void *buff, size_t numbytes, off_t offset);
 ssize_t process_emu_pwrite(Process* proc, int fd, const void *buf, size_t nbytes, off_t offset);
+ssize_t process_emu_sendfile(Process* proc, int outfd, int infd, off_t *offset, size_t count);
+ssize_t process_emu_sendfile64(Process* proc, int outfd, int infd, off64_t *offset, size_t count);
+ssize_t process_emu_splice(Process* proc, int infd, off64_t *inoffset, int outfd, off64_t *outoffset, size_t len, unsigned int flags);
 int process_emu_close(Process* proc, int fd);
 int process_emu_fcntl(Process* proc, int fd, int cmd, void* argp);
 int process_emu_ioctl(Process* proc, int fd, unsigned long int request, void* argp);
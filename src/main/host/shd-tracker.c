@@ -34,11 +34,29 @@ typedef struct {
     Counters outCounters;
 } IFaceCounters;
 
+/* stored in the last bytes of every plugin block we account for, so that a free
+ * finds the size in the block itself. the magic is mixed with the location, so
+ * tags that realloc copied along or that the plugin wrote itself do not match. */
+typedef struct {
+    guint64 magic;
+    guint64 allocatedBytes;
+} AllocationTag;
+
+#define TRACKER_ALLOCATION_MAGIC 0x7A6A110CA7EDB10CULL
+
 struct _Tracker {
     /* our personal settings as configured in the shadow xml config file */
     SimulationTime interval;
     LogLevel loglevel;
     LogInfoFlags loginfo;
+    HeartbeatFormat format;
+
+    /* time series files in the host data directory, for the csv format. we only hold
+     * them open while writing a heartbeat, so that many hosts do not run out of descriptors */
+    gchar* dataDirPath;
+    gboolean didCreateNodeSeries;
+    gboolean didCreateSocketSeries;
+    gboolean didCreateRAMSeries;
 
     gboolean didLogNodeHeader;
     gboolean didLogRAMHeader;
@@ -55,7 +73,7 @@ struct _Tracker {
     IFaceCounters local;
     IFaceCounters remote;
 
-    GHashTable* allocatedLocations;
+    guint numAllocatedPointers;
     gsize allocatedBytesTotal;
     gsize allocatedBytesLastInterval;
     gsize deallocatedBytesLastInterval;
@@ -112,15 +130,17 @@ static void _socketstats_free(SocketStats* ss) {
     }
 }
 
-Tracker* tracker_new(SimulationTime interval, LogLevel loglevel, LogInfoFlags loginfo) {
+Tracker* tracker_new(SimulationTime interval, LogLevel loglevel, LogInfoFlags loginfo,
+        HeartbeatFormat format, const gchar* dataDirPath) {
     Tracker* tracker = g_new0(Tracker, 1);
     MAGIC_INIT(tracker);
 
     tracker->interval = interval;
     tracker->loglevel = loglevel;
     tracker->loginfo = loginfo;
+    tracker->format = (dataDirPath != NULL) ? format : HEARTBEAT_FORMAT_LOG;
+    tracker->dataDirPath = g_strdup(dataDirPath);
 
-    tracker->allocatedLocations = g_hash_table_new(g_direct_hash, g_direct_equal);
     tracker->socketStats = g_hash_table_new_full(g_int_hash, g_int_equal, NULL, (GDestroyNotify)_socketstats_free);
 
     /* send an alive message, and start periodic heartbeats */
@@ -129,19 +149,15 @@ Tracker* tracker_new(SimulationTime interval, LogLevel loglevel, LogInfoFlags lo
     return tracker;
 }
 
-static void _tracker_freeAllocatedLocations(gpointer key, gpointer value, gpointer userData) {
-    if(key) {
-        g_free(key);
-    }
-}
-
 void tracker_free(Tracker* tracker) {
     MAGIC_ASSERT(tracker);
 
-    g_hash_table_foreach(tracker->allocatedLocations, _tracker_freeAllocatedLocations, NULL);
-    g_hash_table_destroy(tracker->allocatedLocations);
     g_hash_table_destroy(tracker->socketStats);
 
+    if(tracker->dataDirPath) {
+        g_free(tracker->dataDirPath);
+    }
+
     MAGIC_CLEAR(tracker);
     g_free(tracker);
 }
@@ -263,32 +279,70 @@ void tracker_addOutputBytes(Tracker* tracker, Packet* packet, gint handle) {
     }
 }
 
-void tracker_addAllocatedBytes(Tracker* tracker, gpointer location, gsize allocatedBytes) {
+gboolean tracker_isTrackingAllocations(Tracker* tracker) {
     MAGIC_ASSERT(tracker);
+    return (tracker->loginfo & LOG_INFO_FLAGS_RAM) ? TRUE : FALSE;
+}
 
-    if(tracker->loginfo & LOG_INFO_FLAGS_RAM) {
-        tracker->allocatedBytesTotal += allocatedBytes;
-        tracker->allocatedBytesLastInterval += allocatedBytes;
-        g_hash_table_insert(tracker->allocatedLocations, location, GSIZE_TO_POINTER(allocatedBytes));
+/* the number of bytes callers must add to each allocation to make room for the tag */
+gsize tracker_getAllocationTagSize() {
+    return sizeof(AllocationTag);
+}
+
+/* the tag may sit at any multiple of 8 bytes, so we copy it in and out */
+static gboolean _tracker_readAllocationTag(gpointer location, gsize usableSize, AllocationTag* tag) {
+    if(location == NULL || usableSize < sizeof(AllocationTag)) {
+        return FALSE;
+    }
+    memcpy(tag, ((guchar*)location) + usableSize - sizeof(AllocationTag), sizeof(AllocationTag));
+    return (tag->magic == (TRACKER_ALLOCATION_MAGIC ^ (guint64)(guintptr)location)) ? TRUE : FALSE;
+}
+
+static void _tracker_writeAllocationTag(gpointer location, gsize usableSize, AllocationTag* tag) {
+    memcpy(((guchar*)location) + usableSize - sizeof(AllocationTag), tag, sizeof(AllocationTag));
+}
+
+/* usableSize is the full size of the block at location, including the room the caller
+ * reserved for the tag */
+void tracker_addAllocatedBytes(Tracker* tracker, gpointer location, gsize usableSize) {
+    MAGIC_ASSERT(tracker);
+
+    if((tracker->loginfo & LOG_INFO_FLAGS_RAM) && location && usableSize >= sizeof(AllocationTag)) {
+        AllocationTag tag;
+        tag.magic = TRACKER_ALLOCATION_MAGIC ^ (guint64)(guintptr)location;
+        tag.allocatedBytes = (guint64)(usableSize - sizeof(AllocationTag));
+        _tracker_writeAllocationTag(location, usableSize, &tag);
+
+        tracker->allocatedBytesTotal += (gsize)tag.allocatedBytes;
+        tracker->allocatedBytesLastInterval += (gsize)tag.allocatedBytes;
+        (tracker->numAllocatedPointers)++;
     }
 }
 
-void tracker_removeAllocatedBytes(Tracker* tracker, gpointer location) {
+/* returns TRUE if the block was one we tagged */
+gboolean tracker_removeAllocatedBytes(Tracker* tracker, gpointer location, gsize usableSize) {
     MAGIC_ASSERT(tracker);
+    gboolean wasTagged = FALSE;
 
     if(tracker->loginfo & LOG_INFO_FLAGS_RAM) {
-        gpointer value = NULL;
-        gboolean exists = g_hash_table_lookup_extended(tracker->allocatedLocations, location, NULL, &value);
-        if(exists) {
-            gboolean b = g_hash_table_remove(tracker->allocatedLocations, location);
-            utility_assert(b);
-            gsize allocatedBytes = GPOINTER_TO_SIZE(value);
-            tracker->allocatedBytesTotal -= allocatedBytes;
-            tracker->deallocatedBytesLastInterval += allocatedBytes;
+        /* only blocks we tagged are subtracted. anything else was not
+         * allocated through us (e.g. inside libc) or is a bad free */
+        AllocationTag tag;
+        if(_tracker_readAllocationTag(location, usableSize, &tag)) {
+            /* the block may be handed out again without going through us */
+            tag.magic = 0;
+            _tracker_writeAllocationTag(location, usableSize, &tag);
+
+            tracker->allocatedBytesTotal -= (gsize)tag.allocatedBytes;
+            tracker->deallocatedBytesLastInterval += (gsize)tag.allocatedBytes;
+            (tracker->numAllocatedPointers)--;
+            wasTagged = TRUE;
         } else {
             (tracker->numFailedFrees)++;
         }
     }
+
+    return wasTagged;
 }
 
 void tracker_addSocket(Tracker* tracker, gint handle, enum ProtocolType type, gsize inputBufferSize, gsize outputBufferSize) {
@@ -402,6 +456,158 @@ static gchar* _tracker_getCounterString(Counters* c) {
     return g_string_free(buffer, FALSE);
 }
 
+/* writes one csv column name per counter, each prefixed by the given direction */
+static void _tracker_appendCounterHeaderColumns(GString* buffer, const gchar* prefix) {
+    gchar** columns = g_strsplit(_tracker_getCounterHeaderString(), ",", -1);
+    for(gint i = 0; columns[i]; i++) {
+        g_string_append_printf(buffer, ",%s-%s", prefix, columns[i]);
+    }
+    g_strfreev(columns);
+}
+
+static void _tracker_appendCounterHeaderColumnsAll(GString* buffer) {
+    _tracker_appendCounterHeaderColumns(buffer, "inbound-localhost");
+    _tracker_appendCounterHeaderColumns(buffer, "outbound-localhost");
+    _tracker_appendCounterHeaderColumns(buffer, "inbound-remote");
+    _tracker_appendCounterHeaderColumns(buffer, "outbound-remote");
+}
+
+static void _tracker_appendCounterColumnsAll(GString* buffer, IFaceCounters* local, IFaceCounters* remote) {
+    gchar* inLocal = _tracker_getCounterString(&local->inCounters);
+    gchar* outLocal = _tracker_getCounterString(&local->outCounters);
+    gchar* inRemote = _tracker_getCounterString(&remote->inCounters);
+    gchar* outRemote = _tracker_getCounterString(&remote->outCounters);
+
+    g_string_append_printf(buffer, ",%s,%s,%s,%s", inLocal, outLocal, inRemote, outRemote);
+
+    g_free(inLocal);
+    g_free(outLocal);
+    g_free(inRemote);
+    g_free(outRemote);
+}
+
+/* opens the named time series file in the host data directory and writes the
+ * header row, or returns NULL and falls back to logging on failure */
+/* opens the series for appending this heartbeat's rows. the first time, the
+ * caller passes the header and we create the file, replacing any old one */
+static FILE* _tracker_openSeries(Tracker* tracker, const gchar* fileName, GString* header) {
+    gchar* path = g_build_filename(tracker->dataDirPath, fileName, NULL);
+    FILE* file = fopen(path, header ? "w" : "a");
+
+    if(file && header) {
+        g_string_append_c(header, '\n');
+        fwrite(header->str, 1, header->len, file);
+    } else if(!file) {
+        warning("unable to open heartbeat file '%s': %s; logging heartbeats instead",
+                path, g_strerror(errno));
+        tracker->format = HEARTBEAT_FORMAT_LOG;
+    }
+
+    g_free(path);
+    if(header) {
+        g_string_free(header, TRUE);
+    }
+    return file;
+}
+
+static void _tracker_writeSeriesRow(FILE* file, GString* row) {
+    g_string_append_c(row, '\n');
+    fwrite(row->str, 1, row->len, file);
+    g_string_free(row, TRUE);
+}
+
+static void _tracker_writeNode(Tracker* tracker, SimulationTime now, SimulationTime interval) {
+    GString* header = NULL;
+    if(!tracker->didCreateNodeSeries) {
+        header = g_string_new("time-nanoseconds,interval-seconds,recv-bytes,send-bytes,"
+                "cpu-percent,delayed-count,avgdelay-milliseconds");
+        _tracker_appendCounterHeaderColumnsAll(header);
+    }
+    FILE* nodeFile = _tracker_openSeries(tracker, "heartbeat-node.csv", header);
+    if(!nodeFile) {
+        return;
+    }
+    tracker->didCreateNodeSeries = TRUE;
+
+    guint seconds = (guint) (interval / SIMTIME_ONE_SECOND);
+    gdouble cpuutil = (gdouble)(((gdouble)tracker->processingTimeLastInterval) / ((gdouble)interval));
+    gdouble avgdelayms = 0.0;
+
+    if(tracker->numDelayedLastInterval > 0) {
+        gdouble delayms = (gdouble) (((gdouble)tracker->delayTimeLastInterval) / ((gdouble)SIMTIME_ONE_MILLISECOND));
+        avgdelayms = (gdouble) (delayms / ((gdouble) tracker->numDelayedLastInterval));
+    }
+
+    GString* row = g_string_new(NULL);
+    g_string_printf(row, "%"G_GUINT64_FORMAT",%u,%"G_GSIZE_FORMAT",%"G_GSIZE_FORMAT",%f,%"G_GSIZE_FORMAT",%f",
+            now, seconds, _tracker_sumBytes(&tracker->remote.inCounters.bytes),
+            _tracker_sumBytes(&tracker->remote.outCounters.bytes),
+            cpuutil, tracker->numDelayedLastInterval, avgdelayms);
+    _tracker_appendCounterColumnsAll(row, &tracker->local, &tracker->remote);
+    _tracker_writeSeriesRow(nodeFile, row);
+    fclose(nodeFile);
+}
+
+/* the socket file is opened for the first socket of a heartbeat, and the caller
+ * closes it once all sockets are written */
+static gboolean _tracker_writeSocket(Tracker* tracker, FILE** socketFile, SimulationTime now, SocketStats* ss) {
+    if(!*socketFile) {
+        GString* header = NULL;
+        if(!tracker->didCreateSocketSeries) {
+            header = g_string_new("time-nanoseconds,descriptor-number,protocol-string,"
+                    "hostname-peer,port-peer,inbuflen-bytes,inbufsize-bytes,outbuflen-bytes,outbufsize-bytes,"
+                    "recv-bytes,send-bytes");
+            _tracker_appendCounterHeaderColumnsAll(header);
+        }
+        *socketFile = _tracker_openSeries(tracker, "heartbeat-socket.csv", header);
+        if(!*socketFile) {
+            return FALSE;
+        }
+        tracker->didCreateSocketSeries = TRUE;
+    }
+
+    gsize totalRecvBytes = _tracker_sumBytes(&ss->local.inCounters.bytes) +
+            _tracker_sumBytes(&ss->remote.inCounters.bytes);
+    gsize totalSendBytes = _tracker_sumBytes(&ss->local.outCounters.bytes) +
+            _tracker_sumBytes(&ss->remote.outCounters.bytes);
+
+    GString* row = g_string_new(NULL);
+    g_string_printf(row, "%"G_GUINT64_FORMAT",%d,%s,%s,%u,"
+            "%"G_GSIZE_FORMAT",%"G_GSIZE_FORMAT",%"G_GSIZE_FORMAT",%"G_GSIZE_FORMAT","
+            "%"G_GSIZE_FORMAT",%"G_GSIZE_FORMAT,
+            now, ss->handle,
+            ss->type == PTCP ? "TCP" : ss->type == PUDP ? "UDP" :
+                ss->type == PLOCAL ? "LOCAL" : "UNKNOWN",
+            ss->peerHostname, (guint)ss->peerPort,
+            ss->inputBufferLength, ss->inputBufferSize,
+            ss->outputBufferLength, ss->outputBufferSize,
+            totalRecvBytes, totalSendBytes);
+    _tracker_appendCounterColumnsAll(row, &ss->local, &ss->remote);
+    _tracker_writeSeriesRow(*socketFile, row);
+    return TRUE;
+}
+
+static void _tracker_writeRAM(Tracker* tracker, SimulationTime now, SimulationTime interval) {
+    GString* header = NULL;
+    if(!tracker->didCreateRAMSeries) {
+        header = g_string_new("time-nanoseconds,interval-seconds,alloc-bytes,dealloc-bytes,"
+                "total-bytes,pointers-count,failfree-count");
+    }
+    FILE* ramFile = _tracker_openSeries(tracker, "heartbeat-ram.csv", header);
+    if(!ramFile) {
+        return;
+    }
+    tracker->didCreateRAMSeries = TRUE;
+
+    GString* row = g_string_new(NULL);
+    g_string_printf(row, "%"G_GUINT64_FORMAT",%u,%"G_GSIZE_FORMAT",%"G_GSIZE_FORMAT",%"G_GSIZE_FORMAT",%u,%u",
+            now, (guint) (interval / SIMTIME_ONE_SECOND),
+            tracker->allocatedBytesLastInterval, tracker->deallocatedBytesLastInterval,
+            tracker->allocatedBytesTotal, tracker->numAllocatedPointers, tracker->numFailedFrees);
+    _tracker_writeSeriesRow(ramFile, row);
+    fclose(ramFile);
+}
+
 static void _tracker_logNode(Tracker* tracker, LogLevel level, SimulationTime interval) {
     guint seconds = (guint) (interval / SIMTIME_ONE_SECOND);
     gdouble cpuutil = (gdouble)(((gdouble)tracker->processingTimeLastInterval) / ((gdouble)interval));
@@ -447,7 +653,9 @@ static void _tracker_logNode(Tracker* tracker, LogLevel level, SimulationTime in
 }
 
 static void _tracker_logSocket(Tracker* tracker, LogLevel level, SimulationTime interval) {
-    if(!tracker->didLogSocketHeader) {
+    SimulationTime now = worker_getCurrentTime();
+
+    if(tracker->format == HEARTBEAT_FORMAT_LOG && !tracker->didLogSocketHeader) {
         tracker->didLogSocketHeader = TRUE;
         logger_log(logger_getDefault(), level, __FILE__, __FUNCTION__, __LINE__,
                 "[shadow-heartbeat] [socket-header] descriptor-number,protocol-string,hostname:port-peer;"
@@ -468,6 +676,7 @@ static void _tracker_logSocket(Tracker* tracker, LogLevel level, SimulationTime
      * during the iteration because it will invalidate the iterator */
     GQueue* handlesToRemove = g_queue_new();
     gint socketLogCount = 0;
+    FILE* socketFile = NULL;
 
     while(g_hash_table_iter_next(&socketIterator, NULL, (gpointer*)&ss)) {
         /* don't log tcp sockets that don't have peer IP/port set */
@@ -475,6 +684,13 @@ static void _tracker_logSocket(Tracker* tracker, LogLevel level, SimulationTime
             continue;
         }
 
+        if(tracker->format == HEARTBEAT_FORMAT_CSV && _tracker_writeSocket(tracker, &socketFile, now, ss)) {
+            if(ss->removeAfterNextLog) {
+                g_queue_push_tail(handlesToRemove, GINT_TO_POINTER(ss->handle));
+            }
+            continue;
+        }
+
         gsize totalRecvBytes = _tracker_sumBytes(&ss->local.inCounters.bytes) +
                 _tracker_sumBytes(&ss->remote.inCounters.bytes);
         gsize totalSendBytes = _tracker_sumBytes(&ss->local.outCounters.bytes) +
@@ -515,6 +731,10 @@ static void _tracker_logSocket(Tracker* tracker, LogLevel level, SimulationTime
         }
     }
 
+    if(socketFile) {
+        fclose(socketFile);
+    }
+
     if(socketLogCount > 0) {
         logger_log(logger_getDefault(), level, __FILE__, __FUNCTION__, __LINE__, "%s", msg->str);
     }
@@ -531,7 +751,7 @@ static void _tracker_logSocket(Tracker* tracker, LogLevel level, SimulationTime
 
 static void _tracker_logRAM(Tracker* tracker, LogLevel level, SimulationTime interval) {
     guint seconds = (guint) (interval / SIMTIME_ONE_SECOND);
-    guint numptrs = g_hash_table_size(tracker->allocatedLocations);
+    guint numptrs = tracker->numAllocatedPointers;
 
     if(!tracker->didLogRAMHeader) {
         tracker->didLogRAMHeader = TRUE;
@@ -548,9 +768,17 @@ static void _tracker_logRAM(Tracker* tracker, LogLevel level, SimulationTime int
 void tracker_heartbeat(Tracker* tracker, gpointer userData) {
     MAGIC_ASSERT(tracker);
 
-    /* check to see if node info is being logged */
+    SimulationTime now = worker_getCurrentTime();
+
+    /* check to see if node info is being logged. the format checks are not
+     * exclusive, so we still log if the csv file could not be opened */
     if(tracker->loginfo & LOG_INFO_FLAGS_NODE) {
-        _tracker_logNode(tracker, tracker->loglevel, tracker->interval);
+        if(tracker->format == HEARTBEAT_FORMAT_CSV) {
+            _tracker_writeNode(tracker, now, tracker->interval);
+        }
+        if(tracker->format == HEARTBEAT_FORMAT_LOG) {
+            _tracker_logNode(tracker, tracker->loglevel, tracker->interval);
+        }
     }
 
     /* check to see if socket buffer info is being logged */
@@ -560,7 +788,12 @@ void tracker_heartbeat(Tracker* tracker, gpointer userData) {
 
     /* check to see if ram info is being logged */
     if(tracker->loginfo & LOG_INFO_FLAGS_RAM) {
-        _tracker_logRAM(tracker, tracker->loglevel, tracker->interval);
+        if(tracker->format == HEARTBEAT_FORMAT_CSV) {
+            _tracker_writeRAM(tracker, now, tracker->interval);
+        }
+        if(tracker->format == HEARTBEAT_FORMAT_LOG) {
+            _tracker_logRAM(tracker, tracker->loglevel, tracker->interval);
+        }
     }
 
     /* clear interval stats */
@@ -585,7 +818,7 @@ void tracker_heartbeat(Tracker* tracker, gpointer userData) {
     }
 
     /* schedule the next heartbeat */
-    tracker->lastHeartbeat = worker_getCurrentTime();
+    tracker->lastHeartbeat = now;
     Task* heartbeatTask = task_new((TaskCallbackFunc)tracker_heartbeat,
             tracker, NULL, NULL, NULL);
     worker_scheduleTask(heartbeatTask, tracker->interval);
@@ -9,15 +9,18 @@
 
 typedef struct _Tracker Tracker;
 
-Tracker* tracker_new(SimulationTime interval, LogLevel loglevel, LogInfoFlags loginfo);
+Tracker* tracker_new(SimulationTime interval, LogLevel loglevel, LogInfoFlags loginfo,
+        HeartbeatFormat format, const gchar* dataDirPath);
 void tracker_free(Tracker* tracker);
 
 void tracker_addProcessingTime(Tracker* tracker, SimulationTime processingTime);
 void tracker_addVirtualProcessingDelay(Tracker* tracker, SimulationTime delay);
 void tracker_addInputBytes(Tracker* tracker, Packet* packet, gint handle);
 void tracker_addOutputBytes(Tracker* tracker, Packet* packet, gint handle);
-void tracker_addAllocatedBytes(Tracker* tracker, gpointer location, gsize allocatedBytes);
-void tracker_removeAllocatedBytes(Tracker* tracker, gpointer location);
+gboolean tracker_isTrackingAllocations(Tracker* tracker);
+gsize tracker_getAllocationTagSize();
+void tracker_addAllocatedBytes(Tracker* tracker, gpointer location, gsize usableSize);
+gboolean tracker_removeAllocatedBytes(Tracker* tracker, gpointer location, gsize usableSize);
 void tracker_addSocket(Tracker* tracker, gint handle, enum ProtocolType type, gsize inputBufferSize, gsize outputBufferSize);
 void tracker_updateSocketPeer(Tracker* tracker, gint handle, in_addr_t peerIP, in_port_t peerPort);
 void tracker_updateSocketInputBuffer(Tracker* tracker, gint handle, gsize inputBufferLength, gsize inputBufferSize);
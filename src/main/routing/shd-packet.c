@@ -51,7 +51,7 @@ struct _Packet {
     MAGIC_DECLARE;
 };
 
-Packet* packet_new(gconstpointer payload, gsize payloadLength, guint hostID, guint64 packetID) {
+static Packet* _packet_new(Payload* payload, guint hostID, guint64 packetID) {
     Packet* packet = g_new0(Packet, 1);
     MAGIC_INIT(packet);
 
@@ -60,9 +60,9 @@ Packet* packet_new(gconstpointer payload, gsize payloadLength, guint hostID, gui
     packet->hostID = hostID;
     packet->packetID = packetID;
 
-    if(payload != NULL && payloadLength > 0) {
+    if(payload != NULL) {
         /* the payload starts with 1 ref, which we hold */
-        packet->payload = payload_new(payload, payloadLength);
+        packet->payload = payload;
 
         /* application data needs a priority ordering for FIFO onto the wire */
         packet->priority = host_getNextPacketPriority(worker_getActiveHost());
@@ -74,6 +74,23 @@ Packet* packet_new(gconstpointer payload, gsize payloadLength, guint hostID, gui
     return packet;
 }
 
+Packet* packet_new(gconstpointer payload, gsize payloadLength, guint hostID, guint64 packetID) {
+    Payload* data = NULL;
+    if(payload != NULL && payloadLength > 0) {
+        data = payload_new(payload, payloadLength);
+    }
+    return _packet_new(data, hostID, packetID);
+}
+
+Packet* packet_newFromIOVec(const struct iovec* iov, gint iovcnt, gsize iovOffset,
+        gsize payloadLength, guint hostID, guint64 packetID) {
+    Payload* data = NULL;
+    if(iov != NULL && payloadLength > 0) {
+        data = payload_newFromIOVec(iov, iovcnt, iovOffset, payloadLength);
+    }
+    return _packet_new(data, hostID, packetID);
+}
+
 /* copy everything except the payload.
  * the payload will point to the same payload as the original packet.
  * the payload is protected so it is safe to send the copied packet to a different host. */
@@ -441,6 +458,17 @@ guint packet_copyPayload(Packet* packet, gsize payloadOffset, gpointer buffer, g
     }
 }
 
+guint packet_copyPayloadIOVec(Packet* packet, gsize payloadOffset, const struct iovec* iov, gint iovcnt,
+        gsize iovOffset, gsize nBytes) {
+    MAGIC_ASSERT(packet);
+
+    if(packet->payload) {
+        return (guint) payload_getDataIOVec(packet->payload, payloadOffset, iov, iovcnt, iovOffset, nBytes);
+    } else {
+        return 0;
+    }
+}
+
 gint packet_getDestinationAssociationKey(Packet* packet) {
     MAGIC_ASSERT(packet);
 
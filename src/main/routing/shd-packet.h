@@ -50,6 +50,8 @@ struct _PacketTCPHeader {
 };
 
 Packet* packet_new(gconstpointer payload, gsize payloadLength, guint hostID, guint64 packetID);
+Packet* packet_newFromIOVec(const struct iovec* iov, gint iovcnt, gsize iovOffset,
+        gsize payloadLength, guint hostID, guint64 packetID);
 Packet* packet_copy(Packet* packet);
 
 void packet_ref(Packet* packet);
@@ -79,6 +81,8 @@ in_addr_t packet_getSourceIP(Packet* packet);
 in_port_t packet_getSourcePort(Packet* packet);
 
 guint packet_copyPayload(Packet* packet, gsize payloadOffset, gpointer buffer, gsize bufferLength);
+guint packet_copyPayloadIOVec(Packet* packet, gsize payloadOffset, const struct iovec* iov, gint iovcnt,
+        gsize iovOffset, gsize nBytes);
 GList* packet_copyTCPSelectiveACKs(Packet* packet);
 PacketTCPHeader* packet_getTCPHeader(Packet* packet);
 gint packet_compareTCPSequence(Packet* packet1, Packet* packet2, gpointer user_data);
@@ -23,8 +23,9 @@ Payload* payload_new(gconstpointer data, gsize dataLength) {
     payload->referenceCount = 1;
 
     if(data && dataLength > 0) {
-        payload->data = g_malloc0(dataLength);
-        memmove(payload->data, data, dataLength);
+        /* every byte is overwritten, so skip the zero-fill */
+        payload->data = g_malloc(dataLength);
+        memcpy(payload->data, data, dataLength);
         utility_assert(payload->data != NULL);
         payload->length = dataLength;
     }
@@ -34,6 +35,25 @@ Payload* payload_new(gconstpointer data, gsize dataLength) {
     return payload;
 }
 
+Payload* payload_newFromIOVec(const struct iovec* iov, gint iovcnt, gsize iovOffset, gsize dataLength) {
+    Payload* payload = g_new0(Payload, 1);
+    MAGIC_INIT(payload);
+
+    g_mutex_init(&(payload->lock));
+    payload->referenceCount = 1;
+
+    if(iov && dataLength > 0) {
+        /* gather straight from the user buffers, without an intermediate copy */
+        payload->data = g_malloc(dataLength);
+        payload->length = utility_copyFromIOVec(iov, iovcnt, iovOffset, payload->data, dataLength);
+        utility_assert(payload->length == dataLength);
+    }
+
+    worker_countObject(OBJECT_TYPE_PAYLOAD, COUNTER_TYPE_NEW);
+
+    return payload;
+}
+
 static void _payload_free(Payload* payload) {
     MAGIC_ASSERT(payload);
 
@@ -103,3 +123,23 @@ gsize payload_getData(Payload* payload, gsize offset, gpointer destBuffer, gsize
 
     return copyLength;
 }
+
+gsize payload_getDataIOVec(Payload* payload, gsize offset, const struct iovec* iov, gint iovcnt,
+        gsize iovOffset, gsize nBytes) {
+    MAGIC_ASSERT(payload);
+
+    _payload_lock(payload);
+
+    utility_assert(offset <= payload->length);
+
+    gsize targetLength = payload->length - offset;
+    gsize copyLength = MIN(targetLength, nBytes);
+
+    if(copyLength > 0) {
+        copyLength = utility_copyToIOVec(iov, iovcnt, iovOffset, payload->data + offset, copyLength);
+    }
+
+    _payload_unlock(payload);
+
+    return copyLength;
+}
@@ -10,11 +10,14 @@
 typedef struct _Payload Payload;
 
 Payload* payload_new(gconstpointer data, gsize dataLength);
+Payload* payload_newFromIOVec(const struct iovec* iov, gint iovcnt, gsize iovOffset, gsize dataLength);
 
 void payload_ref(Payload* payload);
 void payload_unref(Payload* payload);
 
 gsize payload_getLength(Payload* payload);
 gsize payload_getData(Payload* payload, gsize offset, gpointer destBuffer, gsize destBufferLength);
+gsize payload_getDataIOVec(Payload* payload, gsize offset, const struct iovec* iov, gint iovcnt,
+        gsize iovOffset, gsize nBytes);
 
 #endif /* SRC_MAIN_ROUTING_SHD_PAYLOAD_H_ */
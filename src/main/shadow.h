@@ -23,6 +23,7 @@
 #include <poll.h>
 #include <sys/un.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
@@ -63,11 +64,15 @@ typedef struct _Process Process;
 /* logging */
 #include "core/logger/shd-log-level.h"
 #include "core/logger/shd-log-record.h"
+#include "core/logger/shd-log-writer.h"
 #include "core/logger/shd-logger-helper.h"
 #include "core/logger/shd-logger.h"
 
 /* configuration, base runnables, and input parsing */
 #include "core/support/shd-object-counter.h"
+#include "core/support/shd-perf-counters.h"
+#include "core/support/shd-profiler.h"
+#include "core/support/shd-stats-server.h"
 #include "core/support/shd-examples.h"
 #include "core/support/shd-options.h"
 #include "utility/shd-utility.h"
@@ -83,6 +88,7 @@ typedef struct _Process Process;
 #include "utility/shd-pcap-writer.h"
 
 /* utilities with limited dependencies */
+#include "utility/shd-arena.h"
 #include "utility/shd-byte-queue.h"
 #include "utility/shd-priority-queue.h"
 #include "utility/shd-async-priority-queue.h"
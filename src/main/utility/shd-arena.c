@@ -0,0 +1,183 @@
+/*
+ * The Shadow Simulator
+ * Copyright (c) 2010-2011, Rob Jansen
+ * See LICENSE for licensing information
+ */
+
+#include <glib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "shd-utility.h"
+#include "shd-arena.h"
+
+/* every block starts with a header, which also keeps user pointers 16-byte aligned */
+#define ARENA_HEADER_SIZE 16
+#define ARENA_MIN_CLASS 5
+#define ARENA_NUM_CLASSES 64
+#define ARENA_BLOCK_MAGIC 0xAE4AB10C
+
+/* freed blocks at least this large have their pages handed back to the kernel */
+#define ARENA_RELEASE_SIZE (256*1024)
+
+typedef struct _ArenaHeader ArenaHeader;
+struct _ArenaHeader {
+    guint32 sizeClass;
+    /* distance from the start of the block to this header, for aligned blocks */
+    guint32 offset;
+    guint32 magic;
+    guint32 unused;
+};
+
+typedef struct _ArenaFreeBlock ArenaFreeBlock;
+struct _ArenaFreeBlock {
+    ArenaFreeBlock* next;
+};
+
+struct _Arena {
+    guchar* base;
+    gsize reservedSize;
+    gsize top;
+    gsize pageSize;
+    ArenaFreeBlock* freeLists[ARENA_NUM_CLASSES];
+};
+
+Arena* arena_new(gsize reservedSize) {
+    gsize pageSize = (gsize)sysconf(_SC_PAGESIZE);
+    reservedSize = (reservedSize + pageSize - 1) & ~(pageSize - 1);
+
+    /* only reserve address space, pages are committed when first touched */
+    gpointer base = mmap(NULL, reservedSize, PROT_READ|PROT_WRITE,
+            MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+    if(base == MAP_FAILED) {
+        return NULL;
+    }
+
+    Arena* arena = g_new0(Arena, 1);
+    arena->base = base;
+    arena->reservedSize = reservedSize;
+    arena->pageSize = pageSize;
+    return arena;
+}
+
+void arena_free(Arena* arena) {
+    utility_assert(arena);
+    munmap(arena->base, arena->reservedSize);
+    g_free(arena);
+}
+
+static guint _arena_getSizeClass(gsize blockSize) {
+    guint sizeClass = ARENA_MIN_CLASS;
+    while(sizeClass < ARENA_NUM_CLASSES - 1 && ((gsize)1 << sizeClass) < blockSize) {
+        sizeClass++;
+    }
+    return sizeClass;
+}
+
+static guchar* _arena_takeBlock(Arena* arena, guint sizeClass) {
+    ArenaFreeBlock* block = arena->freeLists[sizeClass];
+    if(block) {
+        arena->freeLists[sizeClass] = block->next;
+        return (guchar*)block;
+    }
+
+    /* carve a new block off the top, naturally aligned up to the page size */
+    gsize blockSize = (gsize)1 << sizeClass;
+    gsize blockAlign = MIN(blockSize, arena->pageSize);
+    gsize start = (arena->top + blockAlign - 1) & ~(blockAlign - 1);
+    if(start > arena->reservedSize || blockSize > arena->reservedSize - start) {
+        return NULL;
+    }
+    arena->top = start + blockSize;
+    return arena->base + start;
+}
+
+gpointer arena_allocate(Arena* arena, gsize alignment, gsize size) {
+    utility_assert(arena);
+
+    if(alignment < ARENA_HEADER_SIZE) {
+        alignment = ARENA_HEADER_SIZE;
+    }
+    if((alignment & (alignment - 1)) != 0 || alignment > arena->pageSize ||
+            size > arena->reservedSize) {
+        return NULL;
+    }
+
+    gsize blockSize = size + ARENA_HEADER_SIZE + (alignment - ARENA_HEADER_SIZE);
+    guint sizeClass = _arena_getSizeClass(blockSize);
+    guchar* block = _arena_takeBlock(arena, sizeClass);
+    if(!block) {
+        return NULL;
+    }
+
+    guintptr user = ((guintptr)block + ARENA_HEADER_SIZE + alignment - 1) & ~((guintptr)alignment - 1);
+    ArenaHeader* header = (ArenaHeader*)(user - ARENA_HEADER_SIZE);
+    header->sizeClass = sizeClass;
+    header->offset = (guint32)((guchar*)header - block);
+    header->magic = ARENA_BLOCK_MAGIC;
+
+    return (gpointer)user;
+}
+
+static ArenaHeader* _arena_getHeader(gconstpointer ptr) {
+    ArenaHeader* header = (ArenaHeader*)((guchar*)ptr - ARENA_HEADER_SIZE);
+    utility_assert(header->magic == ARENA_BLOCK_MAGIC);
+    return header;
+}
+
+void arena_deallocate(Arena* arena, gpointer ptr) {
+    utility_assert(arena);
+    if(!ptr) {
+        return;
+    }
+
+    utility_assert(arena_contains(arena, ptr));
+    ArenaHeader* header = _arena_getHeader(ptr);
+    guint sizeClass = header->sizeClass;
+    guchar* block = (guchar*)header - header->offset;
+    gsize blockSize = (gsize)1 << sizeClass;
+
+    header->magic = 0;
+
+    /* large blocks are page aligned, so we can drop everything after the
+     * first page, which still holds the free list link */
+    if(blockSize >= ARENA_RELEASE_SIZE) {
+        madvise(block + arena->pageSize, blockSize - arena->pageSize, MADV_DONTNEED);
+    }
+
+    ArenaFreeBlock* freeBlock = (ArenaFreeBlock*)block;
+    freeBlock->next = arena->freeLists[sizeClass];
+    arena->freeLists[sizeClass] = freeBlock;
+}
+
+gpointer arena_reallocate(Arena* arena, gpointer ptr, gsize size) {
+    utility_assert(arena);
+    if(!ptr) {
+        return arena_allocate(arena, 0, size);
+    }
+
+    gsize usable = arena_getUsableSize(arena, ptr);
+    if(size <= usable) {
+        return ptr;
+    }
+
+    gpointer newptr = arena_allocate(arena, 0, size);
+    if(newptr) {
+        memcpy(newptr, ptr, usable);
+        arena_deallocate(arena, ptr);
+    }
+    return newptr;
+}
+
+gboolean arena_contains(Arena* arena, gconstpointer ptr) {
+    utility_assert(arena);
+    const guchar* p = ptr;
+    return (p >= arena->base && p < arena->base + arena->reservedSize) ? TRUE : FALSE;
+}
+
+gsize arena_getUsableSize(Arena* arena, gconstpointer ptr) {
+    utility_assert(arena);
+    ArenaHeader* header = _arena_getHeader(ptr);
+    return ((gsize)1 << header->sizeClass) - header->offset - ARENA_HEADER_SIZE;
+}
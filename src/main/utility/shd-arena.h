@@ -0,0 +1,34 @@
+/*
+ * The Shadow Simulator
+ * Copyright (c) 2010-2011, Rob Jansen
+ * See LICENSE for licensing information
+ */
+
+#ifndef SHD_ARENA_H_
+#define SHD_ARENA_H_
+
+#include <glib.h>
+
+/**
+ * A private heap carved out of one contiguous, lazily committed region of
+ * virtual memory. Blocks are kept in power-of-two size classes and recycled
+ * through per-class free lists, and the whole region is returned to the
+ * system at once when the arena is freed. An arena is not thread-safe; the
+ * owner must serialize access to it.
+ */
+
+typedef struct _Arena Arena;
+
+Arena* arena_new(gsize reservedSize);
+void arena_free(Arena* arena);
+
+/* returns NULL if the arena is exhausted or the alignment is not supported,
+ * in which case the caller should fall back to the regular heap */
+gpointer arena_allocate(Arena* arena, gsize alignment, gsize size);
+gpointer arena_reallocate(Arena* arena, gpointer ptr, gsize size);
+void arena_deallocate(Arena* arena, gpointer ptr);
+
+gboolean arena_contains(Arena* arena, gconstpointer ptr);
+gsize arena_getUsableSize(Arena* arena, gconstpointer ptr);
+
+#endif /* SHD_ARENA_H_ */
@@ -112,7 +112,9 @@ static GString* _utility_formatBacktrace() {
 void utility_handleError(const gchar* file, gint line, const gchar* function, const gchar* message) {
     GString* errorString = _utility_formatError(file, line, function, message);
     GString* backtraceString = _utility_formatBacktrace();
-    if(!isatty(fileno(stdout))) {
+    /* plain text would corrupt a compressed log, which may already be closed anyway */
+    Logger* logger = logger_getDefault();
+    if(!isatty(fileno(stdout)) && !(logger && logger_isCompressingOutput(logger))) {
         g_print("%s%s**ABORTING**\n", errorString->str, backtraceString->str);
     }
     g_printerr("%s%s**ABORTING**\n", errorString->str, backtraceString->str);
@@ -131,6 +133,54 @@ gboolean utility_isRandomPath(const gchar* path) {
     }
 }
 
+gsize utility_getIOVecLength(const struct iovec* iov, gint iovcnt) {
+    gsize totalLength = 0;
+    for(gint i = 0; i < iovcnt; i++) {
+        totalLength += iov[i].iov_len;
+    }
+    return totalLength;
+}
+
+/* copy up to nBytes out of the iovec array, starting iovOffset bytes into it */
+gsize utility_copyFromIOVec(const struct iovec* iov, gint iovcnt, gsize iovOffset,
+        gpointer destBuffer, gsize nBytes) {
+    gsize bytesCopied = 0;
+
+    for(gint i = 0; i < iovcnt && bytesCopied < nBytes; i++) {
+        if(iovOffset >= iov[i].iov_len) {
+            iovOffset -= iov[i].iov_len;
+            continue;
+        }
+
+        gsize copyLength = MIN(iov[i].iov_len - iovOffset, nBytes - bytesCopied);
+        memcpy(((guchar*)destBuffer) + bytesCopied, ((guchar*)iov[i].iov_base) + iovOffset, copyLength);
+        bytesCopied += copyLength;
+        iovOffset = 0;
+    }
+
+    return bytesCopied;
+}
+
+/* copy up to nBytes into the iovec array, starting iovOffset bytes into it */
+gsize utility_copyToIOVec(const struct iovec* iov, gint iovcnt, gsize iovOffset,
+        gconstpointer sourceBuffer, gsize nBytes) {
+    gsize bytesCopied = 0;
+
+    for(gint i = 0; i < iovcnt && bytesCopied < nBytes; i++) {
+        if(iovOffset >= iov[i].iov_len) {
+            iovOffset -= iov[i].iov_len;
+            continue;
+        }
+
+        gsize copyLength = MIN(iov[i].iov_len - iovOffset, nBytes - bytesCopied);
+        memcpy(((guchar*)iov[i].iov_base) + iovOffset, ((const guchar*)sourceBuffer) + bytesCopied, copyLength);
+        bytesCopied += copyLength;
+        iovOffset = 0;
+    }
+
+    return bytesCopied;
+}
+
 gboolean utility_removeAll(const gchar* path) {
     if(!path || !g_file_test(path, G_FILE_TEST_EXISTS)) {
         return FALSE;
@@ -32,6 +32,12 @@ gchar* utility_getHomePath(const gchar* path);
 guint utility_getRawCPUFrequency(const gchar* freqFilename);
 gboolean utility_isRandomPath(const gchar* path);
 
+gsize utility_getIOVecLength(const struct iovec* iov, gint iovcnt);
+gsize utility_copyFromIOVec(const struct iovec* iov, gint iovcnt, gsize iovOffset,
+        gpointer destBuffer, gsize nBytes);
+gsize utility_copyToIOVec(const struct iovec* iov, gint iovcnt, gsize iovOffset,
+        gconstpointer sourceBuffer, gsize nBytes);
+
 gboolean utility_removeAll(const gchar* path);
 gboolean utility_copyAll(const gchar* srcPath, const gchar* dstPath);
 
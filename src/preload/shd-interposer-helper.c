@@ -4,3 +4,7 @@
 int interposer_setShadowIsLoaded(int isLoaded) {
     return -1;
 }
+
+int interposer_setTimePage(void* page) {
+    return -1;
+}
@@ -125,6 +125,15 @@ int interposer_setShadowIsLoaded(int isLoaded) {
     return 0;
 }
 
+/* the emulated time of the process that this worker thread is running, so that
+ * time queries from the plugin can be answered without switching into shadow */
+static __thread ProcessTimePage* activeTimePage = NULL;
+
+int interposer_setTimePage(ProcessTimePage* page) {
+    activeTimePage = page;
+    return 0;
+}
+
 static void _interposer_globalInitializeHelper() {
     if(directorIsInitialized) {
         return;
@@ -260,6 +269,64 @@ void* calloc(size_t nmemb, size_t size) {
         return director.next.calloc(nmemb, size);
     }
 }
+/* plug-in memory may come from a host arena but be used from shadow's context,
+ * e.g. by plug-in destructors that run during dlclose. returns the arena that
+ * owns ptr, or NULL if it came from the regular heap */
+static Arena* _getArenaFor(void* ptr) {
+    if(ptr && director.shadowIsLoaded && worker_isAlive()) {
+        Host* host = worker_getActiveHost();
+        Arena* arena = host ? host_getArena(host) : NULL;
+        if(arena && arena_contains(arena, ptr)) {
+            return arena;
+        }
+    }
+    return NULL;
+}
+
+void* realloc(void *ptr, size_t size) {
+    Process* proc = NULL;
+    if((proc = _doEmulate()) != NULL) {
+        return process_emu_realloc(proc, ptr, size);
+    }
+
+    Arena* arena = _getArenaFor(ptr);
+    if(arena) {
+        /* shadow does not allocate from the arena, so move the block to the regular heap */
+        size_t usable = arena_getUsableSize(arena, ptr);
+        if(size && size <= usable) {
+            return ptr;
+        }
+        void* newptr = NULL;
+        if(size) {
+            ENSURE(malloc);
+            if((newptr = director.next.malloc(size)) == NULL) {
+                return NULL;
+            }
+            memcpy(newptr, ptr, usable);
+        }
+        arena_deallocate(arena, ptr);
+        return newptr;
+    }
+
+    ENSURE(realloc);
+    return director.next.realloc(ptr, size);
+}
+
+size_t malloc_usable_size(void *ptr) {
+    Process* proc = NULL;
+    if((proc = _doEmulate()) != NULL) {
+        return process_emu_malloc_usable_size(proc, ptr);
+    }
+
+    Arena* arena = _getArenaFor(ptr);
+    if(arena) {
+        return arena_getUsableSize(arena, ptr);
+    }
+
+    ENSURE(malloc_usable_size);
+    return director.next.malloc_usable_size(ptr);
+}
+
 /* free is special because of our dummy allocator used during initialization */
 void free(void *ptr) {
     Process* proc = NULL;
@@ -275,6 +342,12 @@ void free(void *ptr) {
             return;
         }
 
+        Arena* arena = _getArenaFor(ptr);
+        if(arena) {
+            arena_deallocate(arena, ptr);
+            return;
+        }
+
         ENSURE(free);
         director.next.free(ptr);
     }
@@ -357,6 +430,71 @@ int openat(int dirfd, const char *pathname, int flags, ...) {
     return result;
 }
 
+/* time queries are frequent, so answer them from the time page when possible */
+
+static inline ProcessTimePage* _getTimePage() {
+    ProcessTimePage* page = activeTimePage;
+    if(page != NULL && page->isEmulating && (*(&disableCount)) <= 0 && (*(&isRecursive)) == 0) {
+        return page;
+    }
+    return NULL;
+}
+
+time_t time(time_t *t) {
+    ProcessTimePage* page = _getTimePage();
+    if(page != NULL) {
+        time_t secs = (time_t)(page->now / SIMTIME_ONE_SECOND);
+        if(t != NULL) {
+            *t = secs;
+        }
+        return secs;
+    }
+
+    Process* proc = NULL;
+    if((proc = _doEmulate()) != NULL) {
+        return process_emu_time(proc, t);
+    } else {
+        ENSURE(time);
+        return director.next.time(t);
+    }
+}
+
+int clock_gettime(clockid_t clk_id, struct timespec *tp) {
+    ProcessTimePage* page = _getTimePage();
+    if(page != NULL && tp != NULL) {
+        tp->tv_sec = (time_t)(page->now / SIMTIME_ONE_SECOND);
+        tp->tv_nsec = (long)(page->now % SIMTIME_ONE_SECOND);
+        return 0;
+    }
+
+    Process* proc = NULL;
+    if((proc = _doEmulate()) != NULL) {
+        return process_emu_clock_gettime(proc, clk_id, tp);
+    } else {
+        ENSURE(clock_gettime);
+        return director.next.clock_gettime(clk_id, tp);
+    }
+}
+
+int gettimeofday(struct timeval* tv, struct timezone* tz) {
+    ProcessTimePage* page = _getTimePage();
+    if(page != NULL) {
+        if(tv != NULL) {
+            tv->tv_sec = (time_t)(page->now / SIMTIME_ONE_SECOND);
+            tv->tv_usec = (suseconds_t)((page->now % SIMTIME_ONE_SECOND) / SIMTIME_ONE_MICROSECOND);
+        }
+        return 0;
+    }
+
+    Process* proc = NULL;
+    if((proc = _doEmulate()) != NULL) {
+        return process_emu_gettimeofday(proc, tv, tz);
+    } else {
+        ENSURE(gettimeofday);
+        return director.next.gettimeofday(tv, tz);
+    }
+}
+
 int printf(const char *format, ...) {
     va_list arglist;
     va_start(arglist, format);
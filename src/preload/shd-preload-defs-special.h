@@ -10,7 +10,9 @@
 //typedef void (*free_func)(void*);
 PRELOADDEF(return, void*, malloc, (size_t a), a);
 PRELOADDEF(return, void*, calloc, (size_t a, size_t b), a, b);
+PRELOADDEF(return, void*, realloc, (void* a, size_t b), a, b);
 PRELOADDEF(      , void, free, (void* a), a);
+PRELOADDEF(return, size_t, malloc_usable_size, (void* a), a);
 
 //typedef int (*fcntl_func)(int, int, ...);
 //typedef int (*ioctl_func)(int, int, ...);
@@ -29,6 +31,13 @@ PRELOADDEF(return, int, open, (const char* a, int b, mode_t c), a, b, c);
 PRELOADDEF(return, int, open64, (const char* a, int b, mode_t c), a, b, c);
 PRELOADDEF(return, int, openat, (int a, const char* b, int c, mode_t d), a, b, c, d);
 
+//typedef time_t (*time_func)(time_t*);
+//typedef int (*clock_gettime_func)(clockid_t, struct timespec*);
+//typedef int (*gettimeofday_func)(struct timeval*, struct timezone*);
+PRELOADDEF(return, time_t, time, (time_t *a), a);
+PRELOADDEF(return, int, clock_gettime, (clockid_t a, struct timespec *b), a, b);
+PRELOADDEF(return, int, gettimeofday, (struct timeval* a, struct timezone* b), a, b);
+
 //typedef void (*pthread_exit_func)(void *);
 //typedef void (*exit_func)(int status);
 PRELOADDEF(      , void, pthread_exit, (void* a), a);
@@ -7,7 +7,6 @@
 
 /* memory allocation family */
 
-PRELOADDEF(return, void*, realloc, (void* a, size_t b), a, b);
 PRELOADDEF(return, int, posix_memalign, (void** a, size_t b, size_t c), a, b, c);
 PRELOADDEF(return, void*, memalign, (size_t a, size_t b), a, b);
 PRELOADDEF(return, void*, aligned_alloc, (size_t a, size_t b), a, b);
@@ -37,6 +36,8 @@ PRELOADDEF(return, ssize_t, sendmsg, (int a, const struct msghdr *b, int c), a,
 PRELOADDEF(return, ssize_t, recv, (int a, void *b, size_t c, int d), a, b, c, d);
 PRELOADDEF(return, ssize_t, recvfrom, (int a, void *b, size_t c, int d, struct sockaddr* e, socklen_t *f), a, b, c, d, e, f);
 PRELOADDEF(return, ssize_t, recvmsg, (int a, struct msghdr *b, int c), a, b, c);
+PRELOADDEF(return, int, sendmmsg, (int a, struct mmsghdr *b, unsigned int c, int d), a, b, c, d);
+PRELOADDEF(return, int, recvmmsg, (int a, struct mmsghdr *b, unsigned int c, int d, struct timespec *e), a, b, c, d, e);
 PRELOADDEF(return, int, getsockopt, (int a, int b, int c, void* d, socklen_t* e), a, b, c, d, e);
 PRELOADDEF(return, int, setsockopt, (int a, int b, int c, const void *d, socklen_t e), a, b, c, d, e);
 PRELOADDEF(return, int, listen, (int a, int b), a, b);
@@ -49,6 +50,9 @@ PRELOADDEF(return, ssize_t, readv, (int a, const struct iovec *b, int c), a, b,
 PRELOADDEF(return, ssize_t, writev, (int a, const struct iovec *b, int c), a, b, c);
 PRELOADDEF(return, ssize_t, pread, (int a, void *b, size_t c, off_t d), a, b, c, d);
 PRELOADDEF(return, ssize_t, pwrite, (int a, const void *b, size_t c, off_t d), a, b, c, d);
+PRELOADDEF(return, ssize_t, sendfile, (int a, int b, off_t *c, size_t d), a, b, c, d);
+PRELOADDEF(return, ssize_t, sendfile64, (int a, int b, off64_t *c, size_t d), a, b, c, d);
+PRELOADDEF(return, ssize_t, splice, (int a, off64_t *b, int c, off64_t *d, size_t e, unsigned int f), a, b, c, d, e, f);
 PRELOADDEF(return, int, close, (int a), a);
 PRELOADDEF(return, int, pipe2, (int a[2], int b), a, b);
 PRELOADDEF(return, int, pipe, (int a[2]), a);
@@ -128,9 +132,6 @@ PRELOADDEF(return, int, fflush, (FILE *a), a);
 
 /* time family */
 
-PRELOADDEF(return, time_t, time, (time_t *a), a);
-PRELOADDEF(return, int, clock_gettime, (clockid_t a, struct timespec *b), a, b);
-PRELOADDEF(return, int, gettimeofday, (struct timeval* a, struct timezone* b), a, b);
 PRELOADDEF(return, struct tm *, localtime, (const time_t *a), a);
 PRELOADDEF(return, struct tm *, localtime_r, (const time_t *a, struct tm *b), a, b);
 PRELOADDEF(return, int, pthread_getcpuclockid, (pthread_t a, clockid_t *b), a, b);
@@ -37,6 +37,7 @@
 #include <sys/types.h>
 #include <sys/file.h>
 #include <sys/uio.h>
+#include <sys/sendfile.h>
 #include <linux/sockios.h>
 #include <features.h>
 
@@ -0,0 +1,203 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "shadow.h"
+
+/* unit tests for the per-host allocation arena, run directly against
+ * shd-arena.c without starting a simulation */
+
+#define TEST_ARENA_SIZE (4*1024*1024)
+
+static gint _test_alignment(Arena* arena) {
+    /* the default alignment matches malloc */
+    for(gsize size = 1; size <= 4096; size *= 3) {
+        gpointer ptr = arena_allocate(arena, 0, size);
+        if(ptr == NULL || ((guintptr)ptr % 16) != 0) {
+            printf("allocation of %"G_GSIZE_FORMAT" bytes returned %p, expected 16-byte alignment\n", size, ptr);
+            return -1;
+        }
+    }
+
+    for(gsize alignment = 8; alignment <= 4096; alignment *= 2) {
+        gpointer ptr = arena_allocate(arena, alignment, 100);
+        if(ptr == NULL || ((guintptr)ptr % alignment) != 0) {
+            printf("allocation with alignment %"G_GSIZE_FORMAT" returned %p\n", alignment, ptr);
+            return -1;
+        }
+        if(arena_getUsableSize(arena, ptr) < 100) {
+            printf("aligned allocation has only %"G_GSIZE_FORMAT" usable bytes\n", arena_getUsableSize(arena, ptr));
+            return -1;
+        }
+        /* the whole block must be writable */
+        memset(ptr, 0xAB, arena_getUsableSize(arena, ptr));
+    }
+
+    /* alignments that are not a power of two or larger than a page are left to libc */
+    if(arena_allocate(arena, 24, 100) != NULL || arena_allocate(arena, 1024*1024, 100) != NULL) {
+        printf("unsupported alignments should not be served by the arena\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static gint _test_reuse(Arena* arena) {
+    gpointer first = arena_allocate(arena, 0, 200);
+    gpointer second = arena_allocate(arena, 0, 200);
+    if(first == NULL || second == NULL || first == second) {
+        printf("live blocks must not overlap\n");
+        return -1;
+    }
+
+    /* a freed block is handed out again for the same size class */
+    arena_deallocate(arena, first);
+    gpointer third = arena_allocate(arena, 0, 180);
+    if(third != first) {
+        printf("freed block %p was not reused, got %p\n", first, third);
+        return -1;
+    }
+
+    /* large blocks give their pages back but stay usable */
+    gpointer large = arena_allocate(arena, 0, 512*1024);
+    if(large == NULL) {
+        printf("large allocation failed\n");
+        return -1;
+    }
+    memset(large, 0xCD, 512*1024);
+    arena_deallocate(arena, large);
+    gpointer largeAgain = arena_allocate(arena, 0, 512*1024);
+    if(largeAgain != large) {
+        printf("freed large block %p was not reused, got %p\n", large, largeAgain);
+        return -1;
+    }
+    memset(largeAgain, 0xEF, 512*1024);
+
+    arena_deallocate(arena, second);
+    arena_deallocate(arena, third);
+    arena_deallocate(arena, largeAgain);
+    return 0;
+}
+
+static gint _test_contains(Arena* arena) {
+    gpointer ptr = arena_allocate(arena, 0, 64);
+    gint onStack = 0;
+    gpointer onHeap = g_malloc(64);
+
+    gint result = 0;
+    if(!arena_contains(arena, ptr) || !arena_contains(arena, (guchar*)ptr + 63)) {
+        printf("arena does not contain its own block %p\n", ptr);
+        result = -1;
+    } else if(arena_contains(arena, &onStack) || arena_contains(arena, onHeap) || arena_contains(arena, NULL)) {
+        printf("arena claims memory it does not own\n");
+        result = -1;
+    }
+
+    g_free(onHeap);
+    arena_deallocate(arena, ptr);
+    return result;
+}
+
+static gint _test_reallocate(Arena* arena) {
+    guchar* ptr = arena_reallocate(arena, NULL, 10);
+    if(ptr == NULL) {
+        printf("reallocate of NULL did not allocate\n");
+        return -1;
+    }
+    for(gint i = 0; i < 10; i++) {
+        ptr[i] = (guchar)i;
+    }
+
+    /* shrinking or growing within the block keeps it in place */
+    if(arena_reallocate(arena, ptr, 5) != ptr ||
+            arena_reallocate(arena, ptr, arena_getUsableSize(arena, ptr)) != ptr) {
+        printf("reallocate moved a block that still fits\n");
+        return -1;
+    }
+
+    /* growth moves the contents to a larger block */
+    gsize size = 10;
+    while(size < 100000) {
+        size *= 7;
+        guchar* grown = arena_reallocate(arena, ptr, size);
+        if(grown == NULL || arena_getUsableSize(arena, grown) < size) {
+            printf("reallocate to %"G_GSIZE_FORMAT" bytes failed\n", size);
+            return -1;
+        }
+        for(gint i = 0; i < 10; i++) {
+            if(grown[i] != (guchar)i) {
+                printf("reallocate to %"G_GSIZE_FORMAT" bytes lost the contents\n", size);
+                return -1;
+            }
+        }
+        ptr = grown;
+    }
+
+    arena_deallocate(arena, ptr);
+    return 0;
+}
+
+static gint _test_exhaustion() {
+    Arena* arena = arena_new(64*1024);
+
+    /* the caller falls back to the regular heap when we run out */
+    gint result = 0;
+    if(arena_allocate(arena, 0, 128*1024) != NULL) {
+        printf("allocation larger than the arena succeeded\n");
+        result = -1;
+    }
+
+    gint numBlocks = 0;
+    while(arena_allocate(arena, 0, 1000) != NULL && numBlocks < 1000) {
+        numBlocks++;
+    }
+    if(numBlocks == 0 || numBlocks >= 1000) {
+        printf("filled the arena with %i blocks\n", numBlocks);
+        result = -1;
+    }
+
+    arena_free(arena);
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    fprintf(stdout, "########## arena test starting ##########\n");
+
+    Arena* arena = arena_new(TEST_ARENA_SIZE);
+    if(arena == NULL) {
+        fprintf(stdout, "########## unable to create arena\n");
+        return EXIT_FAILURE;
+    }
+
+    gint result = 0;
+    if(_test_alignment(arena) < 0) {
+        fprintf(stdout, "########## _test_alignment() failed\n");
+        result = -1;
+    } else if(_test_reuse(arena) < 0) {
+        fprintf(stdout, "########## _test_reuse() failed\n");
+        result = -1;
+    } else if(_test_contains(arena) < 0) {
+        fprintf(stdout, "########## _test_contains() failed\n");
+        result = -1;
+    } else if(_test_reallocate(arena) < 0) {
+        fprintf(stdout, "########## _test_reallocate() failed\n");
+        result = -1;
+    } else if(_test_exhaustion() < 0) {
+        fprintf(stdout, "########## _test_exhaustion() failed\n");
+        result = -1;
+    }
+
+    arena_free(arena);
+
+    if(result < 0) {
+        return EXIT_FAILURE;
+    }
+
+    fprintf(stdout, "########## arena test passed! ##########\n");
+    return EXIT_SUCCESS;
+}
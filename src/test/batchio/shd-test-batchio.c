@@ -0,0 +1,369 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <../shd-test-common.h>
+
+#define FILESIZE 20000
+#define NUMDATAGRAMS 3
+
+static void _fillcharbuf(char* buffer, int size) {
+    int i = 0;
+    for (i = 0; i < size; i++) {
+        int n = rand() % 26;
+        buffer[i] = 'a' + n;
+    }
+}
+
+static int _expect_error(const char* name, ssize_t result, int expected) {
+    if(result != -1 || errno != expected) {
+        printf("%s returned %li with errno '%s', expected errno '%s'\n",
+                name, (long)result, strerror(errno), strerror(expected));
+        return -1;
+    }
+    return 0;
+}
+
+static int _wait_writable(int fd) {
+    struct pollfd pfd = {fd, POLLOUT, 0};
+    if(poll(&pfd, 1, -1) < 0) {
+        printf("poll() error was: %s\n", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static int _recv_all(int fd, char* buffer, size_t length) {
+    size_t total = 0;
+    while(total < length) {
+        ssize_t n = recv(fd, buffer + total, length - total, 0);
+        if(n <= 0) {
+            printf("recv() returned %li, error was: %s\n", (long)n, strerror(errno));
+            return -1;
+        }
+        total += (size_t)n;
+    }
+    return 0;
+}
+
+static int _create_file(const char* name, const char* contents, size_t length) {
+    int fd = open(name, O_RDWR|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR);
+    if(fd < 0) {
+        printf("open() error was: %s\n", strerror(errno));
+        return -1;
+    }
+    if(contents != NULL && write(fd, contents, length) != (ssize_t)length) {
+        printf("write() error was: %s\n", strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int _test_mmsg() {
+    int sd = -1, cd = -1, result = -1;
+
+    struct sockaddr_in saddr;
+    memset(&saddr, 0, sizeof(struct sockaddr_in));
+    saddr.sin_family = AF_INET;
+    saddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    saddr.sin_port = htons(31001);
+
+    sd = socket(AF_INET, SOCK_DGRAM, 0);
+    cd = socket(AF_INET, SOCK_DGRAM, 0);
+    if(sd < 0 || cd < 0) {
+        printf("socket() error was: %s\n", strerror(errno));
+        goto out;
+    }
+    if(bind(sd, (struct sockaddr*)&saddr, sizeof(saddr)) < 0) {
+        printf("bind() error was: %s\n", strerror(errno));
+        goto out;
+    }
+
+    /* the empty datagram in the middle must not end the receive batch */
+    char* payloads[NUMDATAGRAMS] = {"hello", "", "world"};
+    struct iovec sendiov[NUMDATAGRAMS];
+    struct mmsghdr sendvec[NUMDATAGRAMS];
+    memset(sendvec, 0, sizeof(sendvec));
+    for(int i = 0; i < NUMDATAGRAMS; i++) {
+        sendiov[i].iov_base = payloads[i];
+        sendiov[i].iov_len = strlen(payloads[i]);
+        sendvec[i].msg_hdr.msg_iov = &sendiov[i];
+        sendvec[i].msg_hdr.msg_iovlen = 1;
+        sendvec[i].msg_hdr.msg_name = &saddr;
+        sendvec[i].msg_hdr.msg_namelen = sizeof(saddr);
+    }
+
+    int n = sendmmsg(cd, sendvec, NUMDATAGRAMS, 0);
+    if(n != NUMDATAGRAMS) {
+        printf("sendmmsg() returned %i, error was: %s\n", n, strerror(errno));
+        goto out;
+    }
+    for(int i = 0; i < NUMDATAGRAMS; i++) {
+        if(sendvec[i].msg_len != strlen(payloads[i])) {
+            printf("sendmmsg() sent %u bytes of message %i\n", sendvec[i].msg_len, i);
+            goto out;
+        }
+    }
+
+    char recvbufs[NUMDATAGRAMS][16];
+    struct iovec recviov[NUMDATAGRAMS];
+    struct mmsghdr recvvec[NUMDATAGRAMS];
+    memset(recvvec, 0, sizeof(recvvec));
+    for(int i = 0; i < NUMDATAGRAMS; i++) {
+        recviov[i].iov_base = recvbufs[i];
+        recviov[i].iov_len = sizeof(recvbufs[i]);
+        recvvec[i].msg_hdr.msg_iov = &recviov[i];
+        recvvec[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    /* not every datagram has to be queued when the first call returns */
+    int numReceived = 0;
+    while(numReceived < NUMDATAGRAMS) {
+        n = recvmmsg(sd, &recvvec[numReceived], NUMDATAGRAMS - numReceived, MSG_WAITFORONE, NULL);
+        if(n <= 0) {
+            printf("recvmmsg() returned %i, error was: %s\n", n, strerror(errno));
+            goto out;
+        }
+        numReceived += n;
+    }
+
+    for(int i = 0; i < NUMDATAGRAMS; i++) {
+        size_t length = strlen(payloads[i]);
+        if(recvvec[i].msg_len != length || memcmp(recvbufs[i], payloads[i], length) != 0) {
+            printf("recvmmsg() message %i has length %u, expected %lu\n",
+                    i, recvvec[i].msg_len, (unsigned long)length);
+            goto out;
+        }
+    }
+
+    if(_expect_error("sendmmsg() with a bad descriptor", sendmmsg(-1, sendvec, 1, 0), EBADF) < 0 ||
+            _expect_error("recvmmsg() with a bad descriptor", recvmmsg(-1, recvvec, 1, MSG_DONTWAIT, NULL), EBADF) < 0 ||
+            _expect_error("sendmmsg() without messages", sendmmsg(cd, NULL, 1, 0), EFAULT) < 0) {
+        goto out;
+    }
+
+    result = 0;
+
+out:
+    if(cd >= 0) {
+        close(cd);
+    }
+    if(sd >= 0) {
+        close(sd);
+    }
+    return result;
+}
+
+static int _test_sendfile() {
+    int sd = -1, cd = -1, sd_child = -1, filed = -1, result = -1;
+    char* contents = calloc(1, FILESIZE);
+    char* received = calloc(1, FILESIZE);
+    _fillcharbuf(contents, FILESIZE);
+
+    filed = _create_file("batchio-sendfile", contents, FILESIZE);
+    if(filed < 0) {
+        goto out;
+    }
+    if(common_get_connected_tcp_sockets(htons(31002), &sd, &sd_child, &cd) < 0) {
+        goto out;
+    }
+
+    /* the file offset is only advanced through the offset argument */
+    off_t offset = 0;
+    while(offset < FILESIZE) {
+        if(_wait_writable(cd) < 0) {
+            goto out;
+        }
+        ssize_t n = sendfile(cd, filed, &offset, FILESIZE - offset);
+        if(n < 0 && errno != EAGAIN) {
+            printf("sendfile() error was: %s\n", strerror(errno));
+            goto out;
+        }
+    }
+
+    if(lseek(filed, 0, SEEK_CUR) != FILESIZE) {
+        printf("sendfile() moved the file offset even though we gave it one\n");
+        goto out;
+    }
+    if(_recv_all(sd_child, received, FILESIZE) < 0) {
+        goto out;
+    }
+    if(memcmp(contents, received, FILESIZE) != 0) {
+        printf("sendfile() corrupted the file contents\n");
+        goto out;
+    }
+
+    /* the input must be a file, not a socket */
+    if(_expect_error("sendfile() from a socket", sendfile(cd, sd_child, NULL, 16), EINVAL) < 0 ||
+            _expect_error("sendfile() with a bad descriptor", sendfile(cd, -1, NULL, 16), EBADF) < 0) {
+        goto out;
+    }
+
+    result = 0;
+
+out:
+    if(filed >= 0) {
+        close(filed);
+    }
+    unlink("batchio-sendfile");
+    if(cd >= 0) {
+        close(cd);
+    }
+    if(sd_child >= 0) {
+        close(sd_child);
+    }
+    if(sd >= 0) {
+        close(sd);
+    }
+    free(contents);
+    free(received);
+    return result;
+}
+
+static ssize_t _splice_all(int infd, loff_t* inoffset, int outfd, size_t length, int nonblockingOut) {
+    size_t total = 0;
+    while(total < length) {
+        if(nonblockingOut && _wait_writable(outfd) < 0) {
+            return -1;
+        }
+        ssize_t n = splice(infd, inoffset, outfd, NULL, length - total, 0);
+        if(n < 0 && errno == EAGAIN) {
+            continue;
+        } else if(n <= 0) {
+            printf("splice() returned %li, error was: %s\n", (long)n, strerror(errno));
+            return -1;
+        }
+        total += (size_t)n;
+    }
+    return (ssize_t)total;
+}
+
+static int _test_splice() {
+    int sd = -1, cd = -1, sd_child = -1, infiled = -1, outfiled = -1, result = -1;
+    int pipefds[2] = {-1, -1};
+    char* contents = calloc(1, FILESIZE);
+    char* received = calloc(1, FILESIZE);
+    _fillcharbuf(contents, FILESIZE);
+
+    infiled = _create_file("batchio-splice-in", contents, FILESIZE);
+    outfiled = _create_file("batchio-splice-out", NULL, 0);
+    if(infiled < 0 || outfiled < 0) {
+        goto out;
+    }
+    if(pipe(pipefds) < 0) {
+        printf("pipe() error was: %s\n", strerror(errno));
+        goto out;
+    }
+    if(common_get_connected_tcp_sockets(htons(31003), &sd, &sd_child, &cd) < 0) {
+        goto out;
+    }
+
+    /* file -> pipe -> socket, in pieces no larger than the pipe can hold */
+    loff_t inoffset = 0;
+    while(inoffset < FILESIZE) {
+        size_t chunk = (FILESIZE - inoffset) < 4096 ? (size_t)(FILESIZE - inoffset) : 4096;
+        if(_splice_all(infiled, &inoffset, pipefds[1], chunk, 0) < 0 ||
+                _splice_all(pipefds[0], NULL, cd, chunk, 1) < 0) {
+            goto out;
+        }
+    }
+
+    /* socket -> pipe -> file */
+    size_t total = 0;
+    while(total < FILESIZE) {
+        ssize_t n = splice(sd_child, NULL, pipefds[1], NULL, FILESIZE - total, 0);
+        if(n <= 0) {
+            printf("splice() from a socket returned %li, error was: %s\n", (long)n, strerror(errno));
+            goto out;
+        }
+        if(_splice_all(pipefds[0], NULL, outfiled, (size_t)n, 0) < 0) {
+            goto out;
+        }
+        total += (size_t)n;
+    }
+
+    if(pread(outfiled, received, FILESIZE, 0) != FILESIZE || memcmp(contents, received, FILESIZE) != 0) {
+        printf("splice() corrupted the file contents\n");
+        goto out;
+    }
+
+    /* one end must be a pipe, and pipes have no offsets */
+    loff_t offset = 0;
+    if(_expect_error("splice() from a file to a socket", splice(infiled, NULL, cd, NULL, 16, 0), EINVAL) < 0 ||
+            _expect_error("splice() from a socket to a file", splice(sd_child, NULL, outfiled, NULL, 16, SPLICE_F_NONBLOCK), EINVAL) < 0 ||
+            _expect_error("splice() with a pipe offset", splice(infiled, NULL, pipefds[1], &offset, 16, 0), ESPIPE) < 0 ||
+            _expect_error("splice() with a bad descriptor", splice(-1, NULL, pipefds[1], NULL, 16, 0), EBADF) < 0) {
+        goto out;
+    }
+
+    result = 0;
+
+out:
+    if(infiled >= 0) {
+        close(infiled);
+    }
+    if(outfiled >= 0) {
+        close(outfiled);
+    }
+    unlink("batchio-splice-in");
+    unlink("batchio-splice-out");
+    if(pipefds[0] >= 0) {
+        close(pipefds[0]);
+    }
+    if(pipefds[1] >= 0) {
+        close(pipefds[1]);
+    }
+    if(cd >= 0) {
+        close(cd);
+    }
+    if(sd_child >= 0) {
+        close(sd_child);
+    }
+    if(sd >= 0) {
+        close(sd);
+    }
+    free(contents);
+    free(received);
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    fprintf(stdout, "########## batchio test starting ##########\n");
+
+    fprintf(stdout, "########## running test_mmsg\n");
+    if(_test_mmsg() < 0) {
+        fprintf(stdout, "########## _test_mmsg() failed\n");
+        return EXIT_FAILURE;
+    }
+
+    fprintf(stdout, "########## running test_sendfile\n");
+    if(_test_sendfile() < 0) {
+        fprintf(stdout, "########## _test_sendfile() failed\n");
+        return EXIT_FAILURE;
+    }
+
+    fprintf(stdout, "########## running test_splice\n");
+    if(_test_splice() < 0) {
+        fprintf(stdout, "########## _test_splice() failed\n");
+        return EXIT_FAILURE;
+    }
+
+    fprintf(stdout, "########## batchio test passed! ##########\n");
+    return EXIT_SUCCESS;
+}
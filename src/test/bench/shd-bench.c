@@ -0,0 +1,554 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#include <unistd.h>
+#include <glib/gstdio.h>
+
+#include "shadow.h"
+
+/* microbenchmarks for the data structures on shadow's hot paths. every
+ * benchmark does a fixed amount of work from fixed seeds, so two runs on the
+ * same machine are comparable. the results are written as json. */
+
+#define BENCH_SEED 1337
+#define BENCH_NUM_HOSTS 64
+#define BENCH_NUM_VERTICES 64
+#define BENCH_PAYLOAD_SIZE 1460
+
+typedef struct _BenchOptions BenchOptions;
+struct _BenchOptions {
+    gint repetitions;
+    gdouble scale;
+    gchar* filter;
+    gchar* outputPath;
+};
+
+typedef struct _BenchContext BenchContext;
+struct _BenchContext {
+    /* reseeded before every repetition */
+    GRand* random;
+    /* started and stopped by each benchmark around the measured work only */
+    GTimer* timer;
+    Host* hosts[BENCH_NUM_HOSTS];
+    gchar* topologyPath;
+    /* results are folded in here so the compiler cannot drop the work */
+    guint64 checksum;
+};
+
+/* runs nOperations of some work and returns how many operations it did */
+typedef guint64 (*BenchRunFunc)(BenchContext* context, guint64 nOperations);
+
+typedef struct _Benchmark Benchmark;
+struct _Benchmark {
+    const gchar* name;
+    const gchar* description;
+    guint64 nOperations;
+    BenchRunFunc run;
+};
+
+static gint _bench_compareUInt64(gconstpointer a, gconstpointer b, gpointer userData) {
+    guint64 x = *((const guint64*)a);
+    guint64 y = *((const guint64*)b);
+    return (x > y) ? 1 : (x < y) ? -1 : 0;
+}
+
+static guint64* _bench_newRandomKeys(BenchContext* context, guint64 n) {
+    guint64* keys = g_new(guint64, n);
+    for(guint64 i = 0; i < n; i++) {
+        keys[i] = ((guint64)g_rand_int(context->random) << 32) | g_rand_int(context->random);
+    }
+    return keys;
+}
+
+static guint64 _bench_runPriorityQueue(BenchContext* context, guint64 nOperations) {
+    guint64* keys = _bench_newRandomKeys(context, nOperations);
+    PriorityQueue* queue = priorityqueue_new(_bench_compareUInt64, NULL, NULL);
+
+    g_timer_start(context->timer);
+    for(guint64 i = 0; i < nOperations; i++) {
+        priorityqueue_push(queue, &keys[i]);
+    }
+    while(!priorityqueue_isEmpty(queue)) {
+        context->checksum += *((guint64*)priorityqueue_pop(queue));
+    }
+    g_timer_stop(context->timer);
+
+    priorityqueue_free(queue);
+    g_free(keys);
+    return nOperations;
+}
+
+static guint64 _bench_runAsyncPriorityQueue(BenchContext* context, guint64 nOperations) {
+    guint64* keys = _bench_newRandomKeys(context, nOperations);
+    AsyncPriorityQueue* queue = asyncpriorityqueue_new(_bench_compareUInt64, NULL, NULL);
+
+    g_timer_start(context->timer);
+    for(guint64 i = 0; i < nOperations; i++) {
+        asyncpriorityqueue_push(queue, &keys[i]);
+    }
+    while(!asyncpriorityqueue_isEmpty(queue)) {
+        context->checksum += *((guint64*)asyncpriorityqueue_pop(queue));
+    }
+    g_timer_stop(context->timer);
+
+    asyncpriorityqueue_free(queue);
+    g_free(keys);
+    return nOperations;
+}
+
+static guint64 _bench_runByteQueue(BenchContext* context, guint64 nOperations) {
+    /* segment sized writes and smaller application reads, like a socket buffer */
+    ByteQueue* queue = bytequeue_new(8192);
+    guchar inBuffer[BENCH_PAYLOAD_SIZE];
+    guchar outBuffer[1000];
+    memset(inBuffer, 'x', sizeof(inBuffer));
+
+    g_timer_start(context->timer);
+    for(guint64 i = 0; i < nOperations; i++) {
+        bytequeue_push(queue, inBuffer, sizeof(inBuffer));
+        context->checksum += bytequeue_pop(queue, outBuffer, sizeof(outBuffer));
+    }
+    gsize popped = 0;
+    while((popped = bytequeue_pop(queue, outBuffer, sizeof(outBuffer))) > 0) {
+        context->checksum += popped;
+    }
+    g_timer_stop(context->timer);
+
+    bytequeue_free(queue);
+    return nOperations;
+}
+
+static void _bench_runNothing(gpointer callbackObject, gpointer callbackArgument) {
+    return;
+}
+
+/* events with few distinct times, so that many comparisons fall through to the host ids */
+static Event** _bench_newEvents(BenchContext* context, guint64 n) {
+    Task* task = task_new(_bench_runNothing, NULL, NULL, NULL, NULL);
+    Event** events = g_new(Event*, n);
+    for(guint64 i = 0; i < n; i++) {
+        SimulationTime time = (SimulationTime)g_rand_int_range(context->random, 0, 1000) * SIMTIME_ONE_MILLISECOND;
+        Host* srcHost = context->hosts[g_rand_int_range(context->random, 0, BENCH_NUM_HOSTS)];
+        Host* dstHost = context->hosts[g_rand_int_range(context->random, 0, BENCH_NUM_HOSTS)];
+        events[i] = event_new_(task, time, srcHost, dstHost);
+    }
+    task_unref(task);
+    return events;
+}
+
+static void _bench_freeEvents(Event** events, guint64 n) {
+    for(guint64 i = 0; i < n; i++) {
+        event_unref(events[i]);
+    }
+    g_free(events);
+}
+
+static guint64 _bench_runEventCompare(BenchContext* context, guint64 nOperations) {
+    const guint64 nEvents = 4096;
+    Event** events = _bench_newEvents(context, nEvents);
+
+    /* draw the pairs up front so the random source is not measured */
+    guint32* pairs = g_new(guint32, 2 * nOperations);
+    for(guint64 i = 0; i < 2 * nOperations; i++) {
+        pairs[i] = g_rand_int_range(context->random, 0, (gint32)nEvents);
+    }
+
+    g_timer_start(context->timer);
+    for(guint64 i = 0; i < nOperations; i++) {
+        context->checksum += (guint64)(event_compare(events[pairs[2 * i]], events[pairs[2 * i + 1]], NULL) + 1);
+    }
+    g_timer_stop(context->timer);
+
+    g_free(pairs);
+    _bench_freeEvents(events, nEvents);
+    return nOperations;
+}
+
+static guint64 _bench_runEventQueue(BenchContext* context, guint64 nOperations) {
+    Event** events = _bench_newEvents(context, nOperations);
+    PriorityQueue* queue = priorityqueue_new((GCompareDataFunc)event_compare, NULL, NULL);
+
+    g_timer_start(context->timer);
+    for(guint64 i = 0; i < nOperations; i++) {
+        priorityqueue_push(queue, events[i]);
+    }
+    while(!priorityqueue_isEmpty(queue)) {
+        context->checksum += event_getTime(priorityqueue_pop(queue));
+    }
+    g_timer_stop(context->timer);
+
+    priorityqueue_free(queue);
+    _bench_freeEvents(events, nOperations);
+    return nOperations;
+}
+
+/* writes a connected but incomplete graph, so that paths need real shortest path searches */
+static gchar* _bench_newTopologyFile(BenchContext* context) {
+    GString* graph = g_string_new(
+            "<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\">\n"
+            "  <key attr.name=\"packetloss\" attr.type=\"double\" for=\"edge\" id=\"d4\" />\n"
+            "  <key attr.name=\"latency\" attr.type=\"double\" for=\"edge\" id=\"d3\" />\n"
+            "  <key attr.name=\"bandwidthup\" attr.type=\"int\" for=\"node\" id=\"d2\" />\n"
+            "  <key attr.name=\"bandwidthdown\" attr.type=\"int\" for=\"node\" id=\"d1\" />\n"
+            "  <graph edgedefault=\"undirected\">\n");
+
+    for(gint i = 0; i < BENCH_NUM_VERTICES; i++) {
+        g_string_append_printf(graph, "    <node id=\"poi-%i\"><data key=\"d1\">10240</data>"
+                "<data key=\"d2\">10240</data></node>\n", i);
+    }
+    for(gint i = 0; i < BENCH_NUM_VERTICES; i++) {
+        /* a ring, plus a few random chords from every vertex */
+        gint targets[3] = {(i + 1) % BENCH_NUM_VERTICES,
+                g_rand_int_range(context->random, 0, BENCH_NUM_VERTICES),
+                g_rand_int_range(context->random, 0, BENCH_NUM_VERTICES)};
+        for(gint j = 0; j < 3; j++) {
+            g_string_append_printf(graph, "    <edge source=\"poi-%i\" target=\"poi-%i\">"
+                    "<data key=\"d3\">%i.0</data><data key=\"d4\">0.0</data></edge>\n",
+                    i, targets[j], g_rand_int_range(context->random, 1, 100));
+        }
+    }
+    g_string_append(graph, "  </graph>\n</graphml>\n");
+
+    gchar* path = NULL;
+    GError* error = NULL;
+    gint fd = g_file_open_tmp("shadow-bench-XXXXXX.graphml.xml", &path, &error);
+    if(fd < 0) {
+        g_printerr("unable to create a temporary topology file: %s\n", error->message);
+        g_error_free(error);
+        g_string_free(graph, TRUE);
+        return NULL;
+    }
+    close(fd);
+
+    if(!g_file_set_contents(path, graph->str, (gssize)graph->len, &error)) {
+        g_printerr("unable to write the temporary topology file '%s': %s\n", path, error->message);
+        g_error_free(error);
+        g_free(path);
+        path = NULL;
+    }
+
+    g_string_free(graph, TRUE);
+    return path;
+}
+
+static guint64 _bench_runTopology(BenchContext* context, guint64 nOperations, gboolean isWarm) {
+    if(!context->topologyPath) {
+        return 0;
+    }
+
+    /* a new topology for each repetition, so that cold lookups really fill the path cache */
+    Topology* topology = topology_new(context->topologyPath);
+    if(!topology) {
+        return 0;
+    }
+
+    Random* random = random_new(BENCH_SEED);
+    Address* addresses[BENCH_NUM_HOSTS];
+    for(gint i = 0; i < BENCH_NUM_HOSTS; i++) {
+        addresses[i] = address_new(host_getID(context->hosts[i]), (guint)i,
+                (guint32)htonl(0x0B000001 + i), host_getName(context->hosts[i]), FALSE);
+        topology_attach(topology, addresses[i], random, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    }
+
+    guint32* pairs = g_new(guint32, 2 * nOperations);
+    for(guint64 i = 0; i < 2 * nOperations; i++) {
+        pairs[i] = g_rand_int_range(context->random, 0, BENCH_NUM_HOSTS);
+    }
+
+    if(isWarm) {
+        for(gint i = 0; i < BENCH_NUM_HOSTS; i++) {
+            for(gint j = 0; j < BENCH_NUM_HOSTS; j++) {
+                topology_getLatency(topology, addresses[i], addresses[j]);
+            }
+        }
+    }
+
+    g_timer_start(context->timer);
+    for(guint64 i = 0; i < nOperations; i++) {
+        gdouble latency = topology_getLatency(topology, addresses[pairs[2 * i]], addresses[pairs[2 * i + 1]]);
+        context->checksum += (guint64)latency;
+    }
+    g_timer_stop(context->timer);
+
+    g_free(pairs);
+    for(gint i = 0; i < BENCH_NUM_HOSTS; i++) {
+        topology_detach(topology, addresses[i]);
+        address_unref(addresses[i]);
+    }
+    random_free(random);
+    topology_free(topology);
+    return nOperations;
+}
+
+static guint64 _bench_runTopologyCold(BenchContext* context, guint64 nOperations) {
+    return _bench_runTopology(context, nOperations, FALSE);
+}
+
+static guint64 _bench_runTopologyWarm(BenchContext* context, guint64 nOperations) {
+    return _bench_runTopology(context, nOperations, TRUE);
+}
+
+static guint64 _bench_runPacketLifecycle(BenchContext* context, guint64 nOperations) {
+    guchar payload[BENCH_PAYLOAD_SIZE];
+    memset(payload, 'x', sizeof(payload));
+
+    /* packets with payloads take their priority from the active host */
+    worker_setActiveHost(context->hosts[0]);
+
+    g_timer_start(context->timer);
+    for(guint64 i = 0; i < nOperations; i++) {
+        Packet* packet = packet_new(payload, sizeof(payload), (guint)host_getID(context->hosts[0]), i);
+        packet_setTCP(packet, PTCP_ACK, htonl(0x0B000001), htons(80), htonl(0x0B000002), htons(8080), (guint)i);
+        Packet* copy = packet_copy(packet);
+        context->checksum += packet_getPayloadLength(copy);
+        packet_unref(packet);
+        packet_unref(copy);
+    }
+    g_timer_stop(context->timer);
+
+    worker_setActiveHost(NULL);
+    return nOperations;
+}
+
+typedef struct _BenchLatchData BenchLatchData;
+struct _BenchLatchData {
+    CountDownLatch* prepareRoundBarrier;
+    CountDownLatch* executeEventsBarrier;
+    guint64 nRounds;
+};
+
+static gpointer _bench_runLatchWorker(BenchLatchData* data) {
+    for(guint64 i = 0; i < data->nRounds; i++) {
+        countdownlatch_countDownAwait(data->prepareRoundBarrier);
+        countdownlatch_countDownAwait(data->executeEventsBarrier);
+    }
+    return NULL;
+}
+
+/* one worker and the main thread meeting at the two barriers of a scheduler round */
+static guint64 _bench_runCountDownLatch(BenchContext* context, guint64 nOperations) {
+    BenchLatchData data;
+    data.prepareRoundBarrier = countdownlatch_new(2);
+    data.executeEventsBarrier = countdownlatch_new(2);
+    data.nRounds = nOperations;
+
+    GThread* worker = g_thread_new("bench-latch", (GThreadFunc)_bench_runLatchWorker, &data);
+
+    g_timer_start(context->timer);
+    for(guint64 i = 0; i < nOperations; i++) {
+        countdownlatch_countDownAwait(data.prepareRoundBarrier);
+        countdownlatch_reset(data.prepareRoundBarrier);
+        countdownlatch_countDownAwait(data.executeEventsBarrier);
+        countdownlatch_reset(data.executeEventsBarrier);
+    }
+    g_timer_stop(context->timer);
+
+    g_thread_join(worker);
+    countdownlatch_free(data.prepareRoundBarrier);
+    countdownlatch_free(data.executeEventsBarrier);
+    return nOperations;
+}
+
+static guint64 benchLogBytes = 0;
+
+static void _bench_countLogOutput(const gchar* string) {
+    benchLogBytes += strlen(string);
+}
+
+/* from the first record until the helper thread has formatted and written all of them */
+static guint64 _bench_runLogger(BenchContext* context, guint64 nOperations) {
+    Logger* previousLogger = logger_getDefault();
+    if(previousLogger) {
+        logger_ref(previousLogger);
+    }
+
+    GPrintFunc previousPrintFunc = g_set_print_handler(_bench_countLogOutput);
+    worker_setActiveHost(context->hosts[0]);
+
+    g_timer_start(context->timer);
+    Logger* logger = logger_new(LOGLEVEL_INFO);
+    logger_setDefault(logger);
+    for(guint64 i = 0; i < nOperations; i++) {
+        logger_log(logger, LOGLEVEL_MESSAGE, __FILE__, __FUNCTION__, __LINE__,
+                "benchmark record %"G_GUINT64_FORMAT" of %"G_GUINT64_FORMAT" at %f", i, nOperations, (gdouble)i);
+    }
+    logger_flushRecords(logger, pthread_self());
+    logger_syncToDisk(logger);
+    /* the last reference, this waits for the helper to finish */
+    logger_setDefault(previousLogger);
+    logger_unref(logger);
+    g_timer_stop(context->timer);
+
+    worker_setActiveHost(NULL);
+    g_set_print_handler(previousPrintFunc);
+    if(previousLogger) {
+        logger_unref(previousLogger);
+    }
+
+    context->checksum += benchLogBytes;
+    return nOperations;
+}
+
+static const Benchmark benchmarks[] = {
+    {"priorityqueue-push-pop", "push then pop random 64 bit keys", 200000, _bench_runPriorityQueue},
+    {"asyncpriorityqueue-push-pop", "push then pop random 64 bit keys through the locked queue", 200000, _bench_runAsyncPriorityQueue},
+    {"bytequeue-push-pop", "push 1460 bytes and pop 1000 bytes at a time", 200000, _bench_runByteQueue},
+    {"event-compare", "compare random pairs of events between 64 hosts", 2000000, _bench_runEventCompare},
+    {"event-queue-push-pop", "push then pop events ordered by event_compare", 200000, _bench_runEventQueue},
+    {"topology-latency-cold", "latency lookups that compute and cache new paths", 20000, _bench_runTopologyCold},
+    {"topology-latency-warm", "latency lookups served from the path cache", 500000, _bench_runTopologyWarm},
+    {"packet-lifecycle", "create, copy, and unref a tcp packet with payload", 200000, _bench_runPacketLifecycle},
+    {"countdownlatch-round-trip", "one worker and the main thread pass both barriers of a round", 20000, _bench_runCountDownLatch},
+    {"logger-throughput", "log records until the helper thread has written them all", 200000, _bench_runLogger},
+};
+
+static gint _bench_compareDouble(gconstpointer a, gconstpointer b) {
+    gdouble x = *((const gdouble*)a);
+    gdouble y = *((const gdouble*)b);
+    return (x > y) ? 1 : (x < y) ? -1 : 0;
+}
+
+static void _bench_run(const Benchmark* benchmark, BenchContext* context, BenchOptions* options,
+        FILE* output, gboolean isFirst) {
+    guint64 nOperations = MAX((guint64)(benchmark->nOperations * options->scale), 1);
+    gdouble* nanosPerOp = g_new0(gdouble, options->repetitions);
+    gint nRepetitions = 0;
+
+    for(gint i = 0; i < options->repetitions; i++) {
+        g_rand_set_seed(context->random, BENCH_SEED);
+        g_timer_reset(context->timer);
+        g_timer_stop(context->timer);
+
+        guint64 nDone = benchmark->run(context, nOperations);
+        if(nDone == 0) {
+            break;
+        }
+        nanosPerOp[nRepetitions++] = (g_timer_elapsed(context->timer, NULL) * SIMTIME_ONE_SECOND) / nDone;
+    }
+
+    fprintf(output, "%s    {\"name\": \"%s\", \"description\": \"%s\"",
+            isFirst ? "" : ",\n", benchmark->name, benchmark->description);
+
+    if(nRepetitions == 0) {
+        fprintf(output, ", \"skipped\": true}");
+        g_printerr("%-28s skipped\n", benchmark->name);
+    } else {
+        gdouble sum = 0;
+        for(gint i = 0; i < nRepetitions; i++) {
+            sum += nanosPerOp[i];
+        }
+        qsort(nanosPerOp, nRepetitions, sizeof(gdouble), _bench_compareDouble);
+        gdouble median = (nRepetitions % 2) ? nanosPerOp[nRepetitions / 2] :
+                (nanosPerOp[nRepetitions / 2 - 1] + nanosPerOp[nRepetitions / 2]) / 2;
+
+        fprintf(output, ", \"operations\": %"G_GUINT64_FORMAT", \"repetitions\": %i, "
+                "\"ns-per-op-min\": %.3f, \"ns-per-op-median\": %.3f, \"ns-per-op-mean\": %.3f, "
+                "\"ns-per-op-max\": %.3f, \"ops-per-second\": %.1f}",
+                nOperations, nRepetitions, nanosPerOp[0], median, sum / nRepetitions,
+                nanosPerOp[nRepetitions - 1], (median > 0) ? SIMTIME_ONE_SECOND / median : 0.0f);
+        g_printerr("%-28s %12.3f ns/op (median of %i)\n", benchmark->name, median, nRepetitions);
+    }
+
+    g_free(nanosPerOp);
+}
+
+gint main(gint argc, gchar* argv[]) {
+    BenchOptions options;
+    memset(&options, 0, sizeof(BenchOptions));
+    options.repetitions = 5;
+    options.scale = 1.0f;
+
+    const GOptionEntry entries[] = {
+      { "filter", 'f', 0, G_OPTION_ARG_STRING, &(options.filter), "Only run benchmarks whose name contains STRING", "STRING" },
+      { "output", 'o', 0, G_OPTION_ARG_FILENAME, &(options.outputPath), "Write the json results to PATH instead of stdout", "PATH" },
+      { "repetitions", 'r', 0, G_OPTION_ARG_INT, &(options.repetitions), "Run each benchmark N times and report the spread [5]", "N" },
+      { "scale", 's', 0, G_OPTION_ARG_DOUBLE, &(options.scale), "Multiply the number of operations of each benchmark by F [1.0]", "F" },
+      { NULL },
+    };
+
+    GOptionContext* optionContext = g_option_context_new("- microbenchmarks for shadow's core data structures");
+    g_option_context_add_main_entries(optionContext, entries, NULL);
+    GError* error = NULL;
+    if(!g_option_context_parse(optionContext, &argc, &argv, &error)) {
+        g_printerr("** %s **\n", error->message);
+        g_error_free(error);
+        g_option_context_free(optionContext);
+        return EXIT_FAILURE;
+    }
+    g_option_context_free(optionContext);
+
+    options.repetitions = MAX(options.repetitions, 1);
+    if(options.scale <= 0) {
+        options.scale = 1.0f;
+    }
+
+    FILE* output = stdout;
+    if(options.outputPath) {
+        output = fopen(options.outputPath, "w");
+        if(!output) {
+            g_printerr("unable to open output file '%s': %s\n", options.outputPath, g_strerror(errno));
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* the core expects a worker for the calling thread */
+    worker_newStandalone(0);
+
+    /* keep the core quiet, only the benchmarks log */
+    Logger* logger = logger_new(LOGLEVEL_WARNING);
+    logger_setDefault(logger);
+    logger_unref(logger);
+
+    BenchContext context;
+    memset(&context, 0, sizeof(BenchContext));
+    context.random = g_rand_new_with_seed(BENCH_SEED);
+    context.timer = g_timer_new();
+
+    for(gint i = 0; i < BENCH_NUM_HOSTS; i++) {
+        gchar* name = g_strdup_printf("benchhost%i", i);
+        HostParameters params;
+        memset(&params, 0, sizeof(HostParameters));
+        params.id = g_quark_from_string(name);
+        params.hostname = name;
+        context.hosts[i] = host_new(&params);
+        g_free(name);
+    }
+    context.topologyPath = _bench_newTopologyFile(&context);
+
+    fprintf(output, "{\n  \"version\": \"%s\",\n  \"repetitions\": %i,\n  \"scale\": %f,\n  \"benchmarks\": [\n",
+            SHADOW_VERSION_STRING, options.repetitions, options.scale);
+
+    gboolean isFirst = TRUE;
+    for(guint i = 0; i < G_N_ELEMENTS(benchmarks); i++) {
+        if(options.filter && !g_strrstr(benchmarks[i].name, options.filter)) {
+            continue;
+        }
+        _bench_run(&benchmarks[i], &context, &options, output, isFirst);
+        isFirst = FALSE;
+    }
+
+    fprintf(output, "\n  ],\n  \"checksum\": %"G_GUINT64_FORMAT"\n}\n", context.checksum);
+
+    if(context.topologyPath) {
+        g_unlink(context.topologyPath);
+        g_free(context.topologyPath);
+    }
+    for(gint i = 0; i < BENCH_NUM_HOSTS; i++) {
+        host_unref(context.hosts[i]);
+    }
+    g_timer_destroy(context.timer);
+    g_rand_free(context.random);
+
+    logger_setDefault(NULL);
+    worker_freeStandalone();
+
+    if(output != stdout) {
+        fclose(output);
+    }
+    g_free(options.filter);
+    g_free(options.outputPath);
+
+    return EXIT_SUCCESS;
+}
@@ -214,6 +214,60 @@ fail:
     return EXIT_FAILURE;
 }
 
+static int _test_ready_twice_then_delete() {
+    int pfds[2];
+    if(pipe(pfds) < 0) {
+        fprintf(stdout, "error: pipe could not be created!\n");
+        return EXIT_FAILURE;
+    }
+
+    struct epoll_event pevent;
+    pevent.events = EPOLLIN;
+    pevent.data.fd = pfds[0];
+
+    int efd = epoll_create(1);
+    if(epoll_ctl(efd, EPOLL_CTL_ADD, pfds[0], &pevent) < 0) {
+        fprintf(stdout, "error: epoll_ctl failed\n");
+        goto fail;
+    }
+
+    /* make the watch ready twice in a row, so it is already on the ready list
+     * the second time its status is updated */
+    if(_test_fd_write(pfds[1]) < 0 || _test_fd_write(pfds[1]) < 0) {
+        fprintf(stdout, "error: could not write to pipe\n");
+        goto fail;
+    }
+
+    int ready = epoll_wait(efd, &pevent, 1, 100);
+    if(ready != 1) {
+        fprintf(stdout, "error: epoll reported %i events instead of 1 for a readable pipe\n", ready);
+        goto fail;
+    }
+
+    /* deleting a watch that is still ready must also take it off the ready list */
+    if(epoll_ctl(efd, EPOLL_CTL_DEL, pfds[0], &pevent) < 0) {
+        fprintf(stdout, "error: epoll_ctl delete failed\n");
+        goto fail;
+    }
+    close(pfds[0]);
+    close(pfds[1]);
+
+    ready = epoll_wait(efd, &pevent, 1, 100);
+    if(ready != 0) {
+        fprintf(stdout, "error: epoll reported %i events after the only watch was deleted\n", ready);
+        close(efd);
+        return EXIT_FAILURE;
+    }
+
+    close(efd);
+    return EXIT_SUCCESS;
+fail:
+    close(efd);
+    close(pfds[0]);
+    close(pfds[1]);
+    return EXIT_FAILURE;
+}
+
 static int _test_creat() {
     int fd = creat("testepoll.txt", 0);
     if(fd < 0) {
@@ -264,6 +318,12 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
 
+    fprintf(stdout, "########## _test_ready_twice_then_delete() started\n");
+    if(_test_ready_twice_then_delete() != EXIT_SUCCESS) {
+        fprintf(stdout, "########## _test_ready_twice_then_delete() failed\n");
+        return EXIT_FAILURE;
+    }
+
     fprintf(stdout, "########## _test_creat() started\n");
     if(_test_creat() != EXIT_SUCCESS) {
         fprintf(stdout, "########## _test_creat() failed\n");
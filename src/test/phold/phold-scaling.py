@@ -0,0 +1,213 @@
+#!/usr/bin/python
+
+import sys, os, argparse, json, time, re, itertools, shutil
+from subprocess import call
+
+DESCRIPTION="""
+A harness to measure how the Shadow scheduler scales, using the phold test plugin.
+
+Every combination of host count, message load, topology latency, worker count,
+and scheduler policy is written as a phold config and simulated with Shadow.
+Each run reports the wall time, the number of events and events per second, and
+when running with worker threads, the number of rounds and the fraction of
+worker time that was spent waiting at round barriers. The results are printed
+as a table and written as json.
+
+The phold plugin must already be built. A sweep over a few host counts and
+worker counts looks like:
+$ python phold-scaling.py --shadow build/src/main/shadow \\
+    --plugin build/src/test/phold/shadow-plugin-test-phold \\
+    --hosts 10,100,1000 --workers 0,2,4,8
+
+Runs with 0 workers use the serial scheduler, so they are run once per
+configuration instead of once per policy.
+"""
+
+POLICIES = ["host", "steal", "thread", "threadXthread", "threadXhost"]
+
+TOPOLOGY = """<graphml xmlns="http://graphml.graphdrawing.org/xmlns">
+  <key attr.name="packetloss" attr.type="double" for="edge" id="d4" />
+  <key attr.name="latency" attr.type="double" for="edge" id="d3" />
+  <key attr.name="bandwidthup" attr.type="int" for="node" id="d2" />
+  <key attr.name="bandwidthdown" attr.type="int" for="node" id="d1" />
+  <graph edgedefault="undirected">
+    <node id="poi-1">
+      <data key="d1">10240</data>
+      <data key="d2">10240</data>
+    </node>
+    <edge source="poi-1" target="poi-1">
+      <data key="d3">{latency}</data>
+      <data key="d4">0.0</data>
+    </edge>
+  </graph>
+</graphml>"""
+
+CONFIG = """<shadow>
+  <topology><![CDATA[{topology}]]></topology>
+  <kill time="{stoptime}"/>
+  <plugin id="testphold" path="{plugin}"/>
+  <node id="peer" quantity="{hosts}">
+    <application plugin="testphold" starttime="1" arguments="loglevel=message basename=peer quantity={hosts} load={load} weightsfilepath={weights}"/>
+  </node>
+</shadow>
+"""
+
+# logged by shadow when the simulation ends, counts every event that was created
+EVENTS_RE = re.compile(r"event_new=(\d+)")
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=DESCRIPTION,
+        formatter_class=argparse.RawTextHelpFormatter)
+
+    parser.add_argument('--shadow', help="PATH to the shadow binary",
+        metavar="PATH", action="store", dest="shadow", default="shadow")
+    parser.add_argument('--plugin', help="PATH to the shadow-plugin-test-phold plugin",
+        metavar="PATH", action="store", dest="plugin", default="shadow-plugin-test-phold")
+    parser.add_argument('--hosts', help="comma separated LIST of the number of phold hosts",
+        metavar="LIST", action="store", dest="hosts", type=int_list, default=[10, 100])
+    parser.add_argument('--loads', help="comma separated LIST of the number of messages each host starts with",
+        metavar="LIST", action="store", dest="loads", type=int_list, default=[1, 10])
+    parser.add_argument('--latencies', help="comma separated LIST of topology latencies, in milliseconds",
+        metavar="LIST", action="store", dest="latencies", type=float_list, default=[10.0, 100.0])
+    parser.add_argument('--workers', help="comma separated LIST of the number of worker threads",
+        metavar="LIST", action="store", dest="workers", type=int_list, default=[0, 1, 2, 4])
+    parser.add_argument('--policies', help="comma separated LIST of scheduler policies for runs with workers",
+        metavar="LIST", action="store", dest="policies", type=str_list, default=POLICIES)
+    parser.add_argument('--stoptime', help="simulated SECONDS after which each run is killed",
+        metavar="SECONDS", action="store", dest="stoptime", type=int, default=10)
+    parser.add_argument('--directory', help="PATH where the configs and data of every run are stored",
+        metavar="PATH", action="store", dest="directory", default="phold-scaling.data")
+    parser.add_argument('--output', help="PATH of the json results",
+        metavar="PATH", action="store", dest="output", default="phold-scaling.json")
+
+    args = parser.parse_args()
+
+    for policy in args.policies:
+        if policy not in POLICIES:
+            parser.error("unknown scheduler policy '{0}', choose from {1}".format(policy, ",".join(POLICIES)))
+
+    plugin = os.path.abspath(os.path.expanduser(args.plugin))
+    directory = os.path.abspath(os.path.expanduser(args.directory))
+    if os.path.exists(directory):
+        shutil.rmtree(directory)
+    os.makedirs(directory)
+
+    results = []
+    failed = 0
+    print_header()
+
+    for hosts, load, latency, workers in itertools.product(args.hosts, args.loads, args.latencies, args.workers):
+        policies = args.policies if workers > 0 else ["serial"]
+        for policy in policies:
+            result = run(args.shadow, plugin, directory, hosts, load, latency, workers, policy, args.stoptime)
+            if not result["success"]:
+                failed += 1
+            results.append(result)
+            print_result(result)
+
+    with open(args.output, 'w') as outf:
+        json.dump({"stoptime": args.stoptime, "runs": results}, outf, sort_keys=True, indent=2)
+    print("wrote results of {0} runs to '{1}'".format(len(results), args.output))
+
+    return 1 if failed > 0 else 0
+
+def run(shadow, plugin, directory, hosts, load, latency, workers, policy, stoptime):
+    name = "hosts{0}-load{1}-latency{2:g}-workers{3}-{4}".format(hosts, load, latency, workers, policy)
+    rundir = os.path.join(directory, name)
+    os.makedirs(rundir)
+
+    # phold picks the destination of each message using one weight per host
+    weights = os.path.join(rundir, "weights.txt")
+    with open(weights, 'w') as outf:
+        outf.write("1.0\n" * hosts)
+
+    config = os.path.join(rundir, "phold.shadow.config.xml")
+    with open(config, 'w') as outf:
+        outf.write(CONFIG.format(topology=TOPOLOGY.format(latency=latency), stoptime=stoptime,
+            plugin=plugin, hosts=hosts, load=load, weights=weights))
+
+    datadir = os.path.join(rundir, "shadow.data")
+    command = [shadow, "-d", datadir, "-w", str(workers), "--scheduler-trace"]
+    if workers > 0:
+        command += ["-t", policy]
+    command.append(config)
+
+    logpath = os.path.join(rundir, "shadow.log")
+    with open(logpath, 'w') as logf:
+        start = time.time()
+        retcode = call(command, stdout=logf, stderr=logf, cwd=rundir)
+        walltime = time.time() - start
+
+    result = {"name": name, "hosts": hosts, "load": load, "latency-ms": latency,
+        "workers": workers, "policy": policy, "success": retcode == 0,
+        "wall-seconds": walltime, "events": None, "events-per-second": None,
+        "rounds": None, "barrier-idle-fraction": None}
+
+    events = parse_events(logpath)
+    if events is not None:
+        result["events"] = events
+        result["events-per-second"] = events / walltime if walltime > 0 else None
+
+    # the round trace is only written when there are worker threads
+    rounds, idle = parse_trace(os.path.join(datadir, "scheduler-trace.json"))
+    result["rounds"] = rounds
+    result["barrier-idle-fraction"] = idle
+
+    return result
+
+def parse_events(logpath):
+    events = None
+    with open(logpath, 'r') as inf:
+        for line in inf:
+            match = EVENTS_RE.search(line)
+            if match is not None:
+                events = int(match.group(1))
+    return events
+
+def parse_trace(tracepath):
+    if not os.path.exists(tracepath):
+        return None, None
+    try:
+        with open(tracepath, 'r') as inf:
+            trace = json.load(inf)
+    except ValueError:
+        return None, None
+
+    rounds = set()
+    runtime, idletime = 0, 0
+    for item in trace:
+        if item["name"] == "run":
+            rounds.add(item["args"]["round"])
+            runtime += item["dur"]
+        elif item["name"] == "barrier":
+            idletime += item["dur"]
+
+    total = runtime + idletime
+    return len(rounds), (float(idletime) / total if total > 0 else None)
+
+TABLE_FORMAT = "{0:>6} {1:>5} {2:>8} {3:>7} {4:<13} {5:>10} {6:>12} {7:>14} {8:>8} {9:>6}"
+
+def print_header():
+    print(TABLE_FORMAT.format("hosts", "load", "latency", "workers", "policy",
+        "wall(s)", "events", "events/s", "rounds", "idle"))
+
+def print_result(r):
+    def fmt(value, spec):
+        return "-" if value is None else spec.format(value)
+    print(TABLE_FORMAT.format(r["hosts"], r["load"], "{0:g}ms".format(r["latency-ms"]), r["workers"], r["policy"],
+        "{0:.3f}".format(r["wall-seconds"]) if r["success"] else "failed",
+        fmt(r["events"], "{0}"), fmt(r["events-per-second"], "{0:.1f}"),
+        fmt(r["rounds"], "{0}"), fmt(r["barrier-idle-fraction"], "{0:.3f}")))
+    sys.stdout.flush()
+
+def int_list(s):
+    return [int(v) for v in s.split(',') if v != ""]
+
+def float_list(s):
+    return [float(v) for v in s.split(',') if v != ""]
+
+def str_list(s):
+    return [v for v in s.split(',') if v != ""]
+
+if __name__ == '__main__': sys.exit(main())